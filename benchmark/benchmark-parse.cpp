@@ -1,8 +1,14 @@
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <ios>
 #include <iostream>
 #include <fstream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include "zusi_parser/zusi_types.hpp"
@@ -10,19 +16,71 @@
 #include "zusi_parser/utils.hpp"
 
 #ifdef __linux__
+#include <fcntl.h>
 #include <sys/resource.h>
+#include <unistd.h>
 #endif
 
-int main(int argc, char** argv) {
-#ifdef NDEBUG
-  (void)argc;
+#if defined(ZUSIXML_REUSE)
+#include <cstdlib>
+#include <new>
+
+// Counts the allocations for comparing parse_root with parse_root_into.
+static size_t anzahl_allokationen = 0;
+
+void* operator new(size_t size) {
+  anzahl_allokationen++;
+  if (void* result = std::malloc(size == 0 ? 1 : size)) {
+    return result;
+  }
+  throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
 #endif
-  assert(argc == 2);
-  auto start = std::chrono::high_resolution_clock::now();
 
-  // argv[1]: Liste von Dateinamen
+int main(int argc, char** argv) {
+  assert(argc == 2 || argc == 3);
+
+  // argv[2] (optional): durch Kommas getrennte Hinweise fuer das Laden (zusixml::FileLoadPolicy):
+  // read, sequential, willneed, populate=<max. Dateigroesse>, hugepages; dazu
+  // dontneed (Seiten jeder Datei nach dem Parsen freigeben) und cold (Dateien vorher aus dem Seitencache werfen).
+  zusixml::FileLoadPolicy policy;
+  bool dontneed = false;
+  bool cold = false;
+  if (argc == 3) {
+    std::istringstream hinweise(argv[2]);
+    std::string hinweis;
+    while (std::getline(hinweise, hinweis, ',')) {
+      if (hinweis == "read") {
+        policy.read = true;
+      } else if (hinweis == "sequential") {
+        policy.sequential = true;
+      } else if (hinweis == "willneed") {
+        policy.willNeed = true;
+      } else if (hinweis.rfind("populate=", 0) == 0) {
+        policy.populateMaxSize = std::stoull(hinweis.substr(9));
+      } else if (hinweis == "hugepages") {
+        policy.hugePages = true;
+      } else if (hinweis == "dontneed") {
+        dontneed = true;
+      } else if (hinweis == "cold") {
+        cold = true;
+      } else {
+        std::cerr << "Unknown load policy: " << hinweis << "\n";
+        return 1;
+      }
+    }
+  }
+
+  // argv[1]: Liste von Dateinamen oder Paketdatei (*.zusipack, erstellt mit zusipack)
+  const std::string_view eingabe(argv[1]);
+  const std::string_view paketendung(".zusipack");
+  const bool ist_paket = eingabe.size() >= paketendung.size() && eingabe.substr(eingabe.size() - paketendung.size()) == paketendung;
   std::vector<std::string> dateinamen;
   std::vector<zusixml::FileReader> dateien;
+  std::unique_ptr<zusixml::PackReader> paket;
+  std::vector<std::string_view> inhalte;  // der Dateien bzw. der Dateien im Paket
   size_t total_size = 0;
 
 #ifdef __linux__
@@ -42,7 +100,9 @@ int main(int argc, char** argv) {
   }
 #endif
 
-  {
+  if (ist_paket) {
+    dateinamen.push_back(argv[1]);
+  } else {
     char buf[256];
     std::ifstream i(argv[1]);
     while (i.getline(buf, sizeof(buf))) {
@@ -51,7 +111,24 @@ int main(int argc, char** argv) {
   }
 
 #ifdef __linux__
-  {
+  if (cold) {
+    // Fuer unveraenderte Dateien auch ohne Root-Rechte moeglich (im Gegensatz zu /proc/sys/vm/drop_caches).
+    for (const auto& dateiname : dateinamen) {
+      const int fd = open(dateiname.c_str(), O_RDONLY);
+      if (fd != -1) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+      }
+    }
+  }
+#else
+  (void)cold;
+#endif
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+#ifdef __linux__
+  if (!ist_paket) {
     char buf[256];
     std::ifstream i("/proc/sys/vm/max_map_count");
     i.getline(buf, sizeof(buf));
@@ -61,19 +138,49 @@ int main(int argc, char** argv) {
   }
 #endif
 
-  for (const auto& dateiname : dateinamen) {
-    const auto& fileReader = dateien.emplace_back(std::string_view(dateiname));
-    total_size += fileReader.size();
+#ifndef LOAD_THREADS
+#define LOAD_THREADS 0
+#endif
+  if (ist_paket) {
+    // Ein Oeffnen und eine Einblendung fuer alle Dateien.
+    paket = std::make_unique<zusixml::PackReader>(argv[1], policy);
+    dateinamen.clear();
+    for (size_t i = 0; i < paket->size(); i++) {
+      const auto datei = (*paket)[i];
+      dateinamen.emplace_back(datei.path());
+      inhalte.emplace_back(datei.data(), datei.size());
+    }
+  } else {
+    // Die Dateien kommen in der Reihenfolge an, in der sie fertig geladen sind.
+    zusixml::FileBatchLoader loader(std::move(dateinamen), LOAD_THREADS, policy);
+    dateinamen.clear();
+    loader.forEach([&](size_t index, zusixml::FileReader& fileReader) {
+      dateinamen.push_back(loader.dateinamen()[index]);
+      dateien.push_back(std::move(fileReader));
+    });
+    for (auto& datei : dateien) {
+      inhalte.emplace_back(datei.data(), datei.size());
+    }
+  }
+  for (const auto& inhalt : inhalte) {
+    total_size += inhalt.size();
   }
 
   auto ende_laden = std::chrono::high_resolution_clock::now();
 
-  std::vector<std::unique_ptr<Zusi>> results;
-  for (size_t i = 0; i < dateien.size(); i++) {
+#if defined(ZUSIXML_INTERN) && defined(INTERN_SHARED)
+  zusixml::intern_table::scope intern_scope(zusixml::intern_table::shared());
+#endif
+
+  std::vector<zusixml::root_ptr<Zusi>> results;
+  for (size_t i = 0; i < inhalte.size(); i++) {
     try {
-      results.push_back(zusixml::parse_root<Zusi>(dateien[i].data()));
+      results.push_back(zusixml::parse_root<Zusi>(inhalte[i].data(), inhalte[i].data() + inhalte[i].size()));
+      if (dontneed && i < dateien.size()) {
+        dateien[i].dontNeed();
+      }
     } catch (zusixml::parse_error& e) {
-      std::cerr << dateinamen[i] << ": " << e.what() << " @ char " << (e.where() - dateien[i].data()) << std::endl;
+      std::cerr << dateinamen[i] << ": " << e.what() << " @ char " << (e.where() - inhalte[i].data()) << std::endl;
     }
   }
   auto ende_parsen = std::chrono::high_resolution_clock::now();
@@ -81,6 +188,127 @@ int main(int argc, char** argv) {
 
   std::cout << " - load: " << std::chrono::duration_cast<std::chrono::milliseconds>(ende_laden - start).count() << " ms " << std::endl;
   std::cout << " - parse: " << std::chrono::duration_cast<std::chrono::milliseconds>(ende_parsen - ende_laden).count() << " ms " << std::endl;
+  std::cout << " - throughput: " << (total_size / std::chrono::duration<double>(ende_parsen - ende_laden).count() / (1024 * 1024)) << " MB/s (kernel: " << zusixml::simd_kernel() << ")" << std::endl;
+  std::cout << " - float values on slow path: " << zusixml::float_slow_path_count << std::endl;
+#ifdef __linux__
+  {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::cout << " - max. RSS: " << usage.ru_maxrss / 1024 << " MiB, major page faults: " << usage.ru_majflt << std::endl;
+  }
+#endif
+
+#if defined(ZUSIXML_INTERN)
+  {
+    // Tables shared between documents are counted only once.
+    std::vector<const zusixml::intern_table*> tabellen;
+    for (const auto& result : results) {
+      if (result.strings() && std::find(tabellen.begin(), tabellen.end(), result.strings()) == tabellen.end()) {
+        tabellen.push_back(result.strings());
+      }
+    }
+    zusixml::intern_table::statistics summe;
+    for (const auto* tabelle : tabellen) {
+      const auto statistik = tabelle->stats();
+      summe.lookups += statistik.lookups;
+      summe.lookup_bytes += statistik.lookup_bytes;
+      summe.unique += statistik.unique;
+      summe.unique_bytes += statistik.unique_bytes;
+    }
+    // Without interning, every value needs its own string object plus the characters outside of it (if not SSO).
+    const size_t ohne = summe.lookups * sizeof(std::string) + summe.lookup_bytes;
+    const size_t mit = summe.lookups * sizeof(zusixml::interned_string) + summe.unique * (sizeof(size_t) + 1) + summe.unique_bytes;
+    std::cout << " - interned strings: " << summe.lookups << " values (" << summe.lookup_bytes << " bytes), "
+      << summe.unique << " unique (" << summe.unique_bytes << " bytes) in " << tabellen.size() << " tables" << std::endl;
+    std::cout << " - interning saved approx. " << (ohne > mit ? (ohne - mit) / 1024 : 0) << " KiB (" << ohne / 1024 << " KiB -> " << mit / 1024 << " KiB)" << std::endl;
+  }
+#endif
+
+  auto start_freigeben = std::chrono::high_resolution_clock::now();
+  results.clear();
+  auto ende_freigeben = std::chrono::high_resolution_clock::now();
+  std::cout << " - destroy: " << std::chrono::duration_cast<std::chrono::milliseconds>(ende_freigeben - start_freigeben).count() << " ms " << std::endl;
+
+#if defined(ZUSIXML_REUSE)
+  {
+    // Batch processing, where each result is only needed until the next file is parsed:
+    // a new result per file (parse_root) versus one result that is parsed into again and again (parse_root_into).
+    const auto stapel = [&](const char* name, const auto& parse) {
+      const size_t allokationen_vorher = anzahl_allokationen;
+      const auto start_stapel = std::chrono::high_resolution_clock::now();
+      for (const auto& inhalt : inhalte) {
+        try {
+          parse(inhalt.data(), inhalt.data() + inhalt.size());
+        } catch (zusixml::parse_error&) {
+          // already reported above
+        }
+      }
+      const auto ende_stapel = std::chrono::high_resolution_clock::now();
+      std::cout << " - batch, " << name << ": " << std::chrono::duration_cast<std::chrono::milliseconds>(ende_stapel - start_stapel).count() << " ms, "
+        << (anzahl_allokationen - allokationen_vorher) << " allocations" << std::endl;
+    };
+    stapel("parse_root per file", [](const char* begin, const char* end) {
+      zusixml::parse_root<Zusi>(begin, end);
+    });
+    Zusi ergebnis;
+    const auto parse_into = [&ergebnis](const char* begin, const char* end) {
+      zusixml::parse_root_into(ergebnis, begin, end);
+    };
+    stapel("parse_root_into, first pass", parse_into);
+    stapel("parse_root_into, second pass", parse_into);
+  }
+#endif
+
+#if defined(ZUSIXML_CACHE)
+  if (!ist_paket) {
+    // Parsing the XML files compared with loading them from a ParseCache, each from disk and from the page cache.
+    const fs::path verzeichnis = fs::temp_directory_path() / "zusi_parser_benchmark_cache";
+    fs::remove_all(verzeichnis);
+    zusixml::ParseCache cache(verzeichnis.string(), std::numeric_limits<uint64_t>::max());
+    // Each file once, so that filling the cache does not already hit it.
+    std::vector<std::string> eindeutig = dateinamen;
+    std::sort(eindeutig.begin(), eindeutig.end());
+    eindeutig.erase(std::unique(eindeutig.begin(), eindeutig.end()), eindeutig.end());
+    const auto aus_seitencache_werfen = [&]() {
+#ifdef __linux__
+      std::vector<std::string> dateien = eindeutig;
+      for (const auto& eintrag : fs::directory_iterator(verzeichnis)) {
+        dateien.push_back(eintrag.path().string());
+      }
+      for (const auto& dateiname : dateien) {
+        const int fd = open(dateiname.c_str(), O_RDONLY);
+        if (fd != -1) {
+          posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+          close(fd);
+        }
+      }
+#endif
+    };
+    const auto durchlauf = [&](const char* name, bool kalt, const auto& parse) {
+      if (kalt) {
+        aus_seitencache_werfen();
+      }
+      const auto start_durchlauf = std::chrono::high_resolution_clock::now();
+      size_t anzahl = 0;
+      for (const auto& dateiname : eindeutig) {
+        anzahl += static_cast<bool>(parse(dateiname));
+      }
+      const auto ende_durchlauf = std::chrono::high_resolution_clock::now();
+      std::cout << " - " << name << ": " << std::chrono::duration_cast<std::chrono::milliseconds>(ende_durchlauf - start_durchlauf).count() << " ms, "
+        << anzahl << " files" << std::endl;
+    };
+    const auto xml = [](const std::string& dateiname) { return zusixml::parseFile(dateiname); };
+    const auto aus_cache = [&cache](const std::string& dateiname) { return cache.parseFile(dateiname); };
+    durchlauf("XML, cold", true, xml);
+    durchlauf("XML, warm", false, xml);
+    durchlauf("cache, filling", false, aus_cache);
+    durchlauf("cache, cold", true, aus_cache);
+    durchlauf("cache, warm", false, aus_cache);
+    const auto stats = cache.stats();
+    std::cout << " - cache: " << stats.treffer << " hits, " << stats.verfehlt << " misses, " << cache.size() / 1024 << " KiB in " << verzeichnis << std::endl;
+    cache.clear();
+  }
+#endif
 
-  _exit(0);  // do not call destructors -- their time must not be taken into account when benchmarking
+  _exit(0);  // do not unmap the input files -- their time must not be taken into account when benchmarking
 }
@@ -0,0 +1,302 @@
+#ifndef ZUSI_PARSER_ARENA_HPP_
+#define ZUSI_PARSER_ARENA_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <sys/mman.h>
+#endif
+
+namespace zusixml {
+
+/// Monotoner Speicherbereich (Arena) fuer die Datenstrukturen eines Dokuments.
+/// Speicher wird fortlaufend aus grossen Bloecken vergeben und nie einzeln freigegeben;
+/// beim Zerstoeren der Arena werden alle Bloecke auf einmal zurueckgegeben.
+/// Eine Arena ist nicht threadsicher. Zum parallelen Parsen erhaelt jeder Thread
+/// (bzw. jedes Dokument) seine eigene Arena, siehe arena::scope.
+class arena {
+ public:
+  struct options {
+    /// Groesse des ersten Blocks. Jeder weitere Block ist doppelt so gross wie
+    /// der vorherige, bis max_block_size erreicht ist.
+    size_t block_size { 64 * 1024 };
+    size_t max_block_size { 32 * 1024 * 1024 };
+    /// Bloecke mit Huge Pages hinterlegen (Linux: MAP_HUGETLB, sonst madvise(MADV_HUGEPAGE)).
+    /// Lohnt sich fuer grosse Dokumente, weil weniger TLB-Eintraege benoetigt werden.
+    bool huge_pages { false };
+  };
+
+  /// Voreinstellungen fuer Arenen, die parse_root anlegt.
+  static options& default_options() {
+    static options result;
+    return result;
+  }
+
+  explicit arena(const options& opts = default_options()) : m_options(opts) {}
+  arena(const arena&) = delete;
+  arena& operator=(const arena&) = delete;
+
+  ~arena() {
+    block_header* block = m_blocks;
+    while (block) {
+      block_header* next = block->next;
+      free_block(block);
+      block = next;
+    }
+  }
+
+  /// Vergibt @p size Bytes mit der Ausrichtung @p alignment.
+  void* allocate(size_t size, size_t alignment) {
+    uintptr_t result = (m_position + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    if (result + size > m_end) {
+      new_block(size + alignment);
+      result = (m_position + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    }
+    m_position = result + size;
+    return reinterpret_cast<void*>(result);
+  }
+
+  /// Anzahl der von der Arena reservierten Bytes (Summe der Blockgroessen).
+  size_t capacity() const { return m_capacity; }
+
+  /// Die Arena, aus der zusixml::arena_allocator im aktuellen Thread Speicher vergibt.
+  /// Darf nur innerhalb einer arena::scope aufgerufen werden.
+  static arena& current() {
+    arena* result = current_pointer();
+    assert(result);
+    return *result;
+  }
+
+  /// Die aktuelle Arena oder nullptr, wenn im aktuellen Thread keine arena::scope besteht.
+  static arena* active() { return current_pointer(); }
+
+  /// Macht eine Arena fuer die Lebensdauer des Objekts im aktuellen Thread zur aktuellen Arena.
+  class scope {
+   public:
+    explicit scope(arena& a) : m_previous(current_pointer()) { current_pointer() = &a; }
+    scope(const scope&) = delete;
+    scope& operator=(const scope&) = delete;
+    ~scope() { current_pointer() = m_previous; }
+
+   private:
+    arena* m_previous;
+  };
+
+ private:
+  struct block_header {
+    block_header* next;
+    size_t size;
+    bool mapped;
+  };
+
+  static arena*& current_pointer() {
+    static thread_local arena* result = nullptr;
+    return result;
+  }
+
+  void new_block(size_t min_size) {
+    size_t size = std::max(m_next_block_size, min_size + sizeof(block_header));
+    m_next_block_size = std::min(m_next_block_size * 2, std::max(m_options.max_block_size, m_options.block_size));
+
+    block_header* block = allocate_block(size);
+    block->next = m_blocks;
+    m_blocks = block;
+    m_capacity += block->size;
+    m_position = reinterpret_cast<uintptr_t>(block + 1);
+    m_end = reinterpret_cast<uintptr_t>(block) + block->size;
+  }
+
+  block_header* allocate_block(size_t size) {
+    void* memory = nullptr;
+    bool mapped = false;
+    if (m_options.huge_pages) {
+      constexpr size_t huge_page_size = 2 * 1024 * 1024;
+      size = (size + huge_page_size - 1) & ~(huge_page_size - 1);
+#if defined(_WIN32)
+      memory = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+#  if defined(MAP_HUGETLB)
+      memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (memory == MAP_FAILED) {
+        memory = nullptr;
+      }
+#  endif
+      if (!memory) {
+        // Keine reservierten Huge Pages verfuegbar: Transparent Huge Pages anfordern.
+        memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+          memory = nullptr;
+        }
+#  if defined(MADV_HUGEPAGE)
+        else {
+          madvise(memory, size, MADV_HUGEPAGE);
+        }
+#  endif
+      }
+#endif
+      mapped = (memory != nullptr);
+    }
+    if (!memory) {
+      memory = std::malloc(size);
+      if (!memory) {
+        throw std::bad_alloc();
+      }
+    }
+    block_header* block = static_cast<block_header*>(memory);
+    block->size = size;
+    block->mapped = mapped;
+    return block;
+  }
+
+  static void free_block(block_header* block) {
+    if (block->mapped) {
+#if defined(_WIN32)
+      VirtualFree(block, 0, MEM_RELEASE);
+#else
+      munmap(block, block->size);
+#endif
+    } else {
+      std::free(block);
+    }
+  }
+
+  options m_options;
+  block_header* m_blocks { nullptr };
+  uintptr_t m_position { 0 };
+  uintptr_t m_end { 0 };
+  size_t m_next_block_size { m_options.block_size };
+  size_t m_capacity { 0 };
+};
+
+namespace detail {
+
+/// Speicher, den arena_allocator und arena_new ausserhalb einer arena::scope vergeben, etwa wenn ein
+/// Dokument nach dem Parsen veraendert wird. Er kommt von operator new und wird bei der Freigabe
+/// zurueckgegeben. Damit Freigaben von Arena-Speicher (die ignoriert werden) davon zu unterscheiden sind,
+/// werden die Bloecke vermerkt; solange es keine gibt, kostet eine Freigabe nur das Lesen eines Zaehlers.
+class heap_fallback {
+ public:
+  static void* allocate(size_t size, size_t alignment) {
+    void* result = alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__ ? ::operator new(size, std::align_val_t(alignment))
+                                                                : ::operator new(size);
+    heap_fallback& self = instance();
+    try {
+      std::lock_guard<std::mutex> lock(self.m_mutex);
+      self.m_blocks.emplace(result, alignment);
+      self.m_count.store(self.m_blocks.size(), std::memory_order_release);
+    } catch (...) {
+      release(result, alignment);
+      throw;
+    }
+    return result;
+  }
+
+  /// Gibt @p p frei, falls der Speicher von allocate() stammt; Arena-Speicher bleibt unberuehrt.
+  static void deallocate(void* p) noexcept {
+    heap_fallback& self = instance();
+    if (self.m_count.load(std::memory_order_acquire) == 0) {
+      return;
+    }
+    size_t alignment = 0;
+    {
+      std::lock_guard<std::mutex> lock(self.m_mutex);
+      const auto it = self.m_blocks.find(p);
+      if (it == self.m_blocks.end()) {
+        return;
+      }
+      alignment = it->second;
+      self.m_blocks.erase(it);
+      self.m_count.store(self.m_blocks.size(), std::memory_order_release);
+    }
+    release(p, alignment);
+  }
+
+ private:
+  static heap_fallback& instance() {
+    // Nie zerstoert, damit auch Freigaben waehrend des Programmendes noch gelingen.
+    static heap_fallback* result = new heap_fallback();
+    return *result;
+  }
+
+  static void release(void* p, size_t alignment) noexcept {
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      ::operator delete(p, std::align_val_t(alignment));
+    } else {
+      ::operator delete(p);
+    }
+  }
+
+  std::mutex m_mutex;
+  std::unordered_map<const void*, size_t> m_blocks;  // Adresse -> Ausrichtung
+  std::atomic<size_t> m_count { 0 };
+};
+
+}  // namespace detail
+
+/// Allokator, der aus der aktuellen Arena (arena::current()) vergibt; Freigaben werden dann ignoriert.
+/// Ausserhalb einer arena::scope wird Speicher mit operator new vergeben und wieder freigegeben.
+template <typename T>
+struct arena_allocator {
+  using value_type = T;
+
+  arena_allocator() noexcept = default;
+  template <typename U>
+  arena_allocator(const arena_allocator<U>&) noexcept {}
+
+  T* allocate(size_t n) {
+    if (arena* current = arena::active()) {
+      return static_cast<T*>(current->allocate(n * sizeof(T), alignof(T)));
+    }
+    return static_cast<T*>(detail::heap_fallback::allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T* p, size_t) noexcept { detail::heap_fallback::deallocate(p); }
+
+  template <typename U>
+  bool operator==(const arena_allocator<U>&) const noexcept { return true; }
+  template <typename U>
+  bool operator!=(const arena_allocator<U>&) const noexcept { return false; }
+};
+
+/// Deleter fuer Objekte von arena_new: ruft den Destruktor auf und gibt nur Speicher frei,
+/// der nicht in einer Arena liegt.
+template <typename T>
+struct arena_deleter {
+  arena_deleter() noexcept = default;
+  template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+  arena_deleter(const arena_deleter<U>&) noexcept {}
+
+  void operator()(T* p) const {
+    p->~T();
+    detail::heap_fallback::deallocate(const_cast<std::remove_cv_t<T>*>(p));
+  }
+};
+
+/// Legt ein Objekt vom Typ T in der aktuellen Arena an, ausserhalb einer arena::scope mit operator new.
+template <typename T>
+T* arena_new() {
+  if (arena* current = arena::active()) {
+    return new (current->allocate(sizeof(T), alignof(T))) T();
+  }
+  void* memory = detail::heap_fallback::allocate(sizeof(T), alignof(T));
+  try {
+    return new (memory) T();
+  } catch (...) {
+    detail::heap_fallback::deallocate(memory);
+    throw;
+  }
+}
+
+}  // namespace zusixml
+
+#endif  // ZUSI_PARSER_ARENA_HPP_
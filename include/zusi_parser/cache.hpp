@@ -0,0 +1,202 @@
+#ifndef ZUSI_PARSER_CACHE_HPP_
+#define ZUSI_PARSER_CACHE_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace zusixml {
+
+/// Schnappschuss eines geparsten Dokuments fuer den Parse-Cache (ParseCache in utils.hpp). Die von parsergen mit
+/// --cache erzeugten Funktionen write_element_T und read_element_T schreiben bzw. lesen den Baum mit writer und reader
+/// in Vorordnung: je Element die Attribute, dann die Kinder (Anzahl bzw. Vorhandensein, dann die Kinder selbst).
+/// Aufbau einer Schnappschussdatei, alle Zahlen in der Byte-Reihenfolge des Rechners:
+///  - Kopf (cache::header)
+///  - der Pfad der Quelldatei (header::path_size Bytes)
+///  - die Nutzdaten (header::payload_size Bytes)
+namespace cache {
+
+constexpr char magic[8] = { 'Z', 'U', 'S', 'I', 'C', 'A', 'C', 'H' };
+constexpr uint32_t version = 1;
+
+struct header {
+  char magic[8];
+  uint32_t version;
+  uint32_t path_size;
+  uint64_t schema;  // zusixml::cache_schema des erzeugenden Parsers
+  uint64_t source_size;
+  int64_t source_mtime;  // Aenderungszeit der Quelldatei in Nanosekunden seit 1970
+  uint64_t source_hash;  // content_hash der Quelldatei
+  uint64_t payload_size;
+  uint64_t payload_hash;  // content_hash der Nutzdaten, gegen beschaedigte Schnappschuesse
+};
+static_assert(sizeof(header) == 64);
+
+/// Schneller 64-Bit-Hash ueber den Inhalt einer Datei (XXH64 mit Startwert 0).
+inline uint64_t content_hash(const char* data, size_t size) {
+  constexpr uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+  constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+  constexpr uint64_t prime3 = 0x165667B19E3779F9ULL;
+  constexpr uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+  constexpr uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+  const auto rotl = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+  const auto read64 = [](const char* p) { uint64_t result; std::memcpy(&result, p, 8); return result; };
+  const auto round = [&](uint64_t acc, uint64_t input) { return rotl(acc + input * prime2, 31) * prime1; };
+
+  const char* p = data;
+  const char* const end = data + size;
+  uint64_t h;
+  if (size >= 32) {
+    uint64_t v1 = prime1 + prime2, v2 = prime2, v3 = 0, v4 = 0 - prime1;
+    for (; end - p >= 32; p += 32) {
+      v1 = round(v1, read64(p));
+      v2 = round(v2, read64(p + 8));
+      v3 = round(v3, read64(p + 16));
+      v4 = round(v4, read64(p + 24));
+    }
+    h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+    for (uint64_t v : { v1, v2, v3, v4 }) {
+      h = (h ^ round(0, v)) * prime1 + prime4;
+    }
+  } else {
+    h = prime5;
+  }
+  h += size;
+  for (; end - p >= 8; p += 8) {
+    h = rotl(h ^ round(0, read64(p)), 27) * prime1 + prime4;
+  }
+  if (end - p >= 4) {
+    uint32_t k;
+    std::memcpy(&k, p, 4);
+    h = rotl(h ^ (k * prime1), 23) * prime2 + prime3;
+    p += 4;
+  }
+  for (; p < end; p++) {
+    h = rotl(h ^ (static_cast<unsigned char>(*p) * prime5), 11) * prime1;
+  }
+  h ^= h >> 33;
+  h *= prime2;
+  h ^= h >> 29;
+  h *= prime3;
+  h ^= h >> 32;
+  return h;
+}
+
+/// Haengt Werte an einen wachsenden Puffer an.
+class writer {
+ public:
+  /// Werte ohne Zeiger (Zahlen, ArgbColor, Vektoren, ...), byteweise.
+  template<typename T>
+  void put(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T> && !std::is_pointer_v<T>);
+    m_data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template<typename Traits, typename Allocator>
+  void put(const std::basic_string<char, Traits, Allocator>& value) {
+    put_size(value.size());
+    m_data.append(value.data(), value.size());
+  }
+
+  /// Ohne tm_gmtoff und tm_zone, die der Parser nicht setzt.
+  void put(const struct tm& value) {
+    for (int field : { value.tm_sec, value.tm_min, value.tm_hour, value.tm_mday, value.tm_mon, value.tm_year,
+                       value.tm_wday, value.tm_yday, value.tm_isdst }) {
+      put(static_cast<int32_t>(field));
+    }
+  }
+
+  /// Anzahl oder Laenge, mit 7 Bit pro Byte.
+  void put_size(size_t value) {
+    while (value >= 0x80) {
+      m_data.push_back(static_cast<char>(value | 0x80));
+      value >>= 7;
+    }
+    m_data.push_back(static_cast<char>(value));
+  }
+
+  const std::string& data() const { return m_data; }
+
+ private:
+  std::string m_data;
+};
+
+/// Liest die Werte eines writer in derselben Reihenfolge. Wirft std::runtime_error, wenn die Daten vorzeitig enden.
+class reader {
+ public:
+  reader(const char* begin, const char* end) : m_pos(begin), m_end(end) {}
+
+  template<typename T>
+  void get(T& value) {
+    static_assert(std::is_trivially_copyable_v<T> && !std::is_pointer_v<T>);
+    need(sizeof(T));
+    std::memcpy(&value, m_pos, sizeof(T));
+    m_pos += sizeof(T);
+  }
+
+  template<typename T>
+  T get() {
+    T result;
+    get(result);
+    return result;
+  }
+
+  void get(bool& value) {
+    uint8_t byte;
+    get(byte);
+    value = byte != 0;
+  }
+
+  template<typename Traits, typename Allocator>
+  void get(std::basic_string<char, Traits, Allocator>& value) {
+    const size_t size = get_size();
+    need(size);
+    value.assign(m_pos, size);
+    m_pos += size;
+  }
+
+  void get(struct tm& value) {
+    for (int* field : { &value.tm_sec, &value.tm_min, &value.tm_hour, &value.tm_mday, &value.tm_mon, &value.tm_year,
+                        &value.tm_wday, &value.tm_yday, &value.tm_isdst }) {
+      int32_t v;
+      get(v);
+      *field = v;
+    }
+  }
+
+  size_t get_size() {
+    size_t result = 0;
+    for (unsigned shift = 0; ; shift += 7) {
+      need(1);
+      const unsigned char byte = static_cast<unsigned char>(*m_pos++);
+      if (shift >= 64) {
+        throw std::runtime_error("cache: invalid size");
+      }
+      result |= static_cast<size_t>(byte & 0x7F) << shift;
+      if (!(byte & 0x80)) {
+        return result;
+      }
+    }
+  }
+
+  bool at_end() const { return m_pos == m_end; }
+
+ private:
+  void need(size_t size) const {
+    if (size > static_cast<size_t>(m_end - m_pos)) {
+      throw std::runtime_error("cache: truncated snapshot");
+    }
+  }
+
+  const char* m_pos;
+  const char* m_end;
+};
+
+}  // namespace cache
+}  // namespace zusixml
+
+#endif  // ZUSI_PARSER_CACHE_HPP_
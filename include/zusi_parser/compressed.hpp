@@ -0,0 +1,421 @@
+#ifndef ZUSI_PARSER_COMPRESSED_HPP_
+#define ZUSI_PARSER_COMPRESSED_HPP_
+
+// Komprimierte Eingaben: Eintraege aus Zip-Archiven sowie gzip- und zstd-Dateien, ohne sie vorher auszupacken.
+// Deflate und gzip benoetigen zlib (ZUSI_PARSER_USE_ZLIB), zstd benoetigt libzstd (ZUSI_PARSER_USE_ZSTD);
+// in CMake werden beide ueber die gleichnamigen Variablen an die Parser-Targets gebunden.
+// Ist ZUSIXML_INCREMENTAL definiert, laeuft der Parser (StreamParser) parallel zum Entpacken und liest jeden
+// Block, sobald er entpackt ist. Sonst wird zuerst in einen Puffer entpackt und dann geparst.
+
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "zusi_parser/utils.hpp"
+
+#if defined(ZUSI_PARSER_USE_ZLIB)
+#include <zlib.h>
+#endif
+#if defined(ZUSI_PARSER_USE_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace zusixml {
+
+namespace detail {
+
+/// Groesse der Bloecke, in denen entpackt und an den Parser weitergegeben wird.
+constexpr size_t entpackBlockgroesse = size_t(256) << 10;
+
+inline uint16_t leseLe16(const unsigned char* p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t leseLe32(const unsigned char* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16)
+      | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+/// Ziel fuer das Entpacken ohne StreamParser: ein wachsender Puffer.
+class EntpackPuffer {
+ public:
+  explicit EntpackPuffer(size_t erwarteteGroesse) : m_daten(std::make_shared<std::vector<Ch>>()) {
+    m_daten->reserve(erwarteteGroesse);
+  }
+
+  Ch* prepare(size_t size) {
+    if (m_daten->size() < m_size + size) {
+      m_daten->resize(std::max(m_size + size, 2 * m_daten->size()));
+    }
+    return m_daten->data() + m_size;
+  }
+
+  void commit(size_t size) {
+    m_size += size;
+  }
+
+  const Ch* data() const {
+    return m_daten->data();
+  }
+
+  size_t size() const {
+    return m_size;
+  }
+
+  /// Uebergibt den Puffer, z.B. an das Dokument (hold_input).
+  std::shared_ptr<const void> release() {
+    return std::move(m_daten);
+  }
+
+ private:
+  std::shared_ptr<std::vector<Ch>> m_daten;
+  size_t m_size { 0 };
+};
+
+#if defined(ZUSI_PARSER_USE_ZLIB)
+/// Entpackt Deflate-Daten (@p windowBits wie bei inflateInit2()) blockweise nach @p ziel
+/// (mit prepare() und commit() wie bei StreamParser). Gibt die CRC-32 der entpackten Daten zurueck.
+/// Mit @p mehrereMitglieder werden hintereinandergehaengte gzip-Mitglieder nacheinander entpackt.
+template<typename Ziel>
+uLong inflateNach(const unsigned char* daten, size_t size, int windowBits, bool mehrereMitglieder, Ziel& ziel) {
+  z_stream stream {};
+  if (inflateInit2(&stream, windowBits) != Z_OK) {
+    throw std::runtime_error("inflateInit2() failed");
+  }
+  std::unique_ptr<z_stream, int (*)(z_stream*)> streamFreigeben(&stream, inflateEnd);
+  uLong crc = crc32(0, Z_NULL, 0);
+  size_t rest = size;
+  while (true) {
+    if (stream.avail_in == 0 && rest > 0) {
+      // avail_in ist nur 32 Bit breit.
+      stream.next_in = const_cast<Bytef*>(daten + (size - rest));
+      stream.avail_in = static_cast<uInt>(std::min<size_t>(rest, UINT_MAX));
+      rest -= stream.avail_in;
+    }
+    Ch* block = ziel.prepare(entpackBlockgroesse);
+    stream.next_out = reinterpret_cast<Bytef*>(block);
+    stream.avail_out = static_cast<uInt>(entpackBlockgroesse);
+    const int ergebnis = inflate(&stream, Z_NO_FLUSH);
+    const size_t entpackt = entpackBlockgroesse - stream.avail_out;
+    crc = crc32(crc, reinterpret_cast<const Bytef*>(block), static_cast<uInt>(entpackt));
+    ziel.commit(entpackt);
+    if (ergebnis == Z_STREAM_END) {
+      if (mehrereMitglieder && (stream.avail_in > 0 || rest > 0)) {
+        inflateReset(&stream);
+        continue;
+      }
+      return crc;
+    }
+    if (ergebnis == Z_BUF_ERROR && stream.avail_in == 0 && rest == 0) {
+      throw std::runtime_error("inflate(): unexpected end of data");
+    }
+    if (ergebnis != Z_OK && ergebnis != Z_BUF_ERROR) {
+      throw std::runtime_error(std::string("inflate() failed: ") + (stream.msg != nullptr ? stream.msg : std::to_string(ergebnis)));
+    }
+  }
+}
+#endif
+
+#if defined(ZUSI_PARSER_USE_ZSTD)
+/// Entpackt einen oder mehrere zstd-Frames blockweise nach @p ziel (wie inflateNach).
+template<typename Ziel>
+void zstdNach(const unsigned char* daten, size_t size, Ziel& ziel) {
+  std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx*)> kontext(ZSTD_createDCtx(), ZSTD_freeDCtx);
+  if (!kontext) {
+    throw std::runtime_error("ZSTD_createDCtx() failed");
+  }
+  ZSTD_inBuffer eingabe { daten, size, 0 };
+  while (true) {
+    ZSTD_outBuffer ausgabe { ziel.prepare(entpackBlockgroesse), entpackBlockgroesse, 0 };
+    const size_t ergebnis = ZSTD_decompressStream(kontext.get(), &ausgabe, &eingabe);
+    if (ZSTD_isError(ergebnis)) {
+      throw std::runtime_error(std::string("ZSTD_decompressStream() failed: ") + ZSTD_getErrorName(ergebnis));
+    }
+    ziel.commit(ausgabe.pos);
+    if (eingabe.pos == eingabe.size && ausgabe.pos < ausgabe.size) {
+      // Alles gelesen und nichts mehr zurueckgehalten: 0 heisst, der letzte Frame ist vollstaendig.
+      if (ergebnis != 0) {
+        throw std::runtime_error("ZSTD_decompressStream(): unexpected end of data");
+      }
+      return;
+    }
+  }
+}
+#endif
+
+/// Parst die Daten, die @p entpacken (aufgerufen mit einem Ziel wie bei inflateNach) liefert.
+/// @p groesse ist die entpackte Groesse, falls bekannt, sonst 0. Fehler werden wie bei parseFile unter @p name ausgegeben.
+template<typename Entpacken>
+root_ptr<Zusi> parseEntpackt(std::string_view name, size_t groesse, Entpacken&& entpacken) {
+  try {
+#if defined(ZUSIXML_INCREMENTAL)
+    // Bei bekannter Groesse genuegt ein kleiner Adressbereich; prepare() fordert immer einen ganzen Block an.
+    StreamParser ziel(groesse > 0 ? groesse + entpackBlockgroesse : StreamParser::defaultMaxSize);
+    entpacken(ziel);
+    try {
+      return ziel.finish();
+    } catch (const zusixml::parse_error& e) {
+      io::cerr << "Error parsing " << name << ": " << e.what() << " at char " << (e.where() - ziel.data()) << "\n";
+    }
+#else
+    EntpackPuffer ziel(groesse);
+    entpacken(ziel);
+    const char* daten = ziel.data();
+    return parseDaten(name, daten, daten + ziel.size(), ziel.release());
+#endif
+  } catch (const std::exception& e) {
+    io::cerr << "Error reading " << name << ": " << e.what() << "\n";
+  }
+  return nullptr;
+}
+
+}  // namespace detail
+
+/// Liest die Eintraege eines Zip-Archivs ueber dessen zentrales Verzeichnis. Das Archiv wird einmal eingeblendet;
+/// gespeicherte (unkomprimierte) Eintraege sind Ausschnitte daraus, Deflate-Eintraege werden beim Lesen entpackt.
+/// ZIP64 und verschluesselte Eintraege werden nicht unterstuetzt.
+class ZipReader {
+ public:
+  static constexpr uint16_t gespeichert = 0;
+  static constexpr uint16_t deflate = 8;
+
+  struct Entry {
+    std::string name;  // wie im Archiv, mit '/' als Trennzeichen
+    uint16_t flags;
+    uint16_t method;
+    uint32_t crc;
+    uint64_t compressedSize;
+    uint64_t size;
+    uint64_t localHeaderOffset;
+  };
+
+  explicit ZipReader(std::string_view dateiname, const FileLoadPolicy& policy = {})
+      : m_dateiname(dateiname), m_file(dateiname, policy) {
+    m_data = reinterpret_cast<const unsigned char*>(m_file.data());
+    try {
+      readDirectory();
+    } catch (const std::runtime_error& e) {
+      throw std::runtime_error(m_dateiname + ": " + e.what());
+    }
+  }
+
+  ZipReader(const ZipReader&) = delete;
+  ZipReader& operator=(const ZipReader&) = delete;
+
+  /// Anzahl der Eintraege (ohne Verzeichnisse).
+  size_t size() const {
+    return m_entries.size();
+  }
+
+  const Entry& operator[](size_t i) const {
+    return m_entries[i];
+  }
+
+  /// Sucht einen Eintrag nach seinem Zusi-Pfad, ohne Beachtung der Gross-/Kleinschreibung (ASCII).
+  /// Backslash und Slash gelten als gleich; ein fuehrendes Trennzeichen wird ignoriert.
+  const Entry* find(std::string_view zusiPfad) const {
+    const auto it = m_index.find(schluessel(zusiPfad));
+    return it == m_index.end() ? nullptr : &m_entries[it->second];
+  }
+
+  /// Die Daten des Eintrags, wie sie im Archiv stehen (bei gespeicherten Eintraegen also der Inhalt).
+  std::string_view rawData(const Entry& entry) const {
+    if (entry.localHeaderOffset > m_file.size() || m_file.size() - entry.localHeaderOffset < 30
+        || detail::leseLe32(m_data + entry.localHeaderOffset) != 0x04034b50) {
+      throw std::runtime_error(m_dateiname + ": invalid local header for " + entry.name);
+    }
+    const unsigned char* header = m_data + entry.localHeaderOffset;
+    const uint64_t offset = entry.localHeaderOffset + 30 + detail::leseLe16(header + 26) + detail::leseLe16(header + 28);
+    if (offset > m_file.size() || entry.compressedSize > m_file.size() - offset) {
+      throw std::runtime_error(m_dateiname + ": invalid local header for " + entry.name);
+    }
+    return std::string_view(reinterpret_cast<const char*>(m_data + offset), entry.compressedSize);
+  }
+
+  /// Entpackt den Eintrag blockweise nach @p ziel (mit prepare() und commit() wie bei StreamParser)
+  /// und prueft Groesse und, falls zlib verfuegbar ist, die CRC-32.
+  template<typename Ziel>
+  void extract(const Entry& entry, Ziel& ziel) const {
+    if (entry.flags & 1) {
+      throw std::runtime_error(m_dateiname + ": " + entry.name + " is encrypted");
+    }
+    const std::string_view daten = rawData(entry);
+    [[maybe_unused]] const auto* bytes = reinterpret_cast<const unsigned char*>(daten.data());
+    [[maybe_unused]] unsigned long crc = 0;
+    if (entry.method == gespeichert) {
+      for (size_t pos = 0; pos < daten.size(); pos += detail::entpackBlockgroesse) {
+        const size_t block = std::min(daten.size() - pos, detail::entpackBlockgroesse);
+        std::memcpy(ziel.prepare(block), daten.data() + pos, block);
+        ziel.commit(block);
+      }
+#if defined(ZUSI_PARSER_USE_ZLIB)
+      crc = ::crc32(0, bytes, 0);
+      for (size_t pos = 0; pos < daten.size(); pos += UINT_MAX) {
+        crc = ::crc32(crc, bytes + pos, static_cast<uInt>(std::min<size_t>(daten.size() - pos, UINT_MAX)));
+      }
+#endif
+    } else if (entry.method == deflate) {
+#if defined(ZUSI_PARSER_USE_ZLIB)
+      const size_t vorher = ziel.size();
+      crc = detail::inflateNach(bytes, daten.size(), -MAX_WBITS, false, ziel);
+      if (ziel.size() - vorher != entry.size) {
+        throw std::runtime_error(m_dateiname + ": size mismatch for " + entry.name);
+      }
+#else
+      throw std::runtime_error(m_dateiname + ": " + entry.name + ": deflate requires ZUSI_PARSER_USE_ZLIB");
+#endif
+    } else {
+      throw std::runtime_error(m_dateiname + ": " + entry.name + ": unsupported compression method " + std::to_string(entry.method));
+    }
+#if defined(ZUSI_PARSER_USE_ZLIB)
+    if (crc != entry.crc) {
+      throw std::runtime_error(m_dateiname + ": CRC mismatch for " + entry.name);
+    }
+#endif
+  }
+
+  /// Entpackt den Eintrag vollstaendig.
+  std::string read(const Entry& entry) const {
+    detail::EntpackPuffer puffer(entry.size);
+    extract(entry, puffer);
+    return std::string(puffer.data(), puffer.size());
+  }
+
+ private:
+  static std::string schluessel(std::string_view pfad) {
+    if (!pfad.empty() && (pfad.front() == '\\' || pfad.front() == '/')) {
+      pfad.remove_prefix(1);
+    }
+    std::string result(pfad);
+    for (char& c : result) {
+      c = c == '\\' ? '/' : (c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+    }
+    return result;
+  }
+
+  void readDirectory() {
+    // Ende des zentralen Verzeichnisses: 22 Bytes plus Kommentar mit hoechstens 65535 Bytes am Dateiende.
+    const size_t size = m_file.size();
+    if (size < 22) {
+      throw std::runtime_error("zip: file too small");
+    }
+    size_t ende = size - 22;
+    const size_t suchende = size - 22 > 0xffff ? size - 22 - 0xffff : 0;
+    while (detail::leseLe32(m_data + ende) != 0x06054b50 || ende + 22 + detail::leseLe16(m_data + ende + 20) != size) {
+      if (ende == suchende) {
+        throw std::runtime_error("zip: end of central directory not found");
+      }
+      ende--;
+    }
+    const uint16_t anzahl = detail::leseLe16(m_data + ende + 10);
+    const uint32_t verzeichnisGroesse = detail::leseLe32(m_data + ende + 12);
+    const uint32_t verzeichnisOffset = detail::leseLe32(m_data + ende + 16);
+    if (anzahl == 0xffff || verzeichnisGroesse == 0xffffffff || verzeichnisOffset == 0xffffffff) {
+      throw std::runtime_error("zip: ZIP64 is not supported");
+    }
+    if (verzeichnisOffset > ende || verzeichnisGroesse > ende - verzeichnisOffset) {
+      throw std::runtime_error("zip: invalid central directory");
+    }
+
+    m_entries.reserve(anzahl);
+    size_t pos = verzeichnisOffset;
+    const size_t verzeichnisEnde = size_t(verzeichnisOffset) + verzeichnisGroesse;
+    for (size_t i = 0; i < anzahl; i++) {
+      if (verzeichnisEnde - pos < 46 || detail::leseLe32(m_data + pos) != 0x02014b50) {
+        throw std::runtime_error("zip: invalid central directory entry " + std::to_string(i));
+      }
+      const unsigned char* e = m_data + pos;
+      const size_t laengen = size_t(detail::leseLe16(e + 28)) + detail::leseLe16(e + 30) + detail::leseLe16(e + 32);
+      if (verzeichnisEnde - pos - 46 < laengen) {
+        throw std::runtime_error("zip: invalid central directory entry " + std::to_string(i));
+      }
+      Entry entry { std::string(reinterpret_cast<const char*>(e + 46), detail::leseLe16(e + 28)), detail::leseLe16(e + 8),
+          detail::leseLe16(e + 10), detail::leseLe32(e + 16), detail::leseLe32(e + 20), detail::leseLe32(e + 24),
+          detail::leseLe32(e + 42) };
+      pos += 46 + laengen;
+      if (entry.compressedSize == 0xffffffff || entry.size == 0xffffffff || entry.localHeaderOffset == 0xffffffff) {
+        throw std::runtime_error("zip: ZIP64 is not supported");
+      }
+      if (!entry.name.empty() && entry.name.back() == '/') {
+        continue;  // Verzeichnis
+      }
+      if (!m_index.emplace(schluessel(entry.name), m_entries.size()).second) {
+        throw std::runtime_error("zip: duplicate entry " + entry.name);
+      }
+      m_entries.push_back(std::move(entry));
+    }
+  }
+
+  std::string m_dateiname;
+  FileReader m_file;
+  const unsigned char* m_data { nullptr };
+  std::vector<Entry> m_entries;
+  std::unordered_map<std::string, size_t> m_index;
+};
+
+/// Wie parseFile, aber fuer einen Eintrag aus einem Zip-Archiv. Gespeicherte Eintraege werden direkt
+/// aus dem eingeblendeten Archiv geparst, Deflate-Eintraege blockweise entpackt.
+static inline zusixml::root_ptr<Zusi> parseFile(const std::shared_ptr<const ZipReader>& zip, std::string_view zusiPfad) {
+  const ZipReader::Entry* entry = zip->find(zusiPfad);
+  if (entry == nullptr) {
+    io::cerr << "Error reading " << zusiPfad << ": not in zip\n";
+    return nullptr;
+  }
+  if (entry->method != ZipReader::gespeichert || (entry->flags & 1)) {
+    return detail::parseEntpackt(zusiPfad, entry->size, [&](auto& ziel) {
+      zip->extract(*entry, ziel);
+    });
+  }
+  try {
+    const std::string_view daten = zip->rawData(*entry);
+    return detail::parseDaten(zusiPfad, daten.data(), daten.data() + daten.size(), zip);
+  } catch (const std::exception& e) {
+    io::cerr << "Error reading " << zusiPfad << ": " << e.what() << "\n";
+  }
+  return nullptr;
+}
+
+/// Wie parseFile, erkennt aber gzip- und zstd-komprimierte Dateien an ihren ersten Bytes und entpackt sie
+/// blockweise. Andere Dateien werden wie bei parseFile direkt geparst.
+static inline zusixml::root_ptr<Zusi> parseCompressedFile(std::string_view dateiname) {
+  std::shared_ptr<FileReader> reader;
+  try {
+    FileLoadPolicy policy;
+    policy.sequential = true;
+    reader = std::make_shared<FileReader>(dateiname, policy);
+  } catch (const std::exception& e) {
+    io::cerr << "Error reading " << dateiname << ": " << e.what() << "\n";
+    return nullptr;
+  }
+  const auto* bytes = reinterpret_cast<const unsigned char*>(reader->data());
+  const size_t size = reader->size();
+  if (size >= 2 && bytes[0] == 0x1f && bytes[1] == 0x8b) {
+    return detail::parseEntpackt(dateiname, 0, [&](auto& ziel) {
+#if defined(ZUSI_PARSER_USE_ZLIB)
+      detail::inflateNach(bytes, size, MAX_WBITS + 16, true, ziel);
+#else
+      (void)ziel;
+      throw std::runtime_error("gzip requires ZUSI_PARSER_USE_ZLIB");
+#endif
+    });
+  }
+  if (size >= 4 && detail::leseLe32(bytes) == 0xfd2fb528) {
+    return detail::parseEntpackt(dateiname, 0, [&](auto& ziel) {
+#if defined(ZUSI_PARSER_USE_ZSTD)
+      detail::zstdNach(bytes, size, ziel);
+#else
+      (void)ziel;
+      throw std::runtime_error("zstd requires ZUSI_PARSER_USE_ZSTD");
+#endif
+    });
+  }
+  const char* daten = reader->data();
+  return detail::parseDaten(dateiname, daten, daten + size, std::move(reader));
+}
+
+}  // namespace zusixml
+
+#endif  // ZUSI_PARSER_COMPRESSED_HPP_
@@ -0,0 +1,102 @@
+#ifndef ZUSI_PARSER_DATETIME_HPP_
+#define ZUSI_PARSER_DATETIME_HPP_
+
+#include <cstdint>
+#include <ctime>
+
+namespace zusixml {
+
+/// Datum und Uhrzeit in 8 Bytes (parsergen-Option --compact-datetime, sonst struct tm).
+/// Die Felder sind so in einem 64-Bit-Wort abgelegt, dass der Vergleich zweier Werte
+/// einem Ganzzahlvergleich entspricht und chronologisch sortiert:
+/// Jahr (16 Bit) | Monat (8) | Tag (8) | Stunde (16) | Minute (8) | Sekunde (8).
+/// Nicht angegebene Felder (z.B. das Datum bei einer reinen Uhrzeit) sind 0.
+class datetime {
+ public:
+  constexpr datetime() = default;
+  constexpr datetime(int year, int month, int day, int hour = 0, int minute = 0, int second = 0)
+    : m_value((static_cast<uint64_t>(year & 0xFFFF) << year_shift)
+        | (static_cast<uint64_t>(month & 0xFF) << month_shift)
+        | (static_cast<uint64_t>(day & 0xFF) << day_shift)
+        | (static_cast<uint64_t>(hour & 0xFFFF) << hour_shift)
+        | (static_cast<uint64_t>(minute & 0xFF) << minute_shift)
+        | (static_cast<uint64_t>(second & 0xFF) << second_shift)) {}
+
+  constexpr int year() const { return static_cast<int>((m_value >> year_shift) & 0xFFFF); }
+  constexpr int month() const { return static_cast<int>((m_value >> month_shift) & 0xFF); }
+  constexpr int day() const { return static_cast<int>((m_value >> day_shift) & 0xFF); }
+  constexpr int hour() const { return static_cast<int>((m_value >> hour_shift) & 0xFFFF); }
+  constexpr int minute() const { return static_cast<int>((m_value >> minute_shift) & 0xFF); }
+  constexpr int second() const { return static_cast<int>((m_value >> second_shift) & 0xFF); }
+
+  /// Sekunden seit Mitternacht (bzw. seit Fahrplanbeginn bei Uhrzeiten ohne Datum).
+  constexpr int32_t seconds_of_day() const { return hour() * 3600 + minute() * 60 + second(); }
+
+  /// Das gepackte 64-Bit-Wort.
+  constexpr uint64_t value() const { return m_value; }
+
+  /// Wandelt in struct tm um, mit denselben Werten, die der Parser ohne --compact-datetime liefert:
+  /// tm_year = Jahr - 1900 (0 ohne Datum), tm_mon = Monat wie in der Datei (1-12), alle anderen Felder 0.
+  std::tm to_tm() const {
+    std::tm result {};
+    const int y = year();
+    result.tm_year = y ? y - 1900 : 0;
+    result.tm_mon = month();
+    result.tm_mday = day();
+    result.tm_hour = hour();
+    result.tm_min = minute();
+    result.tm_sec = second();
+    return result;
+  }
+
+  /// Umkehrung von to_tm().
+  static datetime from_tm(const std::tm& value) {
+    return datetime(value.tm_year ? value.tm_year + 1900 : 0, value.tm_mon, value.tm_mday,
+        value.tm_hour, value.tm_min, value.tm_sec);
+  }
+
+  void set_date(int year, int month, int day) {
+    m_value = (m_value & ~date_mask) | (datetime(year, month, day).m_value & date_mask);
+  }
+  void set_time(int hour, int minute, int second) {
+    m_value = (m_value & date_mask) | (datetime(0, 0, 0, hour, minute, second).m_value & ~date_mask);
+  }
+
+  friend constexpr bool operator==(datetime a, datetime b) { return a.m_value == b.m_value; }
+  friend constexpr bool operator!=(datetime a, datetime b) { return a.m_value != b.m_value; }
+  friend constexpr bool operator<(datetime a, datetime b) { return a.m_value < b.m_value; }
+  friend constexpr bool operator<=(datetime a, datetime b) { return a.m_value <= b.m_value; }
+  friend constexpr bool operator>(datetime a, datetime b) { return a.m_value > b.m_value; }
+  friend constexpr bool operator>=(datetime a, datetime b) { return a.m_value >= b.m_value; }
+
+ private:
+  static constexpr unsigned second_shift = 0;
+  static constexpr unsigned minute_shift = 8;
+  static constexpr unsigned hour_shift = 16;
+  static constexpr unsigned day_shift = 32;
+  static constexpr unsigned month_shift = 40;
+  static constexpr unsigned year_shift = 48;
+  static constexpr uint64_t date_mask = ~uint64_t { 0 } << day_shift;
+
+  uint64_t m_value { 0 };
+};
+
+static_assert(sizeof(datetime) == 8, "datetime must stay a single 64-bit word");
+
+/// Schreibt ein geparstes Datum bzw. eine Uhrzeit in das Ziel des Parsers (datetime oder struct tm).
+inline void set_date(datetime& result, int year, int month, int day) { result.set_date(year, month, day); }
+inline void set_time(datetime& result, int hour, int minute, int second) { result.set_time(hour, minute, second); }
+inline void set_date(std::tm& result, int year, int month, int day) {
+  result.tm_year = year - 1900;
+  result.tm_mon = month;
+  result.tm_mday = day;
+}
+inline void set_time(std::tm& result, int hour, int minute, int second) {
+  result.tm_hour = hour;
+  result.tm_min = minute;
+  result.tm_sec = second;
+}
+
+}  // namespace zusixml
+
+#endif  // ZUSI_PARSER_DATETIME_HPP_
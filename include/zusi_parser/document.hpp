@@ -0,0 +1,103 @@
+#ifndef ZUSI_PARSER_DOCUMENT_HPP_
+#define ZUSI_PARSER_DOCUMENT_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "zusi_parser/arena.hpp"
+#include "zusi_parser/intern.hpp"
+
+namespace zusixml {
+
+/// Ergebnis von parse_root, wenn der Parser mit --arena, --string-view, --intern oder --lazy erzeugt wurde.
+/// Verhaelt sich wie std::unique_ptr<T> und besitzt zusaetzlich
+///  - die Arena des Dokuments: mit --arena liegt darin das gesamte Dokument, mit --string-view
+///    die Attributwerte, die Zeichenreferenzen enthalten;
+///  - die intern_table mit den Werten der Attribute, die mit --intern angegeben wurden;
+///  - auf Wunsch die Eingabedaten (hold_input), auf die string_view-Attribute und mit --lazy
+///    uebergangene Kindelemente verweisen.
+/// Liegt das Dokument in der Arena, werden beim Zerstoeren keine Destruktoren aufgerufen, sondern nur
+/// die Bloecke der Arena freigegeben.
+/// Wird das Dokument nach dem Parsen veraendert, sollte dies innerhalb von
+/// arena::scope(dokument.memory()) geschehen, damit neuer Speicher ebenfalls in der Arena liegt.
+/// Ausserhalb kommt er von operator new und wird nur mit den Objekten freigegeben, die ihn halten.
+template <typename T>
+class document {
+ public:
+  document() = default;
+  document(std::nullptr_t) {}
+  document(document&& other) noexcept
+    : m_input(std::move(other.m_input)), m_strings(std::move(other.m_strings)), m_arena(std::move(other.m_arena)),
+      m_value(std::exchange(other.m_value, nullptr)), m_in_arena(other.m_in_arena) {}
+  document& operator=(document&& other) noexcept {
+    reset();
+    m_input = std::move(other.m_input);
+    m_strings = std::move(other.m_strings);
+    m_arena = std::move(other.m_arena);
+    m_value = std::exchange(other.m_value, nullptr);
+    m_in_arena = other.m_in_arena;
+    return *this;
+  }
+  ~document() { reset(); }
+
+  /// Legt eine neue Arena mit den Optionen @p opts und ein leeres Objekt vom Typ T an,
+  /// das in der Arena liegt, falls @p in_arena gesetzt ist, sonst auf dem Heap.
+  static document create(bool in_arena, const arena::options& opts = arena::default_options()) {
+    document result;
+    result.m_arena = std::make_unique<arena>(opts);
+    result.m_in_arena = in_arena;
+    if (in_arena) {
+      arena::scope scope(*result.m_arena);
+      result.m_value = arena_new<T>();
+    } else {
+      result.m_value = new T();
+    }
+    return result;
+  }
+
+  T* get() const { return m_value; }
+  T& operator*() const { return *m_value; }
+  T* operator->() const { return m_value; }
+  explicit operator bool() const { return m_value != nullptr; }
+
+  void reset() {
+    if (!m_in_arena) {
+      delete m_value;
+    }
+    m_value = nullptr;
+    m_arena.reset();
+    m_strings.reset();
+    m_input.reset();
+  }
+
+  /// Die Arena des Dokuments.
+  zusixml::arena& memory() const { return *m_arena; }
+
+  /// Die Tabelle der internierten Zeichenketten (nullptr ohne --intern).
+  intern_table* strings() const { return m_strings.get(); }
+
+  /// Legt die Tabelle fest, in die interniert wird. Gehoert sie nicht dem Dokument,
+  /// muss sie das Dokument ueberleben (etwa intern_table::shared()).
+  void use_strings(intern_table& table) { m_strings = std::shared_ptr<intern_table>(std::shared_ptr<intern_table>(), &table); }
+  void own_strings() { m_strings = std::make_shared<intern_table>(); }
+
+  /// Haelt @p input (z.B. den zusixml::FileReader mit den geparsten Daten) so lange am Leben wie das Dokument.
+  void hold_input(std::shared_ptr<const void> input) { m_input = std::move(input); }
+
+ private:
+  std::shared_ptr<const void> m_input;
+  std::shared_ptr<intern_table> m_strings;
+  std::unique_ptr<arena> m_arena;
+  T* m_value { nullptr };
+  bool m_in_arena { true };
+};
+
+template <typename T>
+bool operator==(const document<T>& d, std::nullptr_t) { return !d; }
+template <typename T>
+bool operator!=(const document<T>& d, std::nullptr_t) { return static_cast<bool>(d); }
+
+}  // namespace zusixml
+
+#endif  // ZUSI_PARSER_DOCUMENT_HPP_
@@ -0,0 +1,144 @@
+#ifndef ZUSI_PARSER_INTERN_HPP_
+#define ZUSI_PARSER_INTERN_HPP_
+
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+
+#include "zusi_parser/arena.hpp"
+
+namespace zusixml {
+
+/// Zeichenkette, die nur einmal in einer intern_table abgelegt ist (parsergen-Option --intern).
+/// Belegt nur einen Zeiger und ist so lange gueltig wie die Tabelle. Gleiche Werte aus derselben
+/// Tabelle haben dieselbe Adresse.
+class interned_string {
+ public:
+  interned_string() = default;
+
+  const char* data() const { return m_entry ? m_entry->data() : ""; }
+  size_t size() const { return m_entry ? m_entry->size : 0; }
+  bool empty() const { return size() == 0; }
+  std::string_view view() const { return std::string_view(data(), size()); }
+  operator std::string_view() const { return view(); }
+
+  friend bool operator==(interned_string a, interned_string b) { return a.m_entry == b.m_entry || a.view() == b.view(); }
+  friend bool operator!=(interned_string a, interned_string b) { return !(a == b); }
+  friend bool operator==(interned_string a, std::string_view b) { return a.view() == b; }
+  friend bool operator!=(interned_string a, std::string_view b) { return a.view() != b; }
+  friend bool operator==(std::string_view a, interned_string b) { return a == b.view(); }
+  friend bool operator!=(std::string_view a, interned_string b) { return a != b.view(); }
+  friend bool operator==(interned_string a, const char* b) { return a.view() == b; }
+  friend bool operator!=(interned_string a, const char* b) { return a.view() != b; }
+  friend std::ostream& operator<<(std::ostream& out, interned_string s) { return out << s.view(); }
+
+ private:
+  friend class intern_table;
+
+  struct entry {
+    size_t size;
+    const char* data() const { return reinterpret_cast<const char*>(this + 1); }
+  };
+
+  explicit interned_string(const entry* e) : m_entry(e) {}
+
+  const entry* m_entry { nullptr };
+};
+
+/// Tabelle, in der jeder Wert nur einmal abgelegt wird.
+/// Beim Parsen verwendet der Parser die Tabelle, die im aktuellen Thread installiert ist (intern_table::scope).
+/// Ist keine installiert, legt parse_root eine eigene Tabelle fuer das Dokument an.
+class intern_table {
+ public:
+  /// \param thread_safe Tabelle darf von mehreren Threads gleichzeitig verwendet werden.
+  explicit intern_table(bool thread_safe = false) : m_thread_safe(thread_safe) {}
+  intern_table(const intern_table&) = delete;
+  intern_table& operator=(const intern_table&) = delete;
+
+  interned_string intern(std::string_view value) {
+    if (m_thread_safe) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return intern_unlocked(value);
+    }
+    return intern_unlocked(value);
+  }
+
+  struct statistics {
+    size_t lookups { 0 };       ///< Anzahl der abgelegten Werte
+    size_t lookup_bytes { 0 };  ///< deren Gesamtlaenge
+    size_t unique { 0 };        ///< Anzahl der verschiedenen Werte
+    size_t unique_bytes { 0 };  ///< deren Gesamtlaenge
+  };
+
+  statistics stats() const {
+    if (m_thread_safe) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_stats;
+    }
+    return m_stats;
+  }
+
+  /// Eine threadsichere Tabelle fuer das gesamte Programm, die nie freigegeben wird.
+  /// Mit intern_table::scope scope(intern_table::shared()) werden Werte dokumentuebergreifend geteilt.
+  static intern_table& shared() {
+    static intern_table* result = new intern_table(true);
+    return *result;
+  }
+
+  /// Die im aktuellen Thread installierte Tabelle oder nullptr.
+  static intern_table* current() {
+    return current_pointer();
+  }
+
+  /// Installiert eine Tabelle fuer die Lebensdauer des Objekts im aktuellen Thread.
+  class scope {
+   public:
+    explicit scope(intern_table& table) : m_previous(current_pointer()) { current_pointer() = &table; }
+    scope(const scope&) = delete;
+    scope& operator=(const scope&) = delete;
+    ~scope() { current_pointer() = m_previous; }
+
+   private:
+    intern_table* m_previous;
+  };
+
+ private:
+  static intern_table*& current_pointer() {
+    static thread_local intern_table* result = nullptr;
+    return result;
+  }
+
+  interned_string intern_unlocked(std::string_view value) {
+    m_stats.lookups++;
+    m_stats.lookup_bytes += value.size();
+    if (value.empty()) {
+      return interned_string();
+    }
+    auto it = m_entries.find(value);
+    if (it != m_entries.end()) {
+      return interned_string(it->second);
+    }
+    void* memory = m_memory.allocate(sizeof(interned_string::entry) + value.size() + 1, alignof(interned_string::entry));
+    auto* e = new (memory) interned_string::entry { value.size() };
+    char* data = const_cast<char*>(e->data());
+    std::memcpy(data, value.data(), value.size());
+    data[value.size()] = '\0';
+    m_entries.emplace(std::string_view(data, value.size()), e);
+    m_stats.unique++;
+    m_stats.unique_bytes += value.size();
+    return interned_string(e);
+  }
+
+  arena m_memory;
+  std::unordered_map<std::string_view, const interned_string::entry*> m_entries;
+  statistics m_stats;
+  mutable std::mutex m_mutex;
+  const bool m_thread_safe;
+};
+
+}  // namespace zusixml
+
+#endif  // ZUSI_PARSER_INTERN_HPP_
@@ -2,10 +2,26 @@
 #define ZUSI_PARSER_LSB_HPP_
 
 #include "zusi_parser/zusi_types.hpp"
+#include "zusi_parser/soa.hpp"
 
 #include <string>
 #include <fstream>
 #include <type_traits>
+#include <vector>
+
+/// Liest @p count Elemente vom Typ T aus der lsb-Datei. Bei --soa werden sie zunaechst
+/// als Array von Strukturen gelesen und dann auf die Spalten verteilt.
+template <typename T, typename Container>
+void readLsbArray(std::istream& lsb_stream, Container& container, size_t count) {
+  if constexpr (zusixml::is_soa_vector_v<Container>) {
+    std::vector<T> buffer(count);
+    lsb_stream.read(reinterpret_cast<char*>(buffer.data()), buffer.size() * sizeof(T));
+    container.assign(buffer.begin(), buffer.end());
+  } else {
+    container.resize(count);
+    lsb_stream.read(reinterpret_cast<char*>(container.data()), container.size() * sizeof(T));
+  }
+}
 
 bool readLsb(Landschaft* ls3_datei, const zusixml::ZusiPfad& dateiname) {
   if (!ls3_datei->lsb.Dateiname.empty()) {
@@ -29,13 +45,11 @@ bool readLsb(Landschaft* ls3_datei, const zusixml::ZusiPfad& dateiname) {
         static_assert(offsetof(Vertex, V) == 28, "Wrong offset of Vertex::V");
         static_assert(offsetof(Vertex, U2) == 32, "Wrong offset of Vertex::U2");
         static_assert(offsetof(Vertex, V2) == 36, "Wrong offset of Vertex::V2");
-        mesh_subset->children_Vertex.resize(mesh_subset->MeshV);
-        lsb_stream.read(reinterpret_cast<char*>(mesh_subset->children_Vertex.data()), mesh_subset->children_Vertex.size() * sizeof(Vertex));
+        readLsbArray<Vertex>(lsb_stream, mesh_subset->children_Vertex, mesh_subset->MeshV);
 
         static_assert(sizeof(Face) == 6, "Wrong size of Face");
         assert(mesh_subset->MeshI % 3 == 0);
-        mesh_subset->children_Face.resize(mesh_subset->MeshI / 3);
-        lsb_stream.read(reinterpret_cast<char*>(mesh_subset->children_Face.data()), mesh_subset->children_Face.size() * sizeof(Face));
+        readLsbArray<Face>(lsb_stream, mesh_subset->children_Face, mesh_subset->MeshI / 3);
       }
     } catch (const std::ifstream::failure& e) {
       std::cerr << lsb_pfad << ": read() failed: " << e.what() << "\n";
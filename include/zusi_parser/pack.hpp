@@ -0,0 +1,271 @@
+#ifndef ZUSI_PARSER_PACK_HPP_
+#define ZUSI_PARSER_PACK_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace zusixml {
+
+/// Paketdatei mit vielen Dateien eines Zusi-Datenverzeichnisses (erstellt mit zusipack), die mit einem einzigen
+/// Oeffnen und Einblenden zugaenglich sind (PackReader in utils.hpp). Aufbau, alle Zahlen little-endian
+/// (auf Big-Endian-Rechnern vertauschen directory und writer die Bytes, siehe byte_order):
+///  - Kopf (pack::header)
+///  - die Dateiinhalte, jeweils gefolgt von einem Nullbyte
+///  - das Verzeichnis: header::count Eintraege (pack::entry), sortiert nach dem Zusi-Pfad ohne Beachtung
+///    der Gross-/Kleinschreibung (ASCII), danach die Zusi-Pfade ohne Trennzeichen.
+/// Zusi-Pfade sind relativ zum Datenverzeichnis, mit Backslash als Trennzeichen und ohne fuehrenden Backslash.
+namespace pack {
+
+constexpr char magic[8] = { 'Z', 'U', 'S', 'I', 'P', 'A', 'C', 'K' };
+constexpr uint32_t version = 1;
+
+struct header {
+  char magic[8];
+  uint32_t version;
+  uint32_t count;  // Anzahl der Eintraege
+  uint64_t index_offset;  // Position des ersten Eintrags
+  uint64_t names_offset;  // Position des ersten Zusi-Pfads
+};
+static_assert(sizeof(header) == 32);
+
+struct entry {
+  uint64_t name_offset;  // relativ zu header::names_offset
+  uint64_t data_offset;  // Position des Dateiinhalts
+  uint64_t data_size;  // ohne das folgende Nullbyte
+  int64_t mtime;  // Aenderungszeit der Datei in Sekunden seit 1970
+  uint32_t name_size;
+  uint32_t reserved;
+};
+static_assert(sizeof(entry) == 40);
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr bool host_big_endian = true;
+#else
+constexpr bool host_big_endian = false;
+#endif
+
+/// Wandelt eine Zahl zwischen der Byte-Reihenfolge der Datei (little-endian) und der des Rechners um.
+template <typename T>
+T byte_order(T value) {
+  if constexpr (host_big_endian) {
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    std::reverse(bytes, bytes + sizeof(T));
+    std::memcpy(&value, bytes, sizeof(T));
+  }
+  return value;
+}
+
+inline header byte_order(header h) {
+  h.version = byte_order(h.version);
+  h.count = byte_order(h.count);
+  h.index_offset = byte_order(h.index_offset);
+  h.names_offset = byte_order(h.names_offset);
+  return h;
+}
+
+inline entry byte_order(entry e) {
+  e.name_offset = byte_order(e.name_offset);
+  e.data_offset = byte_order(e.data_offset);
+  e.data_size = byte_order(e.data_size);
+  e.mtime = byte_order(e.mtime);
+  e.name_size = byte_order(e.name_size);
+  e.reserved = byte_order(e.reserved);
+  return e;
+}
+
+/// Vergleicht zwei Zusi-Pfade wie Windows ohne Beachtung der Gross-/Kleinschreibung (nur ASCII).
+inline int compare_paths(std::string_view lhs, std::string_view rhs) {
+  const size_t size = std::min(lhs.size(), rhs.size());
+  for (size_t i = 0; i < size; i++) {
+    const unsigned char l = lhs[i] >= 'A' && lhs[i] <= 'Z' ? lhs[i] - 'A' + 'a' : lhs[i];
+    const unsigned char r = rhs[i] >= 'A' && rhs[i] <= 'Z' ? rhs[i] - 'A' + 'a' : rhs[i];
+    if (l != r) {
+      return l < r ? -1 : 1;
+    }
+  }
+  return lhs.size() == rhs.size() ? 0 : (lhs.size() < rhs.size() ? -1 : 1);
+}
+
+/// Eine Datei im Paket. Wie bei FileReader folgt auf den Inhalt ein Nullbyte.
+class packed_file {
+ public:
+  packed_file(std::string_view path, const char* data, size_t size, int64_t mtime)
+      : m_path(path), m_data(data), m_size(size), m_mtime(mtime) {}
+
+  const char* data() const { return m_data; }
+  size_t size() const { return m_size; }
+  /// Aenderungszeit der Datei beim Packen in Sekunden seit 1970.
+  int64_t mtime() const { return m_mtime; }
+  /// Zusi-Pfad in der Schreibweise beim Packen.
+  std::string_view path() const { return m_path; }
+
+ private:
+  std::string_view m_path;
+  const char* m_data;
+  size_t m_size;
+  int64_t m_mtime;
+};
+
+/// Verzeichnis eines Pakets im Speicher. Prueft den Aufbau beim Erzeugen; wirft std::runtime_error bei Fehlern.
+class directory {
+ public:
+  directory(const char* data, size_t size) : m_data(data) {
+    if (size < sizeof(header)) {
+      throw std::runtime_error("pack: file too small");
+    }
+    std::memcpy(&m_header, data, sizeof(header));
+    m_header = byte_order(m_header);
+    if (std::memcmp(m_header.magic, magic, sizeof(magic)) != 0) {
+      throw std::runtime_error("pack: not a pack file");
+    }
+    if (m_header.version != version) {
+      throw std::runtime_error("pack: unsupported version " + std::to_string(m_header.version));
+    }
+    if (m_header.index_offset > size || (size - m_header.index_offset) / sizeof(entry) < m_header.count
+        || m_header.names_offset < m_header.index_offset + m_header.count * sizeof(entry) || m_header.names_offset > size) {
+      throw std::runtime_error("pack: invalid index");
+    }
+    for (size_t i = 0; i < m_header.count; i++) {
+      const entry e = get(i);
+      if (e.name_offset > size - m_header.names_offset || e.name_size > size - m_header.names_offset - e.name_offset
+          || e.data_offset >= m_header.index_offset || e.data_size >= m_header.index_offset - e.data_offset) {
+        throw std::runtime_error("pack: invalid entry " + std::to_string(i));
+      }
+    }
+  }
+
+  /// Anzahl der Dateien.
+  size_t size() const { return m_header.count; }
+
+  /// Die Datei mit dem Index @p i in der Reihenfolge des Verzeichnisses.
+  packed_file operator[](size_t i) const {
+    const entry e = get(i);
+    // Erst hier geprueft, damit das Oeffnen nicht jede Datei aus dem Paket einlesen muss.
+    if (m_data[e.data_offset + e.data_size] != '\0') {
+      throw std::runtime_error("pack: invalid entry " + std::to_string(i));
+    }
+    return packed_file(name(e), m_data + e.data_offset, e.data_size, e.mtime);
+  }
+
+  /// Sucht die Datei mit dem Zusi-Pfad @p path ohne Beachtung der Gross-/Kleinschreibung.
+  /// Ein fuehrender Backslash wird ignoriert.
+  std::optional<packed_file> find(std::string_view path) const {
+    if (!path.empty() && path.front() == '\\') {
+      path.remove_prefix(1);
+    }
+    size_t first = 0;
+    size_t count = m_header.count;
+    while (count > 0) {
+      const size_t step = count / 2;
+      if (compare_paths(name(get(first + step)), path) < 0) {
+        first += step + 1;
+        count -= step + 1;
+      } else {
+        count = step;
+      }
+    }
+    if (first < m_header.count && compare_paths(name(get(first)), path) == 0) {
+      return (*this)[first];
+    }
+    return std::nullopt;
+  }
+
+ private:
+  entry get(size_t i) const {
+    entry result;
+    std::memcpy(&result, m_data + m_header.index_offset + i * sizeof(entry), sizeof(entry));
+    return byte_order(result);
+  }
+
+  std::string_view name(const entry& e) const {
+    return std::string_view(m_data + m_header.names_offset + e.name_offset, e.name_size);
+  }
+
+  const char* m_data;
+  header m_header;
+};
+
+/// Schreibt ein Paket in einen Stream, der Positionieren erlaubt (std::ofstream im Binaermodus).
+/// Die Inhalte werden sofort geschrieben, das Verzeichnis bei finish().
+class writer {
+ public:
+  explicit writer(std::ostream& out) : m_out(out) {
+    const header placeholder {};
+    write(&placeholder, sizeof(placeholder));
+  }
+
+  /// Fuegt eine Datei hinzu. @p path wie bei directory::find.
+  void add(std::string_view path, std::string_view contents, int64_t mtime) {
+    if (!path.empty() && path.front() == '\\') {
+      path.remove_prefix(1);
+    }
+    m_files.push_back({ std::string(path), m_position, contents.size(), mtime });
+    write(contents.data(), contents.size());
+    write("", 1);
+  }
+
+  /// Schreibt das Verzeichnis und den Kopf. Wirft std::runtime_error, wenn zwei Zusi-Pfade
+  /// sich nur in der Gross-/Kleinschreibung unterscheiden oder nicht geschrieben werden konnte.
+  void finish() {
+    std::sort(m_files.begin(), m_files.end(), [](const file& lhs, const file& rhs) {
+      return compare_paths(lhs.path, rhs.path) < 0;
+    });
+    header h {};
+    std::memcpy(h.magic, magic, sizeof(magic));
+    h.version = version;
+    h.count = static_cast<uint32_t>(m_files.size());
+    h.index_offset = m_position;
+    h.names_offset = m_position + m_files.size() * sizeof(entry);
+
+    uint64_t name_offset = 0;
+    for (size_t i = 0; i < m_files.size(); i++) {
+      const file& f = m_files[i];
+      if (i > 0 && compare_paths(m_files[i - 1].path, f.path) == 0) {
+        throw std::runtime_error("pack: duplicate path " + f.path);
+      }
+      const entry e = byte_order(entry { name_offset, f.data_offset, f.data_size, f.mtime, static_cast<uint32_t>(f.path.size()), 0 });
+      write(&e, sizeof(e));
+      name_offset += f.path.size();
+    }
+    for (const file& f : m_files) {
+      write(f.path.data(), f.path.size());
+    }
+    m_out.seekp(0);
+    h = byte_order(h);
+    write(&h, sizeof(h));
+    m_out.flush();
+    if (!m_out) {
+      throw std::runtime_error("pack: write failed");
+    }
+  }
+
+ private:
+  struct file {
+    std::string path;
+    uint64_t data_offset;
+    uint64_t data_size;
+    int64_t mtime;
+  };
+
+  void write(const void* data, size_t size) {
+    m_out.write(static_cast<const char*>(data), size);
+    m_position += size;
+  }
+
+  std::ostream& m_out;
+  uint64_t m_position { 0 };
+  std::vector<file> m_files;
+};
+
+}  // namespace pack
+}  // namespace zusixml
+
+#endif  // ZUSI_PARSER_PACK_HPP_
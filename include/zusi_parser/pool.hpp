@@ -0,0 +1,51 @@
+#ifndef ZUSI_PARSER_POOL_HPP_
+#define ZUSI_PARSER_POOL_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace zusixml {
+
+/// Vorrat geleerter Elemente vom Typ T, aus dem der Parser neue Kindelemente nimmt (parsergen-Option --reuse).
+/// zusixml::parse_root_into leert das vorige Ergebnis und gibt dessen Kindelemente hierher zurueck,
+/// sodass das Parsen vieler aehnlicher Dateien nacheinander kaum noch Speicher anfordert.
+/// Jeder Thread hat seinen eigenen Vorrat.
+template <typename T>
+class element_pool {
+ public:
+  /// Liefert ein Element aus dem Vorrat, oder ein neues, wenn der Vorrat leer ist.
+  static std::unique_ptr<T> acquire() {
+    auto& elements = free_elements();
+    if (elements.empty()) {
+      return std::unique_ptr<T>(new T());
+    }
+    std::unique_ptr<T> result = std::move(elements.back());
+    elements.pop_back();
+    return result;
+  }
+
+  /// Nimmt ein Element in den Vorrat auf. Es muss geleert sein (clear_element_T), also einem neuen Element gleichen.
+  static void release(std::unique_ptr<T> element) {
+    free_elements().push_back(std::move(element));
+  }
+
+  /// Anzahl der Elemente im Vorrat dieses Threads.
+  static size_t size() { return free_elements().size(); }
+
+  /// Gibt den Vorrat dieses Threads frei.
+  static void clear() {
+    std::vector<std::unique_ptr<T>>().swap(free_elements());
+  }
+
+ private:
+  static std::vector<std::unique_ptr<T>>& free_elements() {
+    static thread_local std::vector<std::unique_ptr<T>> result;
+    return result;
+  }
+};
+
+}  // namespace zusixml
+
+#endif  // ZUSI_PARSER_POOL_HPP_
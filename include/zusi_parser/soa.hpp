@@ -0,0 +1,182 @@
+#ifndef ZUSI_PARSER_SOA_HPP_
+#define ZUSI_PARSER_SOA_HPP_
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace zusixml {
+
+namespace detail {
+
+template <typename MemberPointer>
+struct member_pointer_traits;
+
+template <typename Class, typename Value>
+struct member_pointer_traits<Value Class::*> {
+  using value_type = Value;
+};
+
+template <auto A, auto B>
+constexpr bool same_member() {
+  if constexpr (std::is_same_v<decltype(A), decltype(B)>) {
+    return A == B;
+  } else {
+    return false;
+  }
+}
+
+template <auto Member, auto... Members>
+constexpr size_t index_of_member() {
+  constexpr bool matches[] = { same_member<Member, Members>()... };
+  for (size_t i = 0; i < sizeof...(Members); i++) {
+    if (matches[i]) {
+      return i;
+    }
+  }
+  return sizeof...(Members);
+}
+
+}  // namespace detail
+
+/// Wiederholtes Kindelement als Structure of Arrays (parsergen-Option --soa): Jedes Member von T
+/// liegt in einem eigenen zusammenhaengenden Array, z.B. fuer Vertex die Positionen, Normalen und
+/// Texturkoordinaten. column<&Vertex::p>() liefert das Array der Positionen fuer SIMD-Schleifen.
+/// Zugriff per Index und Iteration liefern die Elemente wie bisher als T (als Kopie).
+template <typename T, template <typename> class Allocator, auto... Members>
+class soa_vector {
+  static_assert(sizeof...(Members) > 0, "soa_vector needs at least one member");
+  static_assert(std::is_default_constructible_v<T> && std::is_copy_assignable_v<T>,
+      "soa_vector needs a default-constructible, copyable element type");
+
+  template <auto Member>
+  using member_type = typename detail::member_pointer_traits<decltype(Member)>::value_type;
+
+ public:
+  using value_type = T;
+  using size_type = size_t;
+
+  /// Das Array, in dem soa_vector das Member @p Member aller Elemente ablegt.
+  template <auto Member>
+  using column_type = std::vector<member_type<Member>, Allocator<member_type<Member>>>;
+
+  /// Iterator fuer die AoS-Sicht. Liefert die Elemente als Wert.
+  class const_iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = T;
+
+    const_iterator() = default;
+    T operator*() const { return (*m_container)[m_index]; }
+    const_iterator& operator++() { ++m_index; return *this; }
+    const_iterator operator++(int) { const_iterator result = *this; ++m_index; return result; }
+    difference_type operator-(const const_iterator& other) const {
+      return static_cast<difference_type>(m_index) - static_cast<difference_type>(other.m_index);
+    }
+    friend bool operator==(const const_iterator& a, const const_iterator& b) { return a.m_index == b.m_index; }
+    friend bool operator!=(const const_iterator& a, const const_iterator& b) { return a.m_index != b.m_index; }
+
+   private:
+    friend class soa_vector;
+    const_iterator(const soa_vector* container, size_t index) : m_container(container), m_index(index) {}
+
+    const soa_vector* m_container { nullptr };
+    size_t m_index { 0 };
+  };
+
+  size_t size() const { return std::get<0>(m_columns).size(); }
+  bool empty() const { return size() == 0; }
+
+  void reserve(size_t n) { std::apply([n](auto&... columns) { (columns.reserve(n), ...); }, m_columns); }
+  void resize(size_t n) { std::apply([n](auto&... columns) { (columns.resize(n), ...); }, m_columns); }
+  void clear() { std::apply([](auto&... columns) { (columns.clear(), ...); }, m_columns); }
+
+  void push_back(const T& value) { push_back_members(value, indices()); }
+  void push_back(T&& value) { push_back_members(std::move(value), indices()); }
+
+  /// Setzt das Element aus den Arrays zusammen.
+  T operator[](size_t index) const { return get_members(index, indices()); }
+  T front() const { return (*this)[0]; }
+  T back() const { return (*this)[size() - 1]; }
+
+  /// Ueberschreibt alle Member des Elements @p index.
+  void set(size_t index, const T& value) { set_members(index, value, indices()); }
+
+  template <typename InputIt>
+  void assign(InputIt first, InputIt last) {
+    clear();
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>) {
+      reserve(static_cast<size_t>(std::distance(first, last)));
+    }
+    for (; first != last; ++first) {
+      push_back(*first);
+    }
+  }
+
+  /// Kopiert alle Elemente in ein Array von Strukturen, wie ohne --soa.
+  std::vector<T, Allocator<T>> to_vector() const {
+    std::vector<T, Allocator<T>> result;
+    result.reserve(size());
+    for (size_t i = 0; i < size(); i++) {
+      result.push_back((*this)[i]);
+    }
+    return result;
+  }
+
+  template <auto Member>
+  const column_type<Member>& column() const { return std::get<column_index<Member>()>(m_columns); }
+  template <auto Member>
+  column_type<Member>& column() { return std::get<column_index<Member>()>(m_columns); }
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, size()); }
+
+ private:
+  using indices = std::make_index_sequence<sizeof...(Members)>;
+
+  template <auto Member>
+  static constexpr size_t column_index() {
+    constexpr size_t result = detail::index_of_member<Member, Members...>();
+    static_assert(result < sizeof...(Members), "Member is not stored in this soa_vector");
+    return result;
+  }
+
+  template <typename Value, size_t... Is>
+  void push_back_members(Value&& value, std::index_sequence<Is...>) {
+    (std::get<Is>(m_columns).push_back(std::forward<Value>(value).*Members), ...);
+  }
+
+  template <size_t... Is>
+  T get_members(size_t index, std::index_sequence<Is...>) const {
+    T result {};
+    ((result.*Members = std::get<Is>(m_columns)[index]), ...);
+    return result;
+  }
+
+  template <size_t... Is>
+  void set_members(size_t index, const T& value, std::index_sequence<Is...>) {
+    ((std::get<Is>(m_columns)[index] = value.*Members), ...);
+  }
+
+  std::tuple<column_type<Members>...> m_columns;
+};
+
+template <typename T>
+struct is_soa_vector : std::false_type {};
+
+template <typename T, template <typename> class Allocator, auto... Members>
+struct is_soa_vector<soa_vector<T, Allocator, Members...>> : std::true_type {};
+
+template <typename T>
+constexpr bool is_soa_vector_v = is_soa_vector<T>::value;
+
+}  // namespace zusixml
+
+#endif  // ZUSI_PARSER_SOA_HPP_
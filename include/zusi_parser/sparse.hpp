@@ -0,0 +1,83 @@
+#ifndef ZUSI_PARSER_SPARSE_HPP_
+#define ZUSI_PARSER_SPARSE_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace zusixml {
+
+/// Selten vorhandene Attribute eines Elements (parsergen-Option --sparse-attributes).
+/// Die Werte liegen in einem Objekt vom Typ T, das erst angelegt wird, wenn eines der Attribute
+/// in der Datei vorkommt; bis dahin belegt das Element nur einen Zeiger. Eine Bitmaske vom Typ Mask
+/// haelt fest, welche Attribute vorhanden waren. Das Element bietet dazu fuer jedes Attribut Name()
+/// (ohne Attribute die Standardwerte T{}) und has_Name() an.
+template <typename T, typename Mask, template <typename> class Allocator>
+class sparse_attributes {
+  static_assert(std::is_unsigned_v<Mask>, "sparse_attributes needs an unsigned mask type");
+
+  struct block {
+    T values {};
+    Mask presence { 0 };
+  };
+  using block_allocator = Allocator<block>;
+
+ public:
+  sparse_attributes() = default;
+  sparse_attributes(const sparse_attributes& other) : m_block(other.m_block ? create(*other.m_block) : nullptr) {}
+  sparse_attributes(sparse_attributes&& other) noexcept : m_block(std::exchange(other.m_block, nullptr)) {}
+  sparse_attributes& operator=(sparse_attributes other) noexcept {
+    std::swap(m_block, other.m_block);
+    return *this;
+  }
+  ~sparse_attributes() {
+    if (m_block) {
+      m_block->~block();
+      block_allocator().deallocate(m_block, 1);
+    }
+  }
+
+  /// Ob das Attribut mit dem Index @p bit vorhanden war.
+  bool has(size_t bit) const { return m_block && (m_block->presence & (Mask(1) << bit)); }
+  /// Bitmaske der vorhandenen Attribute, 0 ohne Attribute.
+  Mask presence() const { return m_block ? m_block->presence : Mask(0); }
+  /// Ob das Objekt mit den Werten angelegt ist, d.h. mindestens ein Attribut vorhanden war.
+  explicit operator bool() const { return m_block != nullptr; }
+
+  const T& get() const { return m_block ? m_block->values : defaults(); }
+
+  /// Markiert das Attribut mit dem Index @p bit als vorhanden und liefert die Werte zum Setzen.
+  /// Legt das Objekt mit den Werten beim ersten Aufruf an.
+  T& set(size_t bit) {
+    if (!m_block) {
+      m_block = create(block {});
+    }
+    m_block->presence |= Mask(1) << bit;
+    return m_block->values;
+  }
+
+ private:
+  static const T& defaults() {
+    static const T result {};
+    return result;
+  }
+
+  static block* create(const block& value) {
+    block* result = block_allocator().allocate(1);
+    try {
+      new (result) block(value);
+    } catch (...) {
+      block_allocator().deallocate(result, 1);
+      throw;
+    }
+    return result;
+  }
+
+  block* m_block { nullptr };
+};
+
+}  // namespace zusixml
+
+#endif  // ZUSI_PARSER_SPARSE_HPP_
@@ -2,10 +2,26 @@
 #define ZUSI_PARSER_UTILS_HPP_
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <deque>
 #include <exception>
 #include <ios>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
+#include <utility>
 
 #ifdef _WIN32
 #  include <boost/nowide/iostream.hpp>
@@ -34,6 +50,10 @@
 
 #include "zusi_parser/zusi_types.hpp"
 #include "zusi_parser/zusi_parser.hpp"
+#include "zusi_parser/pack.hpp"
+#if defined(ZUSIXML_CACHE)
+#  include "zusi_parser/cache.hpp"
+#endif
 
 #define MMAP_THRESHOLD_BYTES 0
 
@@ -53,10 +73,27 @@ namespace io = std;
 
 namespace zusixml {
 
+/// Hinweise an das Betriebssystem, wie FileReader eine Datei laedt. Der Parser liest jede Datei genau einmal
+/// von vorne nach hinten. Alle Hinweise sind standardmaessig aus; unter Windows werden sie ignoriert.
+struct FileLoadPolicy {
+  /// Datei mit read() in einen Puffer lesen statt sie einzublenden.
+  bool read { false };
+  /// Sequentiellen Zugriff ankuendigen (MADV_SEQUENTIAL bzw. POSIX_FADV_SEQUENTIAL): groesseres Vorauslesen,
+  /// gelesene Seiten werden eher wieder freigegeben.
+  bool sequential { false };
+  /// Die ganze Datei sofort im Hintergrund einlesen lassen (MADV_WILLNEED bzw. POSIX_FADV_WILLNEED).
+  bool willNeed { false };
+  /// Dateien bis zu dieser Groesse beim Einblenden vollstaendig laden (MAP_POPULATE), statt Seite fuer Seite bei Zugriff.
+  size_t populateMaxSize { 0 };
+  /// Grosse Seiten fuer die Einblendung erlauben (MADV_HUGEPAGE; nur wirksam, wenn der Kernel das fuer Dateien unterstuetzt).
+  bool hugePages { false };
+};
+
 class FileReader {
  public:
-  FileReader(std::string_view dateiname) {
+  FileReader(std::string_view dateiname, const FileLoadPolicy& policy = {}) {
 #ifdef _WIN32
+    (void)policy;
     // TODO mmap
     io::basic_ifstream<std::remove_const_t<zusixml::Ch>> stream;
     stream.exceptions(io::ifstream::failbit | io::ifstream::eofbit | io::ifstream::badbit);
@@ -104,23 +141,76 @@ class FileReader {
       throw std::runtime_error(std::string(dateiname) + ": not a file");
     }
 
-    if (sb.st_size > MMAP_THRESHOLD_BYTES && sb.st_size % getpagesize() != 0) {
+    if (sb.st_size > MMAP_THRESHOLD_BYTES && !policy.read) {
+      int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+      if (static_cast<size_t>(sb.st_size) <= policy.populateMaxSize) {
+        flags |= MAP_POPULATE;
+      }
+#endif
       m_mmap = true;
-      m_mapsize = sb.st_size;
+      m_size = sb.st_size;
+      // Der Rest der letzten Seite hinter dem Dateiinhalt ist mit Nullbytes gefuellt. Fuellt die Datei
+      // die letzte Seite ganz aus, wird dahinter eine Seite mit Nullbytes eingeblendet: Dazu wird zuerst
+      // eine anonyme Einblendung ueber die ganze Laenge angelegt und die Datei dann an deren Anfang eingeblendet.
+      const size_t seite = sysconf(_SC_PAGESIZE);
+      void* adresse = nullptr;
+      m_mapsize = m_size;
+      if (m_size % seite == 0) {
+        m_mapsize = m_size + seite;
+        adresse = mmap(nullptr, m_mapsize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (adresse == MAP_FAILED) {
+          throw std::runtime_error(std::string(dateiname) + ": mmap() failed: " + std::strerror(errno));
+        }
+        flags |= MAP_FIXED;
+      }
       m_data = mmap(
-        nullptr,          // addr: kernel chooses mapping address
-        sb.st_size,       // length
+        adresse,          // addr: kernel chooses mapping address, or the anonymous mapping from above
+        m_size,           // length
         PROT_READ,        // prot
-        MAP_SHARED,       // flags
+        flags,            // flags
         fdHelper.fd,      // fd
         0                 // offset in file
       );
       if (m_data == MAP_FAILED) {
-        throw std::runtime_error(std::string(dateiname) + ": mmap() failed: " + std::strerror(errno));
+        const int fehler = errno;
+        if (adresse != nullptr) {
+          munmap(adresse, m_mapsize);
+        }
+        throw std::runtime_error(std::string(dateiname) + ": mmap() failed: " + std::strerror(fehler));
+      }
+      // Nur Hinweise, Fehler werden ignoriert.
+      if (policy.sequential) {
+        madvise(m_data, m_size, MADV_SEQUENTIAL);
+      }
+      if (policy.willNeed) {
+        madvise(m_data, m_size, MADV_WILLNEED);
       }
+#ifdef MADV_HUGEPAGE
+      if (policy.hugePages) {
+        madvise(m_data, m_size, MADV_HUGEPAGE);
+      }
+#endif
     } else {
+#ifdef POSIX_FADV_SEQUENTIAL
+      if (policy.sequential) {
+        posix_fadvise(fdHelper.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+      }
+      if (policy.willNeed) {
+        posix_fadvise(fdHelper.fd, 0, 0, POSIX_FADV_WILLNEED);
+      }
+#endif
       m_buffer = std::vector<std::remove_const_t<zusixml::Ch>>(sb.st_size + 1, 0);
-      read(fdHelper.fd, m_buffer.data(), sb.st_size);
+      for (size_t gelesen = 0; gelesen < static_cast<size_t>(sb.st_size); ) {
+        const ssize_t result = ::read(fdHelper.fd, m_buffer.data() + gelesen, sb.st_size - gelesen);
+        if (result == -1 && errno == EINTR) {
+          continue;
+        }
+        if (result <= 0) {
+          throw std::runtime_error(std::string(dateiname) + ": read() failed: " + (result == 0 ? "unexpected end of file" : std::strerror(errno)));
+        }
+        gelesen += result;
+      }
       m_data = m_buffer.data();
     }
 
@@ -149,17 +239,21 @@ class FileReader {
 #else
   FileReader(FileReader&& other) {
     m_data = other.m_data;
+    m_size = other.m_size;
     m_mapsize = other.m_mapsize;
     m_mmap = other.m_mmap;
     m_buffer = std::move(other.m_buffer);
 
     other.m_data = MAP_FAILED;
+    other.m_size = 0;
     other.m_mapsize = 0;
     other.m_mmap = false;
   }
 #endif
   FileReader& operator=(FileReader&&) = delete;
 
+  /// Zeiger auf den Dateiinhalt, das Ende ist data() + size(). Dahinter folgt stets ein Nullbyte,
+  /// sodass der Inhalt auch ohne Kopie nullterminiert ist (z.B. fuer parse_root(const Ch*)).
   const zusixml::Ch* data() {
 #ifdef _WIN32
     return m_buffer.data();
@@ -168,11 +262,23 @@ class FileReader {
 #endif
   }
 
+  /// Dateigroesse in Bytes (ohne evtl. angehaengtes Nullbyte).
   size_t size() const {
 #ifdef _WIN32
-    return m_buffer.size();
+    return m_buffer.size() - 1;
 #else
-    return m_mmap ? m_mapsize : m_buffer.size();
+    return m_mmap ? m_size : m_buffer.size() - 1;
+#endif
+  }
+
+  /// Gibt die eingeblendeten Seiten frei (MADV_DONTNEED), z.B. nach dem Parsen, wenn das Ergebnis nicht
+  /// in die Datei verweist. Die Daten bleiben lesbar und werden bei Zugriff erneut aus dem Seitencache geladen.
+  /// Ohne Einblendung wirkungslos.
+  void dontNeed() {
+#ifndef _WIN32
+    if (m_mmap) {
+      madvise(m_data, m_size, MADV_DONTNEED);
+    }
 #endif
   }
 
@@ -180,27 +286,363 @@ class FileReader {
 #ifdef _WIN32
 #else
   void* m_data { MAP_FAILED };
-  off_t m_mapsize { 0 };
+  size_t m_size { 0 };  // Dateigroesse
+  size_t m_mapsize { 0 };  // Laenge der Einblendung, ggf. mit der Seite mit Nullbytes
   bool m_mmap { false };
 #endif
   std::vector<std::remove_const_t<zusixml::Ch>> m_buffer;
 };
 
-static inline std::unique_ptr<Zusi> parseFile(std::string_view dateiname) {
+namespace detail {
+/// Parst die Zusi-Datei [@p begin, @p end). Parse-Fehler werden unter @p name ausgegeben; das Ergebnis ist dann nullptr.
+/// Verweist das Ergebnis in die Daten (--string-view, --lazy), haelt es @p eingabe am Leben.
+inline root_ptr<Zusi> parseDaten(std::string_view name, const char* begin, const char* end, std::shared_ptr<const void> eingabe) {
   try {
-    FileReader reader(dateiname);
+    auto result = zusixml::parse_root<Zusi>(begin, end);
+#if defined(ZUSIXML_STRING_VIEW) || defined(ZUSIXML_LAZY)
+    result.hold_input(std::move(eingabe));
+#else
+    (void)eingabe;
+#endif
+    return result;
+  } catch (const zusixml::parse_error& e) {
+    io::cerr << "Error parsing " << name << ": " << e.what() << " at char " << (e.where() - begin) << "\n";
+  }
+  return nullptr;
+}
+}  // namespace detail
+
+#if defined(ZUSIXML_CACHE)
+/// Parse-Cache auf der Festplatte (erfordert parsergen --cache). Nach dem Parsen einer Datei wird ein binaerer
+/// Schnappschuss des Ergebnisses (zusi_parser/cache.hpp) abgelegt, der beim naechsten Mal eingeblendet und ohne
+/// XML-Verarbeitung eingelesen wird. Schluessel ist der absolute Pfad der Datei; ein Schnappschuss gilt, solange
+/// Groesse und Aenderungszeit der Datei passen. Aendert sich nur die Aenderungszeit, entscheidet ein Hash ueber den
+/// Inhalt. Uebersteigt der Cache die Maximalgroesse, werden die am laengsten nicht benutzten Schnappschuesse entfernt.
+/// Fehler beim Lesen oder Schreiben des Caches fuehren nur dazu, dass die Datei geparst wird. Thread-sicher; mehrere
+/// Prozesse duerfen dasselbe Verzeichnis verwenden.
+class ParseCache {
+ public:
+  struct Statistik {
+    size_t treffer { 0 };  // aus einem Schnappschuss gelesen
+    size_t verfehlt { 0 };  // XML geparst
+    size_t geschrieben { 0 };  // Schnappschuesse angelegt
+    size_t verdraengt { 0 };  // wegen der Maximalgroesse entfernt
+  };
+
+  /// \param verzeichnis Verzeichnis fuer die Schnappschuesse; wird bei Bedarf angelegt.
+  /// \param maxGroesse Maximale Gesamtgroesse der Schnappschuesse in Bytes.
+  explicit ParseCache(std::string verzeichnis, uint64_t maxGroesse = uint64_t(1) << 30)
+      : m_verzeichnis(std::move(verzeichnis)), m_maxGroesse(maxGroesse) {
+    fs::create_directories(m_verzeichnis);
+    m_belegt = begrenze(std::numeric_limits<uint64_t>::max());
+  }
+
+  ParseCache(const ParseCache&) = delete;
+  ParseCache& operator=(const ParseCache&) = delete;
+
+  /// Wie zusixml::parseFile, aber aus dem Schnappschuss, falls vorhanden und gueltig.
+  root_ptr<Zusi> parseFile(std::string_view dateiname) {
+    std::string quelle;
+    std::string pfad;
+    uint64_t groesse = 0;
+    int64_t mtime = 0;
+    std::shared_ptr<FileReader> quelldatei;  // sobald der Inhalt gebraucht wird
+    try {
+      quelle = fs::absolute(fs::path(std::string(dateiname))).lexically_normal().string();
+      pfad = schnappschussPfad(quelle);
+      if (quellInfo(quelle, groesse, mtime)) {
+        FileReader schnappschuss(pfad);
+        cache::header kopf;
+        if (passt(schnappschuss, quelle, groesse, kopf)) {
+          bool gueltig = kopf.source_mtime == mtime;
+          if (!gueltig) {
+            // Gleicher Inhalt mit neuer Aenderungszeit, z.B. nach erneutem Auspacken
+            quelldatei = std::make_shared<FileReader>(dateiname);
+            gueltig = cache::content_hash(quelldatei->data(), quelldatei->size()) == kopf.source_hash;
+            if (gueltig) {
+              aktualisiereMtime(pfad, mtime);
+            }
+          }
+          if (gueltig) {
+            auto result = lese(schnappschuss, kopf);
+            m_treffer++;
+            benutzt(pfad);
+            return result;
+          }
+        }
+      }
+    } catch (const std::exception&) {
+      // kein oder unbrauchbarer Schnappschuss
+    }
+
+    m_verfehlt++;
+    try {
+      if (!quelldatei) {
+        quelldatei = std::make_shared<FileReader>(dateiname);
+      }
+      auto result = detail::parseDaten(dateiname, quelldatei->data(), quelldatei->data() + quelldatei->size(), quelldatei);
+      if (result && !pfad.empty()) {
+        schreibe(quelle, pfad, mtime, *quelldatei, *result);
+      }
+      return result;
+    } catch (const std::exception& e) {
+      io::cerr << "Error reading " << dateiname << ": " << e.what() << "\n";
+    }
+    return nullptr;
+  }
+
+  /// Entfernt den Schnappschuss einer Datei.
+  void invalidate(std::string_view dateiname) {
+    fehlercode ec;
+    const std::string quelle = fs::absolute(fs::path(std::string(dateiname))).lexically_normal().string();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const uint64_t size = fs::file_size(schnappschussPfad(quelle), ec);
+    if (!ec && fs::remove(schnappschussPfad(quelle), ec)) {
+      m_belegt -= std::min(m_belegt, size);
+    }
+  }
+
+  /// Entfernt alle Schnappschuesse.
+  void clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_belegt = begrenze(0);
+  }
+
+  Statistik stats() const {
+    Statistik result;
+    result.treffer = m_treffer;
+    result.verfehlt = m_verfehlt;
+    result.geschrieben = m_geschrieben;
+    result.verdraengt = m_verdraengt;
+    return result;
+  }
+
+  /// Gesamtgroesse der Schnappschuesse in Bytes.
+  uint64_t size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_belegt;
+  }
+
+ private:
+#ifdef ZUSI_PARSER_USE_BOOST_FILESYSTEM
+  using fehlercode = boost::system::error_code;
+#else
+  using fehlercode = std::error_code;
+#endif
+  static constexpr const char* endung = ".zcache";
+
+  std::string schnappschussPfad(const std::string& quelle) const {
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(cache::content_hash(quelle.data(), quelle.size())));
+    return (fs::path(m_verzeichnis) / (std::string(name) + endung)).string();
+  }
+
+  /// Groesse und Aenderungszeit (ns seit 1970) der Quelldatei.
+  static bool quellInfo(const std::string& quelle, uint64_t& groesse, int64_t& mtime) {
+#ifdef _WIN32
+    struct _stat64 sb;
+    if (_wstat64(boost::nowide::widen(quelle).c_str(), &sb) != 0) {
+      return false;
+    }
+    mtime = static_cast<int64_t>(sb.st_mtime) * 1000000000;
+#else
+    struct stat sb;
+    if (stat(quelle.c_str(), &sb) != 0) {
+      return false;
+    }
+#  ifdef __APPLE__
+    mtime = static_cast<int64_t>(sb.st_mtimespec.tv_sec) * 1000000000 + sb.st_mtimespec.tv_nsec;
+#  else
+    mtime = static_cast<int64_t>(sb.st_mtim.tv_sec) * 1000000000 + sb.st_mtim.tv_nsec;
+#  endif
+#endif
+    groesse = static_cast<uint64_t>(sb.st_size);
+    return true;
+  }
+
+  /// Prueft Kopf und Pfad eines Schnappschusses gegen die Quelldatei.
+  static bool passt(FileReader& schnappschuss, const std::string& quelle, uint64_t groesse, cache::header& kopf) {
+    if (schnappschuss.size() < sizeof(kopf)) {
+      return false;
+    }
+    std::memcpy(&kopf, schnappschuss.data(), sizeof(kopf));
+    return std::memcmp(kopf.magic, cache::magic, sizeof(cache::magic)) == 0 && kopf.version == cache::version
+        && kopf.schema == cache_schema && kopf.source_size == groesse && kopf.path_size == quelle.size()
+        && kopf.payload_size == schnappschuss.size() - sizeof(kopf) - kopf.path_size
+        && std::memcmp(schnappschuss.data() + sizeof(kopf), quelle.data(), quelle.size()) == 0;
+  }
+
+  static root_ptr<Zusi> lese(FileReader& schnappschuss, const cache::header& kopf) {
+    const char* nutzdaten = schnappschuss.data() + sizeof(kopf) + kopf.path_size;
+    if (cache::content_hash(nutzdaten, kopf.payload_size) != kopf.payload_hash) {
+      throw std::runtime_error("cache: damaged snapshot");
+    }
+    cache::reader reader(nutzdaten, nutzdaten + kopf.payload_size);
+#if defined(ZUSIXML_LAZY)
+    // Die Kindelemente liegen im Schnappschuss bereits geparst vor; das Dokument braucht keine Eingabedaten.
+    auto result = root_ptr<Zusi>::create(false);
+#else
+    root_ptr<Zusi> result(new Zusi());
+#endif
+    read_element_Zusi(reader, result.get());
+    if (!reader.at_end()) {
+      throw std::runtime_error("cache: damaged snapshot");
+    }
+    return result;
+  }
+
+  static void aktualisiereMtime(const std::string& pfad, int64_t mtime) {
+    io::fstream datei(pfad, std::ios::in | std::ios::out | std::ios::binary);
+    datei.seekp(offsetof(cache::header, source_mtime));
+    datei.write(reinterpret_cast<const char*>(&mtime), sizeof(mtime));
+  }
+
+  /// Vermerkt die Benutzung in der Aenderungszeit des Schnappschusses, nach der begrenze() auswaehlt.
+  static void benutzt(const std::string& pfad) {
+    fehlercode ec;
+#ifdef ZUSI_PARSER_USE_BOOST_FILESYSTEM
+    fs::last_write_time(pfad, std::time(nullptr), ec);
+#else
+    fs::last_write_time(pfad, fs::file_time_type::clock::now(), ec);
+#endif
+  }
+
+  /// Schreibt den Schnappschuss in eine temporaere Datei und benennt sie dann um, sodass Leser stets
+  /// vollstaendige Schnappschuesse sehen. Fehler werden ignoriert.
+  void schreibe(const std::string& quelle, const std::string& pfad, int64_t mtime, FileReader& quelldatei, const Zusi& result) {
+    cache::writer writer;
     try {
-      return zusixml::parse_root<Zusi>(reader.data());
-    } catch (const zusixml::parse_error& e) {
-      io::cerr << "Error parsing " << dateiname << ": " << e.what() << " at char " << (e.where() - reader.data()) << "\n";
+      write_element_Zusi(writer, &result);
+    } catch (const std::exception&) {
+      return;  // z.B. ungueltiges Kindelement, das mit --lazy erst jetzt geparst wird
+    }
+    cache::header kopf {};
+    std::memcpy(kopf.magic, cache::magic, sizeof(cache::magic));
+    kopf.version = cache::version;
+    kopf.path_size = static_cast<uint32_t>(quelle.size());
+    kopf.schema = cache_schema;
+    kopf.source_size = quelldatei.size();
+    kopf.source_mtime = mtime;
+    kopf.source_hash = cache::content_hash(quelldatei.data(), quelldatei.size());
+    kopf.payload_size = writer.data().size();
+    kopf.payload_hash = cache::content_hash(writer.data().data(), writer.data().size());
+    const uint64_t gesamt = sizeof(kopf) + quelle.size() + writer.data().size();
+    if (gesamt > m_maxGroesse) {
+      return;
+    }
+
+    const std::string temporaer = pfad + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()))
+        + "." + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".tmp";
+    {
+      io::ofstream datei(temporaer, std::ios::binary | std::ios::trunc);
+      datei.write(reinterpret_cast<const char*>(&kopf), sizeof(kopf));
+      datei.write(quelle.data(), quelle.size());
+      datei.write(writer.data().data(), writer.data().size());
+      datei.close();
+      if (!datei) {
+        fehlercode ec;
+        fs::remove(temporaer, ec);
+        return;
+      }
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    fehlercode ec;
+    const uint64_t ersetzt = fs::exists(pfad, ec) ? fs::file_size(pfad, ec) : 0;
+    fs::rename(temporaer, pfad, ec);
+    if (ec) {
+      fs::remove(temporaer, ec);
+      return;
+    }
+    m_geschrieben++;
+    m_belegt = m_belegt - std::min(m_belegt, ersetzt) + gesamt;
+    if (m_belegt > m_maxGroesse) {
+      // Etwas Luft, damit nicht jeder weitere Schnappschuss das Verzeichnis erneut durchsucht.
+      m_belegt = begrenze(m_maxGroesse / 4 * 3);
     }
+  }
+
+  /// Entfernt die am laengsten nicht benutzten Schnappschuesse, bis hoechstens @p ziel Bytes belegt sind,
+  /// und gibt die verbleibende Gesamtgroesse zurueck.
+  uint64_t begrenze(uint64_t ziel) {
+    struct Eintrag {
+      decltype(fs::last_write_time(fs::path())) zeit;
+      uint64_t groesse;
+      fs::path pfad;
+    };
+    std::vector<Eintrag> eintraege;
+    uint64_t summe = 0;
+    for (const auto& eintrag : fs::directory_iterator(m_verzeichnis)) {
+      if (eintrag.path().extension() != endung) {
+        continue;
+      }
+      try {
+        eintraege.push_back({ fs::last_write_time(eintrag.path()), fs::file_size(eintrag.path()), eintrag.path() });
+        summe += eintraege.back().groesse;
+      } catch (const std::exception&) {
+        // inzwischen von einem anderen Prozess entfernt
+      }
+    }
+    if (summe <= ziel) {
+      return summe;
+    }
+    std::sort(eintraege.begin(), eintraege.end(), [](const Eintrag& lhs, const Eintrag& rhs) { return lhs.zeit < rhs.zeit; });
+    for (const auto& eintrag : eintraege) {
+      if (summe <= ziel) {
+        break;
+      }
+      fehlercode ec;
+      if (fs::remove(eintrag.pfad, ec)) {
+        m_verdraengt++;
+      }
+      summe -= eintrag.groesse;
+    }
+    return summe;
+  }
+
+  const std::string m_verzeichnis;
+  const uint64_t m_maxGroesse;
+  mutable std::mutex m_mutex;
+  uint64_t m_belegt { 0 };  // geschuetzt durch m_mutex
+  std::atomic<size_t> m_treffer { 0 };
+  std::atomic<size_t> m_verfehlt { 0 };
+  std::atomic<size_t> m_geschrieben { 0 };
+  std::atomic<size_t> m_verdraengt { 0 };
+};
+
+inline std::shared_ptr<ParseCache>& parseCacheSlot() {
+  static std::shared_ptr<ParseCache> slot;
+  return slot;
+}
+
+/// Laesst parseFile den Parse-Cache @p cache verwenden (nullptr: keinen). Betrifft alle Threads.
+static inline void setParseCache(std::shared_ptr<ParseCache> cache) {
+  std::atomic_store(&parseCacheSlot(), std::move(cache));
+}
+
+static inline std::shared_ptr<ParseCache> getParseCache() {
+  return std::atomic_load(&parseCacheSlot());
+}
+#endif
+
+/// Parst eine Zusi-Datei. Fehler werden ausgegeben; das Ergebnis ist dann nullptr.
+/// Ist ein Parse-Cache gesetzt (setParseCache), wird er verwendet.
+static inline zusixml::root_ptr<Zusi> parseFile(std::string_view dateiname) {
+#if defined(ZUSIXML_CACHE)
+  if (const auto cache = getParseCache()) {
+    return cache->parseFile(dateiname);
+  }
+#endif
+  try {
+    auto reader = std::make_shared<FileReader>(dateiname);
+    const char* daten = reader->data();
+    return detail::parseDaten(dateiname, daten, daten + reader->size(), std::move(reader));
   } catch (const std::exception& e) {
     io::cerr << "Error reading " << dateiname << ": " << e.what() << "\n";
   }
   return nullptr;
 }
 
-static inline std::unique_ptr<Zusi> tryParseFile(std::string_view dateiname) {
+static inline zusixml::root_ptr<Zusi> tryParseFile(std::string_view dateiname) {
   try {
     return parseFile(dateiname);
   } catch (const std::runtime_error& e) {
@@ -209,6 +651,359 @@ static inline std::unique_ptr<Zusi> tryParseFile(std::string_view dateiname) {
   }
 }
 
+/// Parst eine Zusi-Datei, deren Inhalt stueckweise eintrifft (z.B. aus einer Pipe, einem Dekompressor oder einem Socket).
+/// Der Parser laeuft in einem eigenen Thread, waehrend die Daten eintreffen. Erreicht er das Ende der bisher
+/// uebergebenen Daten, wartet er -- auch mitten in einem Tag oder Attributwert -- auf den naechsten Aufruf von feed().
+/// Alle Stuecke werden hintereinander in einen einmalig reservierten Adressbereich geschrieben, sodass die Daten
+/// beim Anwachsen weder umkopiert noch verschoben werden.
+/// Nur verfuegbar, wenn ZUSIXML_INCREMENTAL vor dem ersten Include der Parser-Header definiert ist.
+#if defined(ZUSIXML_INCREMENTAL)
+class StreamParser : private zusixml::refill_source {
+ public:
+  static constexpr size_t defaultMaxSize = sizeof(void*) >= 8 ? (size_t(1) << 36) : (size_t(1) << 28);
+
+  /// \param maxSize Maximale Gesamtgroesse der Daten; so viel Adressraum wird reserviert.
+  explicit StreamParser(size_t maxSize = defaultMaxSize)
+      : m_capacity(maxSize) {
+#ifdef _WIN32
+    m_buffer = static_cast<zusixml::Ch*>(VirtualAlloc(nullptr, m_capacity, MEM_RESERVE, PAGE_NOACCESS));
+    if (m_buffer == nullptr) {
+      throw std::runtime_error("VirtualAlloc() failed");
+    }
+#else
+    void* reserved = mmap(nullptr, m_capacity, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (reserved == MAP_FAILED) {
+      throw std::runtime_error(std::string("mmap() failed: ") + std::strerror(errno));
+    }
+    m_buffer = static_cast<zusixml::Ch*>(reserved);
+#endif
+    m_thread = std::thread([this] {
+      zusixml::set_refill_source(this);
+      try {
+        // Weitere Daten fordert der Parser ueber refill() an.
+        m_result = zusixml::parse_root<Zusi>(m_buffer, m_buffer);
+      } catch (...) {
+        m_error = std::current_exception();
+      }
+      zusixml::set_refill_source(nullptr);
+    });
+  }
+
+  ~StreamParser() {
+    finishParsing();
+    if (m_buffer == nullptr) {
+      return;
+    }
+#ifdef _WIN32
+    VirtualFree(m_buffer, 0, MEM_RELEASE);
+#else
+    munmap(m_buffer, m_capacity);
+#endif
+  }
+
+  StreamParser(const StreamParser&) = delete;
+  StreamParser& operator=(const StreamParser&) = delete;
+
+  /// Haengt ein Stueck Daten an. Darf nur von einem Thread gleichzeitig aufgerufen werden.
+  void feed(const zusixml::Ch* data, size_t size) {
+    std::memcpy(prepare(size), data, size);
+    commit(size);
+  }
+
+  /// Stellt Platz fuer bis zu @p size weitere Zeichen direkt im Puffer bereit, z.B. als Ausgabe eines Dekompressors.
+  /// Der Parser sieht die Zeichen erst nach commit(). Wie feed() nur von einem Thread gleichzeitig aufzurufen.
+  zusixml::Ch* prepare(size_t size) {
+    if (size > m_capacity - m_written) {
+      throw std::length_error("StreamParser: maximum size exceeded");
+    }
+    if (m_written + size > m_committed) {
+      constexpr size_t commitStep = size_t(1) << 20;
+      const size_t newCommitted = std::min(m_capacity, (m_written + size + commitStep - 1) / commitStep * commitStep);
+#ifdef _WIN32
+      if (VirtualAlloc(m_buffer + m_committed, newCommitted - m_committed, MEM_COMMIT, PAGE_READWRITE) == nullptr) {
+        throw std::runtime_error("VirtualAlloc() failed");
+      }
+#else
+      if (mprotect(m_buffer + m_committed, newCommitted - m_committed, PROT_READ | PROT_WRITE) == -1) {
+        throw std::runtime_error(std::string("mprotect() failed: ") + std::strerror(errno));
+      }
+#endif
+      m_committed = newCommitted;
+    }
+    return m_buffer + m_written;
+  }
+
+  /// Gibt die ersten @p size der mit prepare() bereitgestellten Zeichen an den Parser weiter.
+  void commit(size_t size) {
+    assert(m_written + size <= m_committed);
+    // Der Parser liest nur Daten vor m_size, daher kann ohne Sperre geschrieben werden.
+    m_written += size;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_size = m_written;
+    }
+    m_condition.notify_one();
+  }
+
+  /// Markiert das Ende der Daten, wartet auf den Parser und gibt das Ergebnis zurueck.
+  /// Wirft zusixml::parse_error bei ungueltigen Daten; where() zeigt dann in data().
+  root_ptr<Zusi> finish() {
+    finishParsing();
+    if (m_error) {
+      std::rethrow_exception(std::exchange(m_error, nullptr));
+    }
+#if defined(ZUSIXML_STRING_VIEW) || defined(ZUSIXML_LAZY)
+    // Die Attributwerte bzw. die noch nicht geparsten Kindelemente verweisen in den Puffer,
+    // daher geht er in den Besitz des Dokuments ueber.
+    const size_t capacity = m_capacity;
+    m_result.hold_input(std::shared_ptr<const void>(std::exchange(m_buffer, nullptr), [capacity](const void* buffer) {
+#  ifdef _WIN32
+      (void)capacity;
+      VirtualFree(const_cast<void*>(buffer), 0, MEM_RELEASE);
+#  else
+      munmap(const_cast<void*>(buffer), capacity);
+#  endif
+    }));
+#endif
+    return std::move(m_result);
+  }
+
+  /// Die bisher uebergebenen Daten. Mit --string-view oder --lazy nach erfolgreichem finish() nicht mehr verfuegbar.
+  const zusixml::Ch* data() const {
+    return m_buffer;
+  }
+
+  size_t size() const {
+    return m_written;
+  }
+
+ private:
+  const zusixml::Ch* refill(const zusixml::Ch* /*end*/, const zusixml::Ch* wanted) override {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [&] { return wanted < m_buffer + m_size || m_finished; });
+    return m_buffer + m_size;
+  }
+
+  void finishParsing() {
+    if (!m_thread.joinable()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_finished = true;
+    }
+    m_condition.notify_one();
+    m_thread.join();
+  }
+
+  zusixml::Ch* m_buffer { nullptr };
+  const size_t m_capacity;
+  size_t m_committed { 0 };  // nur vom einspeisenden Thread verwendet
+  size_t m_written { 0 };  // nur vom einspeisenden Thread verwendet
+
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  size_t m_size { 0 };  // geschuetzt durch m_mutex
+  bool m_finished { false };  // geschuetzt durch m_mutex
+
+  std::thread m_thread;
+  root_ptr<Zusi> m_result;
+  std::exception_ptr m_error;
+};
+#endif
+
+/// Laedt viele Dateien parallel in FileReader-Objekte und uebergibt jede, sobald sie geladen ist.
+/// Das Oeffnen und Einblenden erledigt ein Pool von Threads, sodass bei vielen Dateien (z.B. einem ganzen
+/// Datenverzeichnis) stets mehrere Anfragen gleichzeitig beim Betriebssystem liegen, statt dass jede auf die
+/// vorige wartet. Die Threads beginnen schon im Konstruktor. Dateien, die noch niemand abgeholt hat, bleiben geladen;
+/// ist die Hoechstzahl solcher Dateien erreicht, warten die Threads, bis wieder eine abgeholt wird.
+class FileBatchLoader {
+ public:
+  /// \param dateinamen Die zu ladenden Dateien.
+  /// \param threads Anzahl der ladenden Threads (0: abhaengig von der Anzahl der Prozessoren).
+  /// \param policy Hinweise fuer das Laden jeder Datei.
+  /// \param maxGeladen Hoechstzahl der Dateien, die gerade geladen werden oder geladen auf next() warten
+  ///   (0: doppelt so viele wie Threads).
+  explicit FileBatchLoader(std::vector<std::string> dateinamen, size_t threads = 0, const FileLoadPolicy& policy = {},
+      size_t maxGeladen = 0)
+      : m_dateinamen(std::move(dateinamen)), m_policy(policy) {
+    if (threads == 0) {
+      // Die Threads warten ueberwiegend auf das Dateisystem, daher mehr als Prozessoren.
+      threads = std::max<size_t>(4, 2 * std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, m_dateinamen.size());
+    m_maxGeladen = maxGeladen > 0 ? maxGeladen : std::max<size_t>(1, 2 * threads);
+    m_threads.reserve(threads);
+    for (size_t i = 0; i < threads; i++) {
+      m_threads.emplace_back([this] { load(); });
+    }
+  }
+
+  ~FileBatchLoader() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_next = m_dateinamen.size();  // keine weiteren Dateien beginnen
+    }
+    m_platzFrei.notify_all();
+    for (auto& thread : m_threads) {
+      thread.join();
+    }
+  }
+
+  FileBatchLoader(const FileBatchLoader&) = delete;
+  FileBatchLoader& operator=(const FileBatchLoader&) = delete;
+
+  /// Wartet auf die naechste geladene Datei, in der Reihenfolge der Fertigstellung.
+  /// Liefert false, wenn alle Dateien abgeholt wurden. Konnte die Datei nicht geladen werden, wird
+  /// der Fehler des FileReader geworfen; weitere Aufrufe liefern die uebrigen Dateien.
+  /// \param index Erhaelt den Index der Datei in der Liste aus dem Konstruktor.
+  bool next(size_t& index, std::unique_ptr<FileReader>& reader) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_delivered == m_dateinamen.size()) {
+      return false;
+    }
+    m_condition.wait(lock, [this] { return !m_done.empty(); });
+    Entry entry = std::move(m_done.front());
+    m_done.pop_front();
+    m_delivered++;
+    m_geladen--;
+    lock.unlock();
+    m_platzFrei.notify_one();
+
+    index = entry.index;
+    if (entry.error) {
+      std::rethrow_exception(entry.error);
+    }
+    reader = std::move(entry.reader);
+    return true;
+  }
+
+  /// Ruft consumer(index, FileReader&) fuer jede Datei auf, sobald sie geladen ist, und zwar im aufrufenden Thread.
+  /// Fehler beim Laden werden wie bei parseFile ausgegeben und die Datei uebersprungen.
+  template <typename Consumer>
+  void forEach(Consumer&& consumer) {
+    while (true) {
+      size_t index = 0;
+      std::unique_ptr<FileReader> reader;
+      try {
+        if (!next(index, reader)) {
+          return;
+        }
+      } catch (const std::exception& e) {
+        io::cerr << "Error reading " << m_dateinamen[index] << ": " << e.what() << "\n";
+        continue;
+      }
+      consumer(index, *reader);
+    }
+  }
+
+  /// Die Dateinamen aus dem Konstruktor.
+  const std::vector<std::string>& dateinamen() const {
+    return m_dateinamen;
+  }
+
+ private:
+  struct Entry {
+    size_t index;
+    std::unique_ptr<FileReader> reader;
+    std::exception_ptr error;
+  };
+
+  void load() {
+    while (true) {
+      size_t index = 0;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_platzFrei.wait(lock, [this] { return m_geladen < m_maxGeladen || m_next == m_dateinamen.size(); });
+        if (m_next == m_dateinamen.size()) {
+          return;
+        }
+        index = m_next++;
+        m_geladen++;
+      }
+      Entry entry { index, nullptr, nullptr };
+      try {
+        entry.reader = std::make_unique<FileReader>(m_dateinamen[index], m_policy);
+      } catch (...) {
+        entry.error = std::current_exception();
+      }
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_done.push_back(std::move(entry));
+      }
+      m_condition.notify_one();
+    }
+  }
+
+  const std::vector<std::string> m_dateinamen;
+  const FileLoadPolicy m_policy;
+  size_t m_maxGeladen { 0 };
+
+  std::mutex m_mutex;
+  std::condition_variable m_condition;  // eine Datei wurde fertig geladen
+  std::condition_variable m_platzFrei;  // eine Datei wurde abgeholt oder das Laden beendet
+  size_t m_next { 0 };  // Index der naechsten zu ladenden Datei, geschuetzt durch m_mutex
+  size_t m_geladen { 0 };  // begonnene, noch nicht abgeholte Dateien, geschuetzt durch m_mutex
+  std::deque<Entry> m_done;  // geschuetzt durch m_mutex
+  size_t m_delivered { 0 };  // geschuetzt durch m_mutex
+
+  std::vector<std::thread> m_threads;
+};
+
+/// Liest die Dateien aus einer Paketdatei (zusi_parser/pack.hpp, erstellt mit zusipack). Das Paket wird einmal
+/// geoeffnet und eingeblendet; die einzelnen Dateien sind Ausschnitte daraus und wie bei FileReader nullterminiert.
+class PackReader {
+ public:
+  explicit PackReader(std::string_view dateiname, const FileLoadPolicy& policy = {})
+      : m_file(dateiname, policy), m_directory(readDirectory(dateiname, m_file)) {}
+
+  PackReader(const PackReader&) = delete;
+  PackReader& operator=(const PackReader&) = delete;
+
+  /// Anzahl der Dateien im Paket.
+  size_t size() const {
+    return m_directory.size();
+  }
+
+  /// Die Datei mit dem Index @p i, nach Zusi-Pfad sortiert.
+  pack::packed_file operator[](size_t i) const {
+    return m_directory[i];
+  }
+
+  /// Sucht eine Datei nach ihrem Zusi-Pfad, ohne Beachtung der Gross-/Kleinschreibung.
+  std::optional<pack::packed_file> find(std::string_view zusiPfad) const {
+    return m_directory.find(zusiPfad);
+  }
+
+ private:
+  static pack::directory readDirectory(std::string_view dateiname, FileReader& file) {
+    try {
+      return pack::directory(file.data(), file.size());
+    } catch (const std::runtime_error& e) {
+      throw std::runtime_error(std::string(dateiname) + ": " + e.what());
+    }
+  }
+
+  FileReader m_file;
+  pack::directory m_directory;
+};
+
+/// Wie parseFile, aber fuer eine Datei aus einem Paket.
+static inline zusixml::root_ptr<Zusi> parseFile(const std::shared_ptr<const PackReader>& pack, std::string_view zusiPfad) {
+  try {
+    // find() prueft den Eintrag und wirft bei einem beschaedigten Paket.
+    const auto datei = pack->find(zusiPfad);
+    if (!datei) {
+      io::cerr << "Error reading " << zusiPfad << ": not in pack\n";
+      return nullptr;
+    }
+    return detail::parseDaten(zusiPfad, datei->data(), datei->data() + datei->size(), pack);
+  } catch (const std::exception& e) {
+    io::cerr << "Error reading " << zusiPfad << ": " << e.what() << "\n";
+  }
+  return nullptr;
+}
+
 static inline std::string bestimmeZusiDatenpfad() {
   std::string result;
 #ifdef _WIN32
@@ -273,6 +1068,243 @@ constexpr char osSep = '\\';
 constexpr char osSep = '/';
 #endif
 
+/// Verzeichnis aller Dateien und Ordner in den beiden Zusi-Datenverzeichnissen im Speicher, damit ZusiPfad::alsOsPfad
+/// ohne Zugriff auf das Dateisystem auskommt (siehe setZusiPfadIndex). Zusi-Pfade werden wie unter Windows ohne
+/// Beachtung der Gross-/Kleinschreibung (nur ASCII) aufgeloest; das Ergebnis enthaelt die Schreibweise im Dateisystem.
+/// Die Verzeichnisse werden beim Erzeugen und bei refresh() von mehreren Threads durchsucht; symbolische Links auf
+/// Verzeichnisse werden aufgenommen, aber nicht durchsucht. Spaetere Aenderungen im Dateisystem sieht der Index erst nach
+/// refresh(). Thread-sicher, auch waehrend refresh().
+class ZusiPfadIndex {
+ public:
+  /// Indexiert getZusiDatenpfad() und getZusiDatenpfadOffiziell().
+  /// \param threads Anzahl der suchenden Threads (0: abhaengig von der Anzahl der Prozessoren).
+  explicit ZusiPfadIndex(size_t threads = 0) : ZusiPfadIndex(getZusiDatenpfad(), getZusiDatenpfadOffiziell(), threads) {}
+
+  /// Indexiert die angegebenen Datenverzeichnisse (mit abschliessendem Trennzeichen wie bei getZusiDatenpfad()).
+  /// Ein leerer Pfad bedeutet: kein solches Verzeichnis.
+  ZusiPfadIndex(std::string datenpfad, std::string datenpfadOffiziell, size_t threads = 0)
+      : m_datenpfad(std::move(datenpfad)), m_datenpfadOffiziell(std::move(datenpfadOffiziell)), m_threads(threads) {
+    refresh();
+  }
+
+  ZusiPfadIndex(const ZusiPfadIndex&) = delete;
+  ZusiPfadIndex& operator=(const ZusiPfadIndex&) = delete;
+
+  /// Durchsucht die Datenverzeichnisse erneut. Bis dahin beantwortet der bisherige Stand die Anfragen.
+  void refresh() {
+    std::atomic_store(&m_stand, std::shared_ptr<const Stand>(erstelle(m_datenpfad, m_datenpfadOffiziell, m_threads)));
+  }
+
+  /// Liefert den Pfad im Dateisystem, wenn die Datei oder der Ordner @p zusiPfad im eigenen oder, falls nicht,
+  /// im offiziellen Datenverzeichnis existiert. Ein fuehrender Backslash wird ignoriert, ein abschliessender
+  /// (Ordner) bleibt erhalten.
+  std::optional<std::string> find(std::string_view zusiPfad) const {
+    if (!zusiPfad.empty() && zusiPfad.front() == zusiSep) {
+      zusiPfad.remove_prefix(1);
+    }
+    const bool ordner = !zusiPfad.empty() && zusiPfad.back() == zusiSep;
+    if (ordner) {
+      zusiPfad.remove_suffix(1);
+    }
+    const auto stand = std::atomic_load(&m_stand);
+    for (const Verzeichnis* verzeichnis : { &stand->eigenes, &stand->offiziell }) {
+      if (!verzeichnis->vorhanden) {
+        continue;
+      }
+      if (zusiPfad.empty()) {
+        return verzeichnis->datenpfad;
+      }
+      const auto it = verzeichnis->eintraege.find(zusiPfad);
+      if (it != verzeichnis->eintraege.end()) {
+        std::string result = verzeichnis->datenpfad;
+        alsOs(*it, result);
+        if (ordner) {
+          result += osSep;
+        }
+        return result;
+      }
+    }
+    return std::nullopt;
+  }
+
+  /// Wie ZusiPfad::alsOsPfad: der Pfad im eigenen Datenverzeichnis, wenn er dort existiert, sonst im offiziellen
+  /// (unabhaengig davon, ob er existiert). Ein fuehrender Backslash wird ignoriert.
+  std::string alsOsPfad(std::string_view zusiPfad) const {
+    if (!zusiPfad.empty() && zusiPfad.front() == zusiSep) {
+      zusiPfad.remove_prefix(1);
+    }
+    if (auto result = find(zusiPfad)) {
+      return std::move(*result);
+    }
+    std::string result = m_datenpfadOffiziell;
+    alsOs(zusiPfad, result);
+    return result;
+  }
+
+  /// Anzahl der Dateien und Ordner in beiden Datenverzeichnissen.
+  size_t size() const {
+    const auto stand = std::atomic_load(&m_stand);
+    return stand->eigenes.eintraege.size() + stand->offiziell.eintraege.size();
+  }
+
+ private:
+#ifdef ZUSI_PARSER_USE_BOOST_FILESYSTEM
+  using fehlercode = boost::system::error_code;
+#else
+  using fehlercode = std::error_code;
+#endif
+
+  /// Hash und Vergleich ohne Beachtung der Gross-/Kleinschreibung (ASCII), passend zu pack::compare_paths.
+  struct PfadHash {
+    size_t operator()(std::string_view pfad) const {
+      uint64_t result = 0xcbf29ce484222325ULL;  // FNV-1a
+      for (const char c : pfad) {
+        result ^= static_cast<unsigned char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+        result *= 0x100000001b3ULL;
+      }
+      return static_cast<size_t>(result);
+    }
+  };
+  struct PfadGleich {
+    bool operator()(std::string_view lhs, std::string_view rhs) const {
+      return lhs.size() == rhs.size() && pack::compare_paths(lhs, rhs) == 0;
+    }
+  };
+
+  struct Verzeichnis {
+    std::string datenpfad;
+    bool vorhanden { false };
+    std::string namen;  // die Zusi-Pfade aller Eintraege hintereinander; wird nach dem Fuellen nicht mehr veraendert
+    std::unordered_set<std::string_view, PfadHash, PfadGleich> eintraege;  // verweisen in namen
+  };
+  struct Stand {
+    Verzeichnis eigenes;
+    Verzeichnis offiziell;
+  };
+
+  static void alsOs(std::string_view zusiPfad, std::string& ziel) {
+    if constexpr (osSep != zusiSep) {
+      std::replace_copy(zusiPfad.begin(), zusiPfad.end(), std::back_inserter(ziel), zusiSep, osSep);
+    } else {
+      ziel += zusiPfad;
+    }
+  }
+
+  /// Durchsucht beide Verzeichnisse mit einer gemeinsamen Warteschlange von Ordnern, sodass auch ein einzelner
+  /// grosser Ordner (z.B. Routes) auf alle Threads verteilt wird.
+  static std::unique_ptr<Stand> erstelle(const std::string& datenpfad, const std::string& datenpfadOffiziell, size_t threads) {
+    auto stand = std::make_unique<Stand>();
+    Verzeichnis* const verzeichnisse[] = { &stand->eigenes, &stand->offiziell };
+    stand->eigenes.datenpfad = datenpfad;
+    stand->offiziell.datenpfad = datenpfadOffiziell;
+
+    struct Auftrag {
+      size_t verzeichnis;
+      std::string ordner;  // Zusi-Pfad mit abschliessendem Backslash, leer fuer das Datenverzeichnis selbst
+    };
+    std::mutex mutex;
+    std::condition_variable bedingung;
+    std::vector<Auftrag> auftraege;  // geschuetzt durch mutex
+    size_t inArbeit = 0;  // geschuetzt durch mutex
+    std::vector<std::string> gefunden[2];  // geschuetzt durch mutex
+
+    for (size_t i = 0; i < 2; i++) {
+      fehlercode ec;
+      verzeichnisse[i]->vorhanden = !verzeichnisse[i]->datenpfad.empty() && fs::is_directory(verzeichnisse[i]->datenpfad, ec);
+      if (verzeichnisse[i]->vorhanden) {
+        auftraege.push_back({ i, std::string() });
+      }
+    }
+
+    const auto arbeite = [&]() {
+      std::vector<std::string> lokal[2];
+      std::vector<Auftrag> neu;
+      std::unique_lock<std::mutex> lock(mutex);
+      while (true) {
+        bedingung.wait(lock, [&] { return !auftraege.empty() || inArbeit == 0; });
+        if (auftraege.empty()) {
+          break;  // alle Ordner durchsucht
+        }
+        const Auftrag auftrag = std::move(auftraege.back());
+        auftraege.pop_back();
+        inArbeit++;
+        lock.unlock();
+
+        std::string osOrdner = verzeichnisse[auftrag.verzeichnis]->datenpfad;
+        alsOs(auftrag.ordner, osOrdner);
+        fehlercode ec;
+        for (fs::directory_iterator it(osOrdner, ec), ende; !ec && it != ende; it.increment(ec)) {
+          std::string pfad = auftrag.ordner + it->path().filename().string();
+          fehlercode statusFehler;
+          if (fs::is_directory(it->symlink_status(statusFehler))) {
+            neu.push_back({ auftrag.verzeichnis, pfad + zusiSep });
+          }
+          lokal[auftrag.verzeichnis].push_back(std::move(pfad));
+        }
+
+        lock.lock();
+        inArbeit--;
+        std::move(neu.begin(), neu.end(), std::back_inserter(auftraege));
+        neu.clear();
+        bedingung.notify_all();
+      }
+      for (size_t i = 0; i < 2; i++) {
+        std::move(lokal[i].begin(), lokal[i].end(), std::back_inserter(gefunden[i]));
+      }
+    };
+
+    if (threads == 0) {
+      // Die Threads warten ueberwiegend auf das Dateisystem, daher mehr als Prozessoren.
+      threads = std::max<size_t>(4, 2 * std::thread::hardware_concurrency());
+    }
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (size_t i = 1; i < threads; i++) {
+      pool.emplace_back(arbeite);
+    }
+    arbeite();
+    for (auto& thread : pool) {
+      thread.join();
+    }
+
+    for (size_t i = 0; i < 2; i++) {
+      Verzeichnis& verzeichnis = *verzeichnisse[i];
+      size_t groesse = 0;
+      for (const auto& pfad : gefunden[i]) {
+        groesse += pfad.size();
+      }
+      verzeichnis.namen.reserve(groesse);  // keine Neuallokation beim Anhaengen, die Verweise bleiben gueltig
+      verzeichnis.eintraege.reserve(gefunden[i].size());
+      for (const auto& pfad : gefunden[i]) {
+        const size_t position = verzeichnis.namen.size();
+        verzeichnis.namen += pfad;
+        verzeichnis.eintraege.emplace(verzeichnis.namen.data() + position, pfad.size());
+      }
+    }
+    return stand;
+  }
+
+  const std::string m_datenpfad;
+  const std::string m_datenpfadOffiziell;
+  const size_t m_threads;
+  std::shared_ptr<const Stand> m_stand;  // nur mit std::atomic_load/std::atomic_store
+};
+
+inline std::shared_ptr<const ZusiPfadIndex>& zusiPfadIndexSlot() {
+  static std::shared_ptr<const ZusiPfadIndex> slot;
+  return slot;
+}
+
+/// Laesst ZusiPfad::alsOsPfad den Index @p index verwenden statt das Dateisystem zu fragen (nullptr: keinen).
+/// Betrifft alle Threads.
+static inline void setZusiPfadIndex(std::shared_ptr<const ZusiPfadIndex> index) {
+  std::atomic_store(&zusiPfadIndexSlot(), std::move(index));
+}
+
+static inline std::shared_ptr<const ZusiPfadIndex> getZusiPfadIndex() {
+  return std::atomic_load(&zusiPfadIndexSlot());
+}
+
 class ZusiPfad {
 public:
   ZusiPfad(const ZusiPfad&) = default;
@@ -386,6 +1418,10 @@ public:
   }
 
   std::string alsOsPfad() const {
+    if (const auto index = getZusiPfadIndex()) {
+      return index->alsOsPfad(m_pfad);
+    }
+
     // Pruefe, ob in eigenem Datenverzeichnis existiert.
     // Wenn nein -> gib Pfad in offiziellem Datenverzeichnis zurueck (unabhaengig davon, ob er existiert)
     std::string resultEigenes = getZusiDatenpfad();
@@ -6,6 +6,7 @@
 #include <array>
 #include <cassert>
 #include <cstring>
+#include <functional>
 #ifdef ZUSI_PARSER_USE_BOOST_FILESYSTEM
   #include <boost/filesystem.hpp>
   namespace fs = boost::filesystem;
@@ -33,6 +34,16 @@ namespace {
   size_t align(size_t size, size_t alignment) {
     return size + (alignment - (size % alignment)) % alignment;
   }
+
+  /** Prepends @p indent to every non-empty line of @p code. */
+  std::string IndentCode(const std::string& code, const std::string& indent) {
+    std::ostringstream out;
+    std::istringstream in(code);
+    for (std::string line; std::getline(in, line); ) {
+      out << (line.empty() ? "" : indent) << line << "\n";
+    }
+    return out.str();
+  }
 }  // namespace
 
 enum class AttributeType {
@@ -85,12 +96,133 @@ struct ElementTypeRaw : Thing {
   std::vector<ChildRaw> children;
 };
 
+/** How generated parse functions find the code for an element or attribute name. */
+enum class NameDispatch {
+  Chain,   // linear sequence of length checks and memcmp
+  Switch,  // switch on a perfect hash of length, first, middle and last character, then a single memcmp
+};
+
+/** Number of children of one parent element type and child name, over the parent elements of a corpus. */
+struct ChildProfile {
+  std::map<size_t, size_t> histogram;  // number of children -> number of parent elements with that many
+
+  size_t Parents() const {
+    size_t result = 0;
+    for (const auto& [count, parents] : histogram) {
+      result += parents;
+    }
+    return result;
+  }
+};
+
+/** Child count and attribute presence statistics of a corpus, written by --write-layout-profile and read by --layout-profile. */
+struct LayoutProfile {
+  size_t documents { 0 };
+  std::map<std::string, ChildProfile> children;  // "ParentTypeName::ChildName" -> statistics
+  std::map<std::string, ChildProfile> attributes;  // "ElementTypeName@AttributeName" -> elements without (0) and with (1) the attribute
+
+  /** Returns the fraction of elements in the profile that have the attribute @p name ("ElementTypeName@AttributeName"),
+   * or a negative value if the profile does not contain the attribute. */
+  double AttributePresence(const std::string& name) const {
+    const auto it = attributes.find(name);
+    if (it == attributes.end() || it->second.Parents() == 0) {
+      return -1;
+    }
+    const auto absentIt = it->second.histogram.find(0);
+    const size_t absent = (absentIt == it->second.histogram.end() ? 0 : absentIt->second);
+    return static_cast<double>(it->second.Parents() - absent) / it->second.Parents();
+  }
+
+  void Write(std::ostream& out) const {
+    out << "# parsergen layout profile: ParentTypeName::ChildName, then <number of children>:<number of parents>\n";
+    out << "# ElementTypeName@AttributeName, then 0:<number of elements without the attribute> 1:<number of elements with it>\n";
+    out << "documents " << documents << "\n";
+    for (const auto* profiles : { &children, &attributes }) {
+      for (const auto& [name, profile] : *profiles) {
+        out << name;
+        for (const auto& [count, parents] : profile.histogram) {
+          out << " " << count << ":" << parents;
+        }
+        out << "\n";
+      }
+    }
+  }
+
+  /** Reads a profile written by Write(). Returns false and prints an error message if the file is invalid. */
+  bool Read(const std::string& fileName) {
+    std::ifstream in(fileName);
+    if (!in) {
+      std::cerr << "Cannot open layout profile \"" << fileName << "\"\n";
+      return false;
+    }
+    size_t lineNumber = 0;
+    for (std::string line; std::getline(in, line); ) {
+      lineNumber++;
+      if (line.empty() || line[0] == '#') {
+        continue;
+      }
+      std::istringstream lineIn(line);
+      std::string name;
+      lineIn >> name;
+      if (name == "documents") {
+        lineIn >> documents;
+        continue;
+      }
+      const bool attribute = name.find('@') != std::string::npos;
+      auto& histogram = (attribute ? attributes : children)[name].histogram;
+      for (std::string entry; lineIn >> entry; ) {
+        const auto colon_pos = entry.find(':');
+        if ((!attribute && name.find("::") == std::string::npos) || colon_pos == std::string::npos) {
+          std::cerr << fileName << ":" << lineNumber << ": Invalid layout profile entry \"" << entry << "\"\n";
+          return false;
+        }
+        histogram[std::stoul(entry.substr(0, colon_pos))] += std::stoul(entry.substr(colon_pos + 1));
+      }
+    }
+    if (documents == 0) {
+      std::cerr << fileName << ": Layout profile does not contain any documents\n";
+      return false;
+    }
+    return true;
+  }
+};
+
+/** Element type name -> member names, given as ParentName::MemberName (see ParseMemberList). */
+using MemberList = std::unordered_map<std::string, std::unordered_set<std::string>>;
+
 struct Config {
   std::unordered_map<std::string, std::unordered_set<std::string>> whitelist;
+  MemberList lazy;  // parent type name -> child names
+  MemberList intern;  // element type name -> attribute names
+  MemberList soa;  // parent type name -> child names stored column by column
+  MemberList reserve;  // parent type name -> child names counted before parsing
   bool ignore_unknown { false };
   bool use_glm { false };
+  bool arena { false };  // allocate all nodes, vectors and strings in a zusixml::arena
+  bool string_view { false };  // string attributes are std::string_views into the input
+  bool compact_datetime { false };  // date/time attributes are zusixml::datetime instead of struct tm
+  LayoutProfile layout_profile;  // chooses the storage of children (--layout-profile); no documents if not given
+  bool reorder_members { false };  // order struct members by decreasing alignment and check the struct sizes
+  double sparse_threshold { 0 };  // attributes present in fewer elements of the layout profile are stored in zusixml::sparse_attributes
+  bool reuse { false };  // generate clear_element functions and take children from zusixml::element_pool (parse_root_into)
+  bool cache { false };  // generate write_element and read_element functions for snapshots in the parse cache (zusi_parser/cache.hpp)
+  NameDispatch name_dispatch { NameDispatch::Chain };
 };
 
+/** Combines the characters of @p name that the generated name_hash function looks at.
+ * Must match name_hash in the generated parser. */
+uint32_t NameHashKey(const std::string& name) {
+  assert(!name.empty());
+  return static_cast<uint32_t>(name.size() & 0xFF)
+    | (static_cast<uint32_t>(static_cast<unsigned char>(name[0])) << 8)
+    | (static_cast<uint32_t>(static_cast<unsigned char>(name[name.size() / 2])) << 16)
+    | (static_cast<uint32_t>(static_cast<unsigned char>(name[name.size() - 1])) << 24);
+}
+
+uint32_t NameHash(uint32_t key, uint32_t seed, unsigned bits) {
+  return (key * seed) >> (32 - bits);
+}
+
 /** Returns a size > 0 if a small vector of this size can be used to hold @p child
  * inside @p parentType. This is the case if the collection will rarely contain more than size elements,
  * but also rarely significantly fewer. */
@@ -102,23 +234,172 @@ size_t SmallVectorSize(const ElementType& /*parentType*/, const Child& child) {
   return 0;
 }
 
+/** Returns an expression that creates a new object of type @p cppName on the heap, or in the
+ * current zusixml::arena if @p arena is set. */
+std::string NewExpression(const std::string& cppName, bool arena) {
+  return arena ? "zusixml::arena_new<" + cppName + ">()" : "new " + cppName + "()";
+}
+
+/** Returns the type of a std::vector of @p elementType, using zusixml::allocator if @p arena is set. */
+std::string VectorType(const std::string& elementType, bool arena) {
+  return arena ? "std::vector<" + elementType + ", zusixml::allocator<" + elementType + ">>" : "std::vector<" + elementType + ">";
+}
+
+/** Size and alignment of a generated struct or member type as laid out by the compiler running parsergen
+ * (Itanium C++ ABI as used by GCC and Clang). */
+struct TypeLayout {
+  size_t size { 1 };
+  size_t alignment { 1 };
+  size_t dataSize { 0 };  // size without tail padding, which a derived struct reuses unless the type is a POD
+  bool pod { true };  // POD for the purpose of layout (C++03 POD)
+  bool empty { true };  // no members: occupies no space as a base class
+
+  template <typename T>
+  static TypeLayout Of(bool pod) {
+    return { sizeof(T), alignof(T), sizeof(T), pod, false };
+  }
+};
+
+/** Layout of a std::optional of a type with layout @p valueLayout (libstdc++ and libc++). */
+TypeLayout OptionalLayout(const TypeLayout& valueLayout) {
+  return { align(valueLayout.size + 1, valueLayout.alignment), valueLayout.alignment, valueLayout.size + 1, false, false };
+}
+
+/** Layout of a boost::container::small_vector with @p smallVectorSize elements with layout @p elementLayout.
+ * The vector header (pointer, size, capacity) is followed by storage for one element, and further storage
+ * for the elements that do not fit into the tail padding of the header. */
+TypeLayout SmallVectorLayout(const TypeLayout& elementLayout, size_t smallVectorSize) {
+  const size_t headerSize = 3 * sizeof(void*);
+  const size_t storageStart = align(headerSize, elementLayout.alignment);
+  const size_t alignment = std::max(alignof(void*), elementLayout.alignment);
+  const size_t baseDataSize = storageStart + elementLayout.size;
+  const size_t baseFreeBytes = align(baseDataSize, alignment) - storageStart;
+  const size_t neededBytes = smallVectorSize * elementLayout.size;
+  const size_t extraElements = (neededBytes <= baseFreeBytes ? 0 : (neededBytes - baseFreeBytes - 1) / elementLayout.size + 1);
+  const size_t dataSize = baseDataSize + extraElements * elementLayout.size;
+  return { align(dataSize, alignment), alignment, dataSize, false, false };
+}
+
+/** Number of bits of the presence mask of a zusixml::sparse_attributes holding @p count attributes (at most 64). */
+size_t SparseAttributesMaskBits(size_t count) {
+  return count <= 8 ? 8 : count <= 16 ? 16 : count <= 32 ? 32 : 64;
+}
+
+/** Size of the block that a zusixml::sparse_attributes allocates for attributes with the layouts
+ * @p layouts ordered by decreasing alignment: their struct followed by the presence mask. */
+size_t SparseAttributesBlockSize(const std::vector<TypeLayout>& layouts) {
+  size_t offset = 0;
+  size_t alignment = 1;
+  for (const auto& layout : layouts) {
+    offset = align(offset, layout.alignment) + layout.size;
+    alignment = std::max(alignment, layout.alignment);
+  }
+  const size_t maskBytes = SparseAttributesMaskBits(layouts.size()) / 8;
+  return align(align(std::max<size_t>(offset, 1), alignment) + maskBytes, std::max(alignment, maskBytes));
+}
+
+/** How a child is stored in its parent struct, see the ChildStrategy subclasses. */
+struct ChildLayout {
+  enum class Kind { UniquePtr, Optional, Inline };
+  Kind kind;
+  size_t smallVectorSize;  // multiple children only: > 0 to use a boost::container::small_vector of this size
+
+  bool operator==(const ChildLayout& other) const { return kind == other.kind && smallVectorSize == other.smallVectorSize; }
+  bool operator!=(const ChildLayout& other) const { return !(*this == other); }
+
+  std::string ToString(bool multiple) const {
+    const std::string element = (kind == Kind::UniquePtr ? "unique_ptr" : "T");
+    if (!multiple) {
+      return kind == Kind::Optional ? "optional" : kind == Kind::Inline ? "inline" : element;
+    }
+    return smallVectorSize > 0 ? "small_vector<" + element + ", " + std::to_string(smallVectorSize) + ">" : "vector<" + element + ">";
+  }
+};
+
+/** Expected memory use of a child layout over the documents of a layout profile. */
+struct LayoutCost {
+  double bytes { 0 };
+  double allocations { 0 };
+
+  /** Weight for comparing layouts: an allocation counts like this many bytes. */
+  static constexpr double allocation_weight = 64;
+  /** Bytes a heap allocation needs in addition to the requested size. */
+  static constexpr size_t heap_overhead = 16;
+
+  double Weighted() const { return bytes + allocation_weight * allocations; }
+};
+
+/** Returns the expected memory use of storing the children described by @p profile with @p layout.
+ * Assumes that vectors double their capacity when growing. */
+LayoutCost GetLayoutCost(const ChildLayout& layout, bool multiple, const ChildProfile& profile, const TypeLayout& childLayout) {
+  const size_t childElementSize = childLayout.size;
+  LayoutCost result;
+  for (const auto& [count, parents] : profile.histogram) {
+    double bytes = 0;
+    double allocations = 0;
+    if (!multiple) {
+      switch (layout.kind) {
+        case ChildLayout::Kind::UniquePtr:
+          bytes = sizeof(void*) + (count > 0 ? childElementSize + LayoutCost::heap_overhead : 0);
+          allocations = (count > 0 ? 1 : 0);
+          break;
+        case ChildLayout::Kind::Optional:
+          bytes = OptionalLayout(childLayout).size;
+          break;
+        case ChildLayout::Kind::Inline:
+          bytes = childElementSize;
+          break;
+      }
+    } else {
+      const TypeLayout elementLayout = (layout.kind == ChildLayout::Kind::UniquePtr ? TypeLayout::Of<void*>(false) : childLayout);
+      const size_t elementSize = elementLayout.size;
+      bytes = (layout.smallVectorSize > 0 ? SmallVectorLayout(elementLayout, layout.smallVectorSize).size : sizeof(std::vector<int>));
+      size_t capacity = layout.smallVectorSize;
+      while (capacity < count) {
+        capacity = std::max<size_t>(2 * capacity, 1);
+        allocations++;
+      }
+      if (capacity > layout.smallVectorSize) {
+        bytes += capacity * elementSize + LayoutCost::heap_overhead;
+      }
+      if (layout.kind == ChildLayout::Kind::UniquePtr) {
+        bytes += count * (childElementSize + LayoutCost::heap_overhead);
+        allocations += count;
+      }
+    }
+    result.bytes += parents * bytes;
+    result.allocations += parents * allocations;
+  }
+  return result;
+}
+
 /** Strategy to embed a single child or a collection of children into a parent struct. */
 class ChildStrategy {
  public:
   virtual std::string GetMemberDeclaration(const ElementType& elementType, const Child& child) = 0;
   virtual std::string GetParseMemberCode(const ElementType& elementType, const Child& child) = 0;
-  virtual std::size_t UpdateElementSize(const ElementType& elementType, const Child& child, std::size_t elementSize, std::size_t childElementSize) = 0;
+  /** Returns the layout of the member declared by GetMemberDeclaration, given the layout of the child type. */
+  virtual TypeLayout GetMemberLayout(const Child& child, const TypeLayout& childLayout) = 0;
+  /** Returns code that empties the member of the element pointed to by value like in a new element,
+   * keeping the memory that the parser can use again (option --reuse). */
+  virtual std::string GetClearMemberCode(const ElementType& elementType, const Child& child) = 0;
+  /** Returns code that writes the member of the element pointed to by value to the zusixml::cache::writer out,
+   * and code that reads it back from the zusixml::cache::reader in into a new element (option --cache). */
+  virtual std::string GetWriteMemberCode(const ElementType& elementType, const Child& child) = 0;
+  virtual std::string GetReadMemberCode(const ElementType& elementType, const Child& child) = 0;
   virtual ~ChildStrategy() = default;
 };
 
 class UniquePtrChildStrategy : public ChildStrategy {
  public:
-  std::string GetMemberDeclaration(const ElementType& elementType, const Child& child) override {
+  UniquePtrChildStrategy(bool arena, size_t smallVectorSize, bool reuse) : m_arena(arena), m_small_vector_size(smallVectorSize), m_reuse(reuse) {}
+
+  std::string GetMemberDeclaration(const ElementType& /*elementType*/, const Child& child) override {
     std::ostringstream out;
     std::string unique_ptr_type = std::string("std::unique_ptr<") + child.type->cppName + ", zusixml::deleter<" + child.type->cppName + ">>";
 
     if (child.multiple) {
-      size_t smallVectorSize = SmallVectorSize(elementType, child);
+      const size_t smallVectorSize = m_small_vector_size;
       if (smallVectorSize > 0) {
         out << "  boost::container::small_vector<" << unique_ptr_type << ", " << smallVectorSize << ", zusixml::allocator<" << unique_ptr_type << ">>";
       } else {
@@ -137,8 +418,14 @@ class UniquePtrChildStrategy : public ChildStrategy {
 
     if (child.multiple) {
       if (child.type->name == "StrElement" || child.type->name == "ReferenzElement") {
-        out << "  std::unique_ptr<" << child.type->name << "> childResult(new " << child.type->name << "());\n";
-        out << "  parse_element_" << child.type->name << "(text, childResult.get());\n";
+        if (m_arena) {
+          out << "  std::unique_ptr<" << child.type->name << ", zusixml::deleter<" << child.type->name << ">> childResult(" << NewExpression(child.type->name, m_arena) << ");\n";
+        } else if (m_reuse) {
+          out << "  std::unique_ptr<" << child.type->name << "> childResult(" << NewChild(child.type->name) << ");\n";
+        } else {
+          out << "  std::unique_ptr<" << child.type->name << "> childResult(new " << child.type->name << "());\n";
+        }
+        out << "  parse_element_" << child.type->name << "(text, end, childResult.get());\n";
         out << "  size_t index = childResult->";
         if (child.type->name == "StrElement") {
           out << "Nr";
@@ -157,31 +444,97 @@ class UniquePtrChildStrategy : public ChildStrategy {
         out << "    parseResult->children_" << child.name << "[index] = std::move(childResult);\n";
         out << "  }\n";
       } else {
-        out << "  parse_element_" << child.type->name << "(text, parseResult->children_" << child.name << ".emplace_back(new " << child.type->cppName << "()).get());\n";
+        out << "  parse_element_" << child.type->name << "(text, end, parseResult->children_" << child.name << ".emplace_back(" << NewChild(child.type->cppName) << ").get());\n";
       }
     } else {
-      out << "  std::unique_ptr<" << child.type->cppName << ", zusixml::deleter<" << child.type->cppName << ">> childResult(new " << child.type->cppName << "());\n";
+      out << "  std::unique_ptr<" << child.type->cppName << ", zusixml::deleter<" << child.type->cppName << ">> childResult(" << NewChild(child.type->cppName) << ");\n";
       out << "  parseResult->" << child.name << ".swap(childResult);\n";
 #if 0
       out << "  if (childResult) { RAPIDXML_PARSE_ERROR(\"Unexpected multiplicity: Child " << child.name << " of node " << typeName << "\", text); }\n";
 #endif
-      out << "  parse_element_" << child.type->name << "(text, parseResult->" << child.name << ".get());\n";
+      out << "  parse_element_" << child.type->name << "(text, end, parseResult->" << child.name << ".get());\n";
     }
     return out.str();
   }
 
-  std::size_t UpdateElementSize(const ElementType& elementType, const Child& child, std::size_t elementSize, std::size_t /*childElementSize*/) override {
+  TypeLayout GetMemberLayout(const Child& child, const TypeLayout& /*childLayout*/) override {
     if (child.multiple) {
-      size_t smallVectorSize = SmallVectorSize(elementType, child);
-      if (smallVectorSize > 0) {
-        return align(elementSize, alignof(std::vector<int>)) + smallVectorSize * sizeof(void*) + sizeof(size_t);
-      } else {
-        return align(elementSize, alignof(std::vector<int>)) + sizeof(std::vector<int>);
-      }
+      return m_small_vector_size > 0 ? SmallVectorLayout(TypeLayout::Of<void*>(false), m_small_vector_size) : TypeLayout::Of<std::vector<int>>(false);
+    }
+    return TypeLayout::Of<std::unique_ptr<int>>(false);
+  }
+
+  std::string GetClearMemberCode(const ElementType& /*elementType*/, const Child& child) override {
+    // The children go back to the pool, from which parse_element takes them again.
+    std::ostringstream out;
+    const std::string pool = "zusixml::element_pool<" + child.type->cppName + ">";
+    if (child.multiple) {
+      out << "  for (auto& child : value->children_" << child.name << ") {\n";
+      out << "    if (child) {\n";
+      out << "      clear_element_" << child.type->name << "(child.get());\n";
+      out << "      " << pool << "::release(std::move(child));\n";
+      out << "    }\n";
+      out << "  }\n";
+      out << "  value->children_" << child.name << ".clear();\n";
+    } else {
+      out << "  if (value->" << child.name << ") {\n";
+      out << "    clear_element_" << child.type->name << "(value->" << child.name << ".get());\n";
+      out << "    " << pool << "::release(std::move(value->" << child.name << "));\n";
+      out << "  }\n";
+    }
+    return out.str();
+  }
+
+  std::string GetWriteMemberCode(const ElementType& /*elementType*/, const Child& child) override {
+    // Children of StrElement and ReferenzElement vectors may be missing at some indexes.
+    std::ostringstream out;
+    if (child.multiple) {
+      out << "  out.put_size(value->children_" << child.name << ".size());\n";
+      out << "  for (const auto& child : value->children_" << child.name << ") {\n";
+      out << "    out.put(static_cast<bool>(child));\n";
+      out << "    if (child) {\n";
+      out << "      write_element_" << child.type->name << "(out, child.get());\n";
+      out << "    }\n";
+      out << "  }\n";
+    } else {
+      out << "  out.put(static_cast<bool>(value->" << child.name << "));\n";
+      out << "  if (value->" << child.name << ") {\n";
+      out << "    write_element_" << child.type->name << "(out, value->" << child.name << ".get());\n";
+      out << "  }\n";
+    }
+    return out.str();
+  }
+
+  std::string GetReadMemberCode(const ElementType& /*elementType*/, const Child& child) override {
+    std::ostringstream out;
+    if (child.multiple) {
+      out << "  const size_t count_" << child.name << " = in.get_size();\n";
+      out << "  value->children_" << child.name << ".reserve(count_" << child.name << ");\n";
+      out << "  for (size_t i = 0; i < count_" << child.name << "; i++) {\n";
+      // Boost < 1.62 (as used in MXE) does not return a reference to the emplaced element
+      out << "    value->children_" << child.name << ".emplace_back();\n";
+      out << "    if (in.get<bool>()) {\n";
+      out << "      value->children_" << child.name << ".back().reset(new " << child.type->cppName << "());\n";
+      out << "      read_element_" << child.type->name << "(in, value->children_" << child.name << ".back().get());\n";
+      out << "    }\n";
+      out << "  }\n";
     } else {
-      return align(elementSize, alignof(std::unique_ptr<int>)) + sizeof(std::unique_ptr<int>);
+      out << "  if (in.get<bool>()) {\n";
+      out << "    value->" << child.name << ".reset(new " << child.type->cppName << "());\n";
+      out << "    read_element_" << child.type->name << "(in, value->" << child.name << ".get());\n";
+      out << "  }\n";
     }
+    return out.str();
+  }
+ private:
+  /** Returns an expression for a new child element of type @p cppName: a raw pointer, or a std::unique_ptr from the pool with --reuse. */
+  std::string NewChild(const std::string& cppName) const {
+    return m_reuse ? "zusixml::element_pool<" + cppName + ">::acquire()" : NewExpression(cppName, m_arena);
   }
+
+  bool m_arena;
+  size_t m_small_vector_size;  // > 0: children are stored in a boost::container::small_vector of this size
+  bool m_reuse;  // take new children from zusixml::element_pool
 };
 
 class OptionalChildStrategy : public ChildStrategy {
@@ -197,26 +550,53 @@ class OptionalChildStrategy : public ChildStrategy {
     assert(!child.multiple);
     std::ostringstream out;
     out << "  parseResult->" << child.name << ".emplace();\n";
-    out << "  parse_element_" << child.type->name << "(text, &*parseResult->" << child.name << ");\n";
+    out << "  parse_element_" << child.type->name << "(text, end, &*parseResult->" << child.name << ");\n";
+    return out.str();
+  }
+
+  TypeLayout GetMemberLayout(const Child& /*child*/, const TypeLayout& childLayout) override {
+    return OptionalLayout(childLayout);
+  }
+
+  std::string GetClearMemberCode(const ElementType& /*elementType*/, const Child& child) override {
+    return "  value->" + child.name + ".reset();\n";
+  }
+
+  std::string GetWriteMemberCode(const ElementType& /*elementType*/, const Child& child) override {
+    std::ostringstream out;
+    out << "  out.put(value->" << child.name << ".has_value());\n";
+    out << "  if (value->" << child.name << ") {\n";
+    out << "    write_element_" << child.type->name << "(out, &*value->" << child.name << ");\n";
+    out << "  }\n";
     return out.str();
   }
 
-  std::size_t UpdateElementSize(const ElementType& /*elementType*/, const Child& /*child*/, std::size_t elementSize, std::size_t childElementSize) override {
-    return align(elementSize + 1, alignof(void*)) + childElementSize;
+  std::string GetReadMemberCode(const ElementType& /*elementType*/, const Child& child) override {
+    std::ostringstream out;
+    out << "  if (in.get<bool>()) {\n";
+    out << "    read_element_" << child.type->name << "(in, &value->" << child.name << ".emplace());\n";
+    out << "  }\n";
+    return out.str();
   }
 };
 
 class InlineChildStrategy : public ChildStrategy {
  public:
-  std::string GetMemberDeclaration(const ElementType& elementType, const Child& child) override {
+  InlineChildStrategy(bool arena, size_t smallVectorSize) : m_arena(arena), m_small_vector_size(smallVectorSize) {}
+
+  std::string GetMemberDeclaration(const ElementType& /*elementType*/, const Child& child) override {
     std::ostringstream out;
 
     if (child.multiple) {
-      size_t smallVectorSize = SmallVectorSize(elementType, child);
+      const size_t smallVectorSize = m_small_vector_size;
       if (smallVectorSize > 0) {
-        out << "  boost::container::small_vector<" << child.type->cppName << ", " << smallVectorSize << ">";
+        out << "  boost::container::small_vector<" << child.type->cppName << ", " << smallVectorSize;
+        if (m_arena) {
+          out << ", zusixml::allocator<" << child.type->cppName << ">";
+        }
+        out << ">";
       } else {
-        out << "  std::vector<" << child.type->cppName << ">";
+        out << "  " << VectorType(child.type->cppName, m_arena);
       }
       out << " children_" << child.name << ";\n";
     } else {
@@ -226,41 +606,208 @@ class InlineChildStrategy : public ChildStrategy {
     return out.str();
   }
 
-  std::string GetParseMemberCode(const ElementType& elementType, const Child& child) override {
+  std::string GetParseMemberCode(const ElementType& /*elementType*/, const Child& child) override {
     std::ostringstream out;
 
     if (child.multiple) {
-      size_t smallVectorSize = SmallVectorSize(elementType, child);
+      const size_t smallVectorSize = m_small_vector_size;
       if (smallVectorSize > 0) {
         // Boost < 1.62 (as used in MXE) does not return an iterator to the emplaced element
         out << "#if BOOST_VERSION < 106200\n";
         out << "  parseResult->children_" << child.name << ".emplace_back();\n";
-        out << "  parse_element_" << child.type->name << "(text, &parseResult->children_" << child.name << ".back());\n";
+        out << "  parse_element_" << child.type->name << "(text, end, &parseResult->children_" << child.name << ".back());\n";
         out << "#else\n";
       }
-      out << "  parse_element_" << child.type->name << "(text, &parseResult->children_" << child.name << ".emplace_back());\n";
+      out << "  parse_element_" << child.type->name << "(text, end, &parseResult->children_" << child.name << ".emplace_back());\n";
       if (smallVectorSize > 0) {
         out << "#endif\n";
       }
     } else {
-      out << "  parse_element_" << child.type->name << "(text, &parseResult->" << child.name << ");\n";
+      out << "  parse_element_" << child.type->name << "(text, end, &parseResult->" << child.name << ");\n";
     }
 
     return out.str();
   }
 
-  std::size_t UpdateElementSize(const ElementType& elementType, const Child& child, std::size_t elementSize, std::size_t childElementSize) override {
+  TypeLayout GetMemberLayout(const Child& child, const TypeLayout& childLayout) override {
     if (child.multiple) {
-      size_t smallVectorSize = SmallVectorSize(elementType, child);
-      if (smallVectorSize > 0) {
-        return align(elementSize, alignof(std::vector<int>)) + smallVectorSize * childElementSize + sizeof(size_t);
-      } else {
-        return align(elementSize, alignof(std::vector<int>)) + sizeof(std::vector<int>);
-      }
+      return m_small_vector_size > 0 ? SmallVectorLayout(childLayout, m_small_vector_size) : TypeLayout::Of<std::vector<int>>(false);
+    }
+    return childLayout;
+  }
+
+  std::string GetClearMemberCode(const ElementType& /*elementType*/, const Child& child) override {
+    if (child.multiple) {
+      // Keeps the capacity of the vector, but not the memory held by the children.
+      return "  value->children_" + child.name + ".clear();\n";
+    }
+    return "  clear_element_" + child.type->name + "(&value->" + child.name + ");\n";
+  }
+
+  std::string GetWriteMemberCode(const ElementType& /*elementType*/, const Child& child) override {
+    std::ostringstream out;
+    if (child.multiple) {
+      out << "  out.put_size(value->children_" << child.name << ".size());\n";
+      out << "  for (const auto& child : value->children_" << child.name << ") {\n";
+      out << "    write_element_" << child.type->name << "(out, &child);\n";
+      out << "  }\n";
+    } else {
+      out << "  write_element_" << child.type->name << "(out, &value->" << child.name << ");\n";
+    }
+    return out.str();
+  }
+
+  std::string GetReadMemberCode(const ElementType& /*elementType*/, const Child& child) override {
+    std::ostringstream out;
+    if (child.multiple) {
+      out << "  const size_t count_" << child.name << " = in.get_size();\n";
+      out << "  value->children_" << child.name << ".reserve(count_" << child.name << ");\n";
+      out << "  for (size_t i = 0; i < count_" << child.name << "; i++) {\n";
+      // Boost < 1.62 (as used in MXE) does not return a reference to the emplaced element
+      out << "    value->children_" << child.name << ".emplace_back();\n";
+      out << "    read_element_" << child.type->name << "(in, &value->children_" << child.name << ".back());\n";
+      out << "  }\n";
+    } else {
+      out << "  read_element_" << child.type->name << "(in, &value->" << child.name << ");\n";
+    }
+    return out.str();
+  }
+ private:
+  bool m_arena;
+  size_t m_small_vector_size;  // > 0: children are stored in a boost::container::small_vector of this size
+};
+
+/** Strategy for children that are only skipped while parsing the parent. The source range is stored
+ * in a zusixml::lazy, which parses the child on first access. */
+class LazyChildStrategy : public ChildStrategy {
+ public:
+  LazyChildStrategy(bool arena, size_t contextPointers) : m_arena(arena), m_context_pointers(contextPointers) {}
+
+  std::string GetMemberDeclaration(const ElementType& /*elementType*/, const Child& child) override {
+    std::ostringstream out;
+    if (child.multiple) {
+      out << "  " << VectorType("zusixml::lazy<" + child.type->cppName + ">", m_arena) << " children_" << child.name << ";\n";
+    } else {
+      out << "  zusixml::lazy<" << child.type->cppName << "> " << child.name << ";\n";
+    }
+    return out.str();
+  }
+
+  std::string GetParseMemberCode(const ElementType& /*elementType*/, const Child& child) override {
+    std::ostringstream out;
+    out << "  const Ch* lazyBegin = text;\n";
+    out << "  skip_element(text, end);\n";
+    if (child.multiple) {
+      out << "  parseResult->children_" << child.name << ".emplace_back(lazyBegin, text, &parse_element_" << child.type->name << ");\n";
+    } else {
+      out << "  parseResult->" << child.name << " = zusixml::lazy<" << child.type->cppName << ">(lazyBegin, text, &parse_element_" << child.type->name << ");\n";
+    }
+    return out.str();
+  }
+
+  TypeLayout GetMemberLayout(const Child& child, const TypeLayout& /*childLayout*/) override {
+    if (child.multiple) {
+      return TypeLayout::Of<std::vector<int>>(false);
+    }
+    const size_t size = (4 + m_context_pointers) * sizeof(void*);
+    return { size, alignof(void*), size, false, false };
+  }
+
+  std::string GetClearMemberCode(const ElementType& /*elementType*/, const Child& child) override {
+    if (child.multiple) {
+      return "  value->children_" + child.name + ".clear();\n";
+    }
+    return "  value->" + child.name + " = {};\n";
+  }
+
+  std::string GetWriteMemberCode(const ElementType& /*elementType*/, const Child& child) override {
+    // The snapshot holds the parsed child, so that the XML data is not needed when reading it back.
+    std::ostringstream out;
+    if (child.multiple) {
+      out << "  out.put_size(value->children_" << child.name << ".size());\n";
+      out << "  for (const auto& child : value->children_" << child.name << ") {\n";
+      out << "    write_element_" << child.type->name << "(out, &child.get());\n";
+      out << "  }\n";
+    } else {
+      out << "  out.put(!value->" << child.name << ".empty());\n";
+      out << "  if (!value->" << child.name << ".empty()) {\n";
+      out << "    write_element_" << child.type->name << "(out, &value->" << child.name << ".get());\n";
+      out << "  }\n";
+    }
+    return out.str();
+  }
+
+  std::string GetReadMemberCode(const ElementType& /*elementType*/, const Child& child) override {
+    std::ostringstream out;
+    const std::string pointerType = "std::unique_ptr<" + child.type->cppName + ", zusixml::deleter<" + child.type->cppName + ">>";
+    if (child.multiple) {
+      out << "  const size_t count_" << child.name << " = in.get_size();\n";
+      out << "  value->children_" << child.name << ".reserve(count_" << child.name << ");\n";
+      out << "  for (size_t i = 0; i < count_" << child.name << "; i++) {\n";
+      out << "    " << pointerType << " child(new " << child.type->cppName << "());\n";
+      out << "    read_element_" << child.type->name << "(in, child.get());\n";
+      out << "    value->children_" << child.name << ".emplace_back(std::move(child));\n";
+      out << "  }\n";
     } else {
-      return align(elementSize, alignof(void*)) + childElementSize;
+      out << "  if (in.get<bool>()) {\n";
+      out << "    " << pointerType << " child(new " << child.type->cppName << "());\n";
+      out << "    read_element_" << child.type->name << "(in, child.get());\n";
+      out << "    value->" << child.name << " = zusixml::lazy<" << child.type->cppName << ">(std::move(child));\n";
+      out << "  }\n";
+    }
+    return out.str();
+  }
+ private:
+  bool m_arena;
+  size_t m_context_pointers;  // zusixml::lazy stores the arena and intern table of its document
+};
+
+/** Strategy for repeated children that are stored member by member in a zusixml::soa_vector (option --soa).
+ * Each child is parsed into a temporary and then appended to the columns. */
+class SoaChildStrategy : public ChildStrategy {
+ public:
+  explicit SoaChildStrategy(std::vector<std::string> columns) : m_columns(std::move(columns)) {}
+
+  std::string GetMemberDeclaration(const ElementType& /*elementType*/, const Child& child) override {
+    assert(child.multiple);
+    std::ostringstream out;
+    out << "  zusixml::soa_vector<" << child.type->cppName << ", zusixml::allocator";
+    for (const auto& column : m_columns) {
+      out << ", &" << child.type->name << "::" << column;
     }
+    out << "> children_" << child.name << ";\n";
+    return out.str();
+  }
+
+  std::string GetParseMemberCode(const ElementType& /*elementType*/, const Child& child) override {
+    assert(child.multiple);
+    std::ostringstream out;
+    out << "  " << child.type->cppName << " childResult {};\n";
+    out << "  parse_element_" << child.type->name << "(text, end, &childResult);\n";
+    out << "  parseResult->children_" << child.name << ".push_back(std::move(childResult));\n";
+    return out.str();
+  }
+
+  TypeLayout GetMemberLayout(const Child& /*child*/, const TypeLayout& /*childLayout*/) override {
+    const size_t size = m_columns.size() * sizeof(std::vector<int>);
+    return { size, alignof(std::vector<int>), size, false, false };
+  }
+
+  std::string GetClearMemberCode(const ElementType& /*elementType*/, const Child& child) override {
+    return "  value->children_" + child.name + ".clear();\n";
   }
+
+  std::string GetWriteMemberCode(const ElementType& /*elementType*/, const Child& /*child*/) override {
+    assert(false && "--soa cannot be combined with --cache");
+    return "";
+  }
+
+  std::string GetReadMemberCode(const ElementType& /*elementType*/, const Child& /*child*/) override {
+    assert(false && "--soa cannot be combined with --cache");
+    return "";
+  }
+ private:
+  std::vector<std::string> m_columns;  // member names of the child type
 };
 
 class ParserGenerator {
@@ -278,20 +825,172 @@ class ParserGenerator {
     out << "#include <memory>  // for std::unique_ptr\n";
     out << "#include <optional>// for std::optional\n";
     out << "#include <string>  // for std::string\n";
+    if (m_config.string_view) {
+      out << "#include <string_view>\n";
+    }
     out << "#include <ctime>   // for struct tm\n";
+    out << "#include \"zusi_parser/datetime.hpp\"\n";
+    if (m_config.arena || m_config.string_view) {
+      out << "#include \"zusi_parser/arena.hpp\"\n";
+    }
+    if (!m_config.intern.empty()) {
+      out << "#include \"zusi_parser/intern.hpp\"\n";
+    }
+    if (!m_config.soa.empty()) {
+      out << "#include \"zusi_parser/soa.hpp\"\n";
+    }
+    if (m_config.sparse_threshold > 0) {
+      out << "#include \"zusi_parser/sparse.hpp\"\n";
+    }
+    if (m_config.reuse) {
+      out << "#include \"zusi_parser/pool.hpp\"\n";
+    }
     out << "struct ArgbColor {\n";
     out << "  uint8_t a, r, g, b;\n";
     out << "};\n";
     out << "namespace zusixml {\n";
     out << "  template <typename T>\n";
-    out << "  using allocator = std::allocator<T>;\n";
+    out << "  using allocator = " << (m_config.arena ? "arena_allocator<T>" : "std::allocator<T>") << ";\n";
     out << "  template <typename T>\n";
-    out << "  using deleter = std::default_delete<T>;\n";
+    out << "  using deleter = " << (m_config.arena ? "arena_deleter<T>" : "std::default_delete<T>") << ";\n";
+    if (m_config.reorder_members) {
+      // The numbers are compared with the layouts that parsergen computes for the member types.
+      out << "  /** Whether the compiler lays out structs like the one that parsergen was built with, so that the\n";
+      out << "   * sizes of the generated structs are checked. */\n";
+      out << "#if defined(_MSC_VER)\n";
+      out << "  constexpr bool layout_as_generated = false;\n";
+      out << "#else\n";
+      out << "  constexpr bool layout_as_generated = sizeof(void*) == " << sizeof(void*)
+          << " && sizeof(std::string) == " << sizeof(std::string)
+          << " && sizeof(std::vector<int>) == " << sizeof(std::vector<int>)
+          << " && sizeof(struct tm) == " << sizeof(struct tm)
+          << "\n      && sizeof(std::optional<char>) == " << OptionalLayout(TypeLayout::Of<char>(true)).size
+          << " && sizeof(boost::container::small_vector<char, 1>) == " << SmallVectorLayout(TypeLayout::Of<char>(true), 1).size
+          << " && sizeof(boost::container::small_vector<int, 3>) == " << SmallVectorLayout(TypeLayout::Of<int>(true), 3).size
+          << " && sizeof(boost::container::small_vector<int64_t, 2>) == " << SmallVectorLayout(TypeLayout::Of<int64_t>(true), 2).size
+          << ";\n";
+      out << "#endif\n";
+    }
+    if (!m_config.lazy.empty()) {
+      out << R""(
+  /** Child element that is parsed on first access (parsergen option --lazy).
+   * Refers to the XML data of the document, which must remain valid until then. The documents returned
+   * by zusixml::parseFile and its variants hold the data (document::hold_input), parse_root does not. Not thread-safe. */
+  template <typename T>
+  class lazy {
+   public:
+    using parse_function = void (*)(const char*&, const char*, T*);
+
+    lazy() = default;
+    lazy(const char* begin, const char* end, parse_function parse) : m_begin(begin), m_end(end), m_parse(parse) {}
+)"";
+      if (m_config.cache) {
+        out << R""(    /** Element that is already parsed, e.g. read from a snapshot of the parse cache. */
+    explicit lazy(std::unique_ptr<T, deleter<T>> value) : m_parse(&already_parsed), m_value(std::move(value)) {}
+)"";
+      }
+      out << R""(
+    /** Returns the parsed element, or a default-constructed element if there is none (empty()).
+     * Throws zusixml::parse_error if the element is invalid. */
+    const T& get() const {
+      if (!m_value) {
+)"";
+      if (m_config.arena || m_config.string_view) {
+        // Parse into the arena of the document, which need not be current on first access.
+        // A default-constructed lazy outside of a scope has none.
+        out << "        std::optional<arena::scope> scope;\n";
+        out << "        if (m_arena != nullptr) {\n";
+        out << "          scope.emplace(*m_arena);\n";
+        out << "        }\n";
+      }
+      if (!m_config.intern.empty()) {
+        out << "        intern_table::scope intern_scope(m_strings ? *m_strings : intern_table::shared());\n";
+      }
+      if (m_config.arena) {
+        out << "        std::unique_ptr<T, deleter<T>> value(arena_new<T>());\n";
+      } else {
+        out << R""(        std::unique_ptr<T, deleter<T>> value(new T());
+)"";
+      }
+      out << R""(        if (m_parse != nullptr) {
+          const char* text = m_begin;
+          m_parse(text, m_end, value.get());
+        }
+        m_value = std::move(value);
+      }
+      return *m_value;
+    }
+    T& get() {
+      return const_cast<T&>(static_cast<const lazy*>(this)->get());
+    }
+    const T& operator*() const { return get(); }
+    T& operator*() { return get(); }
+    const T* operator->() const { return &get(); }
+    T* operator->() { return &get(); }
+
+    /** Returns whether the element has been parsed already. */
+    bool parsed() const { return static_cast<bool>(m_value); }
+    /** Returns whether there is no element (default-constructed), also after get(). */
+    bool empty() const { return m_parse == nullptr; }
+    explicit operator bool() const { return !empty(); }
+
+   private:
+    const char* m_begin { nullptr };
+    const char* m_end { nullptr };
+    parse_function m_parse { nullptr };
+    mutable std::unique_ptr<T, deleter<T>> m_value;
+)"";
+      if (m_config.arena || m_config.string_view) {
+        out << "    arena* m_arena { arena::active() };\n";
+      }
+      if (!m_config.intern.empty()) {
+        out << "    intern_table* m_strings { intern_table::current() };\n";
+      }
+      if (m_config.cache) {
+        out << R""(
+    /** Marks an element read from a snapshot as present. */
+    static void already_parsed(const char*&, const char*, T*) {}
+)"";
+      }
+      out << R""(  };
+)"";
+    }
     out << "}\n";
   }
 
   void GenerateTypeDeclarations(std::ostream& out) {
     out << "#pragma once\n";
+    // parse_root returns a zusixml::document owning the arena instead of a std::unique_ptr
+    if (m_config.arena) {
+      out << "#define ZUSIXML_ARENA\n";
+    }
+    if (m_config.string_view) {
+      out << "#define ZUSIXML_STRING_VIEW\n";
+    }
+    if (!m_config.intern.empty()) {
+      out << "#define ZUSIXML_INTERN\n";
+    }
+    // zusixml::lazy refers to the XML data, which the returned zusixml::document can hold
+    if (!m_config.lazy.empty()) {
+      out << "#define ZUSIXML_LAZY\n";
+    }
+    if (m_config.compact_datetime) {
+      out << "#define ZUSIXML_COMPACT_DATETIME\n";
+    }
+    if (!m_config.soa.empty()) {
+      out << "#define ZUSIXML_SOA\n";
+    }
+    if (m_config.sparse_threshold > 0) {
+      out << "#define ZUSIXML_SPARSE_ATTRIBUTES\n";
+    }
+    // enables zusixml::parse_root_into
+    if (m_config.reuse) {
+      out << "#define ZUSIXML_REUSE\n";
+    }
+    // enables zusixml::ParseCache
+    if (m_config.cache) {
+      out << "#define ZUSIXML_CACHE\n";
+    }
     if (m_config.use_glm) {
       out << "#include <glm/glm.hpp>\n";
       out << "#include <glm/gtx/quaternion.hpp>\n";
@@ -387,6 +1086,8 @@ class ParserGenerator {
       const ElementType* elementType = *it;
 
       if (m_config.use_glm && ((elementType->name == "Vec2") || (elementType->name == "Vec3") || (elementType->name == "Quaternion"))) {
+        const size_t size = elementType->attributes.size() * sizeof(float);
+        m_element_type_layouts[elementType] = { size, alignof(float), size, false, false };
         continue;
       }
 
@@ -399,82 +1100,213 @@ class ParserGenerator {
       }
       out << " {\n";
 
-      size_t elementSize = 0;
-
-      std::ostringstream attrs;
+      std::vector<Member> attrs;
+      const auto sparseAttributes = GetSparseAttributes(*elementType);
+      std::vector<Member> sparseMembers;
+      std::ostringstream sparseAccessors;
       for (const auto& attribute : elementType->attributes) {
         if (!IsOnWhitelist(*elementType, attribute)) {
           continue;
         }
-        if (!attribute.documentation.empty()) {
-          attrs << "  /** " << attribute.documentation << "*/\n";
+        TypeLayout layout;
+        const std::string typeName = GetAttributeType(*elementType, attribute, &layout);
+        const std::string documentation = attribute.documentation.empty() ? "" : "  /** " + attribute.documentation + "*/\n";
+        const auto sparseIt = std::find(sparseAttributes.begin(), sparseAttributes.end(), &attribute);
+        if (sparseIt != sparseAttributes.end()) {
+          sparseMembers.push_back({ attribute.name, "    " + typeName + " " + attribute.name + ";\n", layout, false, 0 });
+          sparseAccessors << documentation;
+          sparseAccessors << "  const " << typeName << "& " << attribute.name << "() const { return sparse_attributes.get()." << attribute.name << "; }\n";
+          sparseAccessors << "  bool has_" << attribute.name << "() const { return sparse_attributes.has(" << (sparseIt - sparseAttributes.begin()) << "); }\n";
+          continue;
         }
-        attrs << "  ";
-        switch (attribute.type) {
-          case AttributeType::Int32:
-            attrs << "int32_t";
-            elementSize = align(elementSize, alignof(int32_t)) + sizeof(int32_t);
-            break;
-          case AttributeType::Int64:
-            attrs << "int64_t";
-            elementSize = align(elementSize, alignof(int64_t)) + sizeof(int64_t);
-            break;
-          case AttributeType::Boolean:
-            attrs << "bool";
-            elementSize = align(elementSize, alignof(bool)) + sizeof(bool);
-            break;
-          case AttributeType::String:
-            attrs << "std::basic_string<char, std::char_traits<char>, zusixml::allocator<char>>";
-            elementSize = align(elementSize, alignof(std::string)) + sizeof(std::string);
-            break;
-          case AttributeType::Float:
-            attrs << "float";
-            elementSize = align(elementSize, alignof(float)) + sizeof(float);
-            break;
-          case AttributeType::DateTime:
-            attrs << "struct tm";
-            elementSize = align(elementSize, alignof(struct tm)) + sizeof(struct tm);
-            break;
-          case AttributeType::HexInt32:
-            attrs << "int32_t";
-            elementSize = align(elementSize, alignof(int32_t)) + sizeof(int32_t);
-            break;
-          case AttributeType::FaceIndexes:
-            attrs << "std::array<uint16_t, 3>";
-            elementSize = align(elementSize, alignof(std::array<uint16_t, 3>)) + sizeof(std::array<uint16_t, 3>);
-            break;
-          case AttributeType::ArgbColor:
-            attrs << "ArgbColor";
-            elementSize = align(elementSize, alignof(uint32_t)) + sizeof(uint32_t);
-            break;
+        attrs.push_back({ attribute.name, documentation + "  " + typeName + " " + attribute.name + ";\n", layout, false, 0 });
+      }
+      if (!sparseMembers.empty()) {
+        // Decreasing alignment leaves no padding in the side store.
+        std::stable_sort(sparseMembers.begin(), sparseMembers.end(), [](const Member& lhs, const Member& rhs) {
+          return lhs.layout.alignment > rhs.layout.alignment;
+        });
+        const size_t maskBits = SparseAttributesMaskBits(sparseMembers.size());
+        std::ostringstream decl;
+        decl << "  /** Attributes present in few elements (parsergen --sparse-attributes), allocated only if one of them is present. */\n";
+        decl << "  struct SparseAttributes {\n";
+        size_t memberBytes = 0;
+        std::vector<TypeLayout> layouts;
+        for (const auto& member : sparseMembers) {
+          decl << member.declaration;
+          memberBytes += member.layout.size;
+          layouts.push_back(member.layout);
         }
-        attrs << " " << attribute.name << ";\n";
+        decl << "  };\n";
+        decl << "  zusixml::sparse_attributes<SparseAttributes, uint" << maskBits << "_t, zusixml::allocator> sparse_attributes;\n";
+        decl << sparseAccessors.str();
+        m_sparse_attribute_report.push_back({ elementType, sparseAttributes, memberBytes, SparseAttributesBlockSize(layouts) });
+        attrs.push_back({ "sparse_attributes", decl.str(), TypeLayout::Of<void*>(false), false, 0 });
       }
 
-      std::ostringstream children;
+      std::vector<Member> children;
       for (const auto& child : elementType->children) {
         if (!IsOnWhitelist(*elementType, child)) {
           continue;
         }
+        std::ostringstream decl;
         if (!child.documentation.empty()) {
-          children << "  /** " << child.documentation << "*/\n";
+          decl << "  /** " << child.documentation << "*/\n";
+        }
+        const auto& childLayoutIt = m_element_type_layouts.find(child.type);
+        if (childLayoutIt != std::end(m_element_type_layouts)) {
+          ChooseChildLayout(*elementType, child, childLayoutIt->second);
         }
         const auto& childStrategy = GetChildStrategy(*elementType, child);
-        children << childStrategy->GetMemberDeclaration(*elementType, child);
+        decl << childStrategy->GetMemberDeclaration(*elementType, child);
+        // A child type that is not yet defined is only referred to by pointer (recursive children).
+        const TypeLayout childLayout = (childLayoutIt == std::end(m_element_type_layouts) ? TypeLayout::Of<void*>(false) : childLayoutIt->second);
+        children.push_back({ child.multiple ? "children_" + child.name : child.name, decl.str(),
+            childStrategy->GetMemberLayout(child, childLayout), true, GetPresence(*elementType, child) });
+      }
 
-        const auto& childSizeIt = m_element_type_sizes.find(child.type);
-        elementSize = childStrategy->UpdateElementSize(*elementType, child, elementSize, childSizeIt == std::end(m_element_type_sizes) ? 9999 : childSizeIt->second);
+      const TypeLayout* baseLayout = nullptr;
+      if (elementType->base) {
+        const auto& baseLayoutIt = m_element_type_layouts.find(elementType->base);
+        baseLayout = (baseLayoutIt == std::end(m_element_type_layouts) ? nullptr : &baseLayoutIt->second);
       }
+      const size_t baseBytes = (baseLayout && !baseLayout->empty ? (baseLayout->pod ? baseLayout->size : baseLayout->dataSize) : 0);
 
-      m_element_type_sizes[elementType] = elementSize;
-
+      std::vector<Member> members;
       if (elementType->name == "Vertex") {
         // make compatible with you-know-what
-        out << children.str() << attrs.str();
+        members = std::move(children);
+        members.insert(members.end(), attrs.begin(), attrs.end());
       } else {
-        out << attrs.str() << children.str();
+        members = std::move(attrs);
+        members.insert(members.end(), children.begin(), children.end());
+        if (m_config.reorder_members) {
+          // Decreasing alignment leaves no padding between members. Attributes stay in front of children,
+          // and children that are more often present in the layout profile come first.
+          std::stable_sort(members.begin(), members.end(), [](const Member& lhs, const Member& rhs) {
+            if (lhs.layout.alignment != rhs.layout.alignment) {
+              return lhs.layout.alignment > rhs.layout.alignment;
+            }
+            if (lhs.child != rhs.child) {
+              return rhs.child;
+            }
+            return lhs.hotness > rhs.hotness;
+          });
+        }
+        if (m_config.reorder_members && baseLayout) {
+          // Members that fit into the tail padding of the base class go first, where the compiler places them
+          // in that padding instead of after it.
+          std::vector<Member> inTailPadding, rest;
+          size_t tailOffset = baseBytes;
+          for (auto& member : members) {
+            const size_t end = align(tailOffset, member.layout.alignment) + member.layout.size;
+            if (end <= baseLayout->size) {
+              tailOffset = end;
+              inTailPadding.push_back(std::move(member));
+            } else {
+              rest.push_back(std::move(member));
+            }
+          }
+          members = std::move(inTailPadding);
+          members.insert(members.end(), rest.begin(), rest.end());
+        }
+      }
+
+      size_t offset = baseBytes;
+      TypeLayout layout { 0, baseLayout ? baseLayout->alignment : 1, 0, !elementType->base, !baseLayout || baseLayout->empty };
+      size_t memberBytes = 0;
+      for (const auto& member : members) {
+        out << member.declaration;
+        offset = align(offset, member.layout.alignment) + member.layout.size;
+        memberBytes += member.layout.size;
+        layout.alignment = std::max(layout.alignment, member.layout.alignment);
+        layout.pod = layout.pod && member.layout.pod;
+        layout.empty = false;
       }
+      layout.dataSize = offset;
+      layout.size = align(std::max<size_t>(offset, 1), layout.alignment);
+      m_element_type_layouts[elementType] = layout;
+      auto& memberNames = m_element_type_member_names[elementType];
+      if (elementType->base) {
+        memberNames = m_element_type_member_names[elementType->base];
+      }
+      for (const auto& member : members) {
+        memberNames.push_back(member.name);
+      }
+      m_type_layout_report.push_back({ elementType, layout, members.size(), memberBytes, layout.size - memberBytes - baseBytes });
+
       out << "};\n";
+      if (m_config.reorder_members) {
+        out << "static_assert(!zusixml::layout_as_generated || sizeof(" << elementType->name << ") == " << layout.size
+            << ", \"Size of " << elementType->name << " differs from the layout computed by parsergen\");\n";
+      }
+    }
+  }
+
+  /** Returns the C++ type of the member that holds @p attribute of @p elementType, and its layout in @p layout. */
+  std::string GetAttributeType(const ElementType& elementType, const Attribute& attribute, TypeLayout* layout) const {
+    std::ostringstream decl;
+    switch (attribute.type) {
+      case AttributeType::Int32:
+        decl << "int32_t";
+        *layout = TypeLayout::Of<int32_t>(true);
+        break;
+      case AttributeType::Int64:
+        decl << "int64_t";
+        *layout = TypeLayout::Of<int64_t>(true);
+        break;
+      case AttributeType::Boolean:
+        decl << "bool";
+        *layout = TypeLayout::Of<bool>(true);
+        break;
+      case AttributeType::String:
+        if (IsInterned(elementType, attribute)) {
+          decl << "zusixml::interned_string";
+          *layout = TypeLayout::Of<void*>(false);
+        } else if (m_config.string_view) {
+          decl << "std::string_view";
+          *layout = TypeLayout::Of<std::string_view>(false);
+        } else {
+          decl << "std::basic_string<char, std::char_traits<char>, zusixml::allocator<char>>";
+          *layout = TypeLayout::Of<std::string>(false);
+        }
+        break;
+      case AttributeType::Float:
+        decl << "float";
+        *layout = TypeLayout::Of<float>(true);
+        break;
+      case AttributeType::DateTime:
+        if (m_config.compact_datetime) {
+          decl << "zusixml::datetime";
+          *layout = TypeLayout::Of<uint64_t>(false);
+        } else {
+          decl << "struct tm";
+          *layout = TypeLayout::Of<struct tm>(true);
+        }
+        break;
+      case AttributeType::HexInt32:
+        decl << "int32_t";
+        *layout = TypeLayout::Of<int32_t>(true);
+        break;
+      case AttributeType::FaceIndexes:
+        decl << "std::array<uint16_t, 3>";
+        *layout = TypeLayout::Of<std::array<uint16_t, 3>>(true);
+        break;
+      case AttributeType::ArgbColor:
+        decl << "ArgbColor";
+        *layout = TypeLayout::Of<std::array<uint8_t, 4>>(true);
+        break;
+    }
+    return decl.str();
+  }
+
+  /** Writes the size, alignment and padding of every generated struct as CSV (option --layout-report).
+   * Padding counts the bytes not occupied by the members or the base class, including tail padding. */
+  void WriteLayoutReport(std::ostream& out) const {
+    out << "type,size,alignment,members,member_bytes,padding\n";
+    for (const auto& entry : m_type_layout_report) {
+      out << entry.elementType->name << "," << entry.layout.size << "," << entry.layout.alignment << ","
+          << entry.members << "," << entry.memberBytes << "," << entry.padding << "\n";
     }
   }
 
@@ -482,6 +1314,9 @@ class ParserGenerator {
     out << "#pragma once\n";
     out << "#include \"zusi_parser/zusi_types_fwd.hpp\"\n";
     out << "namespace zusixml {\n";
+    if (m_config.cache) {
+      out << "  namespace cache { class writer; class reader; }\n";
+    }
     for (const auto& elementType : m_element_types) {
       if (m_used_element_types.find(elementType.get()) == std::end(m_used_element_types)) {
         continue;
@@ -489,7 +1324,14 @@ class ParserGenerator {
       if (m_concrete_element_types.find(elementType.get()) == std::end(m_concrete_element_types)) {
         continue;
       }
-      out << "  static void parse_element_" << elementType->name << "(const Ch *&, " << elementType->name << "*);\n";
+      out << "  static void parse_element_" << elementType->name << "(const Ch *&, const Ch *, " << elementType->name << "*);\n";
+      if (m_config.reuse) {
+        out << "  static void clear_element_" << elementType->name << "(" << elementType->name << "*);\n";
+      }
+      if (m_config.cache) {
+        out << "  static void write_element_" << elementType->name << "(cache::writer&, const " << elementType->name << "*);\n";
+        out << "  static void read_element_" << elementType->name << "(cache::reader&, " << elementType->name << "*);\n";
+      }
     }
     out << "}  // namespace zusixml\n";
   }
@@ -501,134 +1343,296 @@ class ParserGenerator {
 
     out << "#include <array>\n";
     out << "#include <cstring>  // for memcmp\n";
-    out << "#include <cfloat>   // Workaround for https://svn.boost.org/trac10/ticket/12642\n";
+    out << "#include <atomic>\n";
+    out << "#include <charconv>\n";
     out << "#include <iostream> // for cerr\n";
+    out << "#include <limits>\n";
     out << "#include <string_view>\n";
+    out << "#include <type_traits>\n";
 
-    out << "#include <boost/spirit/include/qi_real.hpp>\n";
-    out << "#include <boost/spirit/include/qi_int.hpp>\n";
     out << "#include <boost/version.hpp>\n";
-
-    out << R""(template <typename T>
-struct decimal_comma_real_policies : boost::spirit::qi::real_policies<T>
-{
-    template <typename Iterator> static bool parse_dot(Iterator& first, Iterator const& last)
-    {
-        if (first == last) {
-            return false;
-        }
-
-        const auto ch = *first;
-        if (ch != ',' && ch != '.') {
-            return false;
-        }
-
-        ++first;
-        return true;
+    if (m_config.cache) {
+      out << "#include \"zusi_parser/cache.hpp\"\n";
+      out << "namespace zusixml {\n";
+      out << "/** Identifies the generated types in snapshots of the parse cache; snapshots of other types are not read. */\n";
+      out << "constexpr uint64_t cache_schema = 0x" << std::hex << GetCacheSchema() << std::dec << "ULL;\n";
+      out << "}  // namespace zusixml\n";
     }
-};
 
-namespace zusixml {
+    out << R""(namespace zusixml {
 
-static void parse_string(const Ch*& text, std::string& result, Ch quote) {
+template<typename Allocator>
+static void parse_string(const Ch*& text, const Ch* end, std::basic_string<Ch, std::char_traits<Ch>, Allocator>& result, Ch quote) {
   const Ch* const value = text;
-  skip_attribute_value_pure(text, quote);
-  if (*text == quote) {
+  skip_attribute_value_pure(text, end, quote);
+  if (peek(text, end) == quote) {
     // No character refs in attribute value, copy the string verbatim
-    result = std::string(value, text - value);
-  } else if (*text == Ch('&')) {
+    result.assign(value, text - value);
+  } else if (peek(text, end) == Ch('&')) {
     const Ch* first_ampersand = text;
-    skip_attribute_value(text, quote);
+    skip_attribute_value(text, end, quote);
     result.resize(text - value);
     // Copy characters until the first ampersand verbatim, use copy_and_expand_character_refs for the rest.
     memcpy(&result[0], value, first_ampersand - value);
-    result.resize(first_ampersand - value + copy_and_expand_character_refs(first_ampersand, &result[first_ampersand - value], quote));
+    result.resize(first_ampersand - value + copy_and_expand_character_refs(first_ampersand, end, &result[first_ampersand - value], quote));
   }
-  // else: *text == '\0'
+  // else: end of data
 }
 
-static void parse_float(const Ch*& text, float& result) {
-  const Ch* text_save = text;
-  // Fast path for numbers of the form "-XXX.YYY" (enclosed in double quotes), where X and Y are both <= 7 characters long and the minus sign is optional
-  bool neg = false;
-  if (*text == Ch('-')) {
-    neg = true;
-    ++text;  // Skip "-"
-  }
-  const Ch* const integer_start = text;
-  for (size_t i = 0; i < 7; i++) {
-    if (!digit_pred::test(*text)) {
-      break;
+// Like parse_string, but result refers to the attribute value in the input instead of copying it.
+// Values with character references are expanded into a buffer that is reused for the next such value on this thread.
+static inline void parse_string(const Ch*& text, const Ch* end, std::string_view& result, Ch quote) {
+  const Ch* const value = text;
+  skip_attribute_value_pure(text, end, quote);
+  if (peek(text, end) == Ch('&')) {
+    static thread_local std::string buffer;
+    text = value;
+    parse_string(text, end, buffer, quote);
+    result = buffer;
+  } else {
+    result = std::string_view(value, text - value);
+  }
+}
+
+#if defined(ZUSIXML_INTERN)
+// Like parse_string, but stores the value only once in the current intern table (see intern_table::scope).
+static inline void parse_string_interned(const Ch*& text, const Ch* end, interned_string& result, Ch quote) {
+  std::string_view value;
+  parse_string(text, end, value, quote);
+  intern_table* table = intern_table::current();
+  result = (table ? *table : intern_table::shared()).intern(value);
+}
+#endif
+
+#if defined(ZUSIXML_STRING_VIEW)
+// Like parse_string, but result refers to the attribute value in the input instead of copying it.
+// Values with character references are expanded into the current arena, i.e. the one of the document being parsed.
+static inline void parse_string_in_document(const Ch*& text, const Ch* end, std::string_view& result, Ch quote) {
+  const Ch* const value = text;
+  skip_attribute_value_pure(text, end, quote);
+  if (peek(text, end) == Ch('&')) {
+    const Ch* first_ampersand = text;
+    skip_attribute_value(text, end, quote);
+    Ch* expanded = static_cast<Ch*>(arena::current().allocate(text - value, 1));
+    memcpy(expanded, value, first_ampersand - value);
+    result = std::string_view(expanded, first_ampersand - value + copy_and_expand_character_refs(first_ampersand, end, expanded + (first_ampersand - value), quote));
+  } else {
+    result = std::string_view(value, text - value);
+  }
+}
+#endif
+
+// Number of float values that parse_float could not convert on its fast path.
+inline std::atomic<size_t> float_slow_path_count { 0 };
+
+// Slow path of parse_float: special values (nan, inf) and numbers with more than 19 significant digits
+// that lie too close to the midpoint between two floats.
+static void parse_float_slow(const Ch*& text, const Ch* end, float& result) {
+  float_slow_path_count.fetch_add(1, std::memory_order_relaxed);
+
+  // Copy the number, using '.' as decimal separator and without leading '+', which from_chars does not accept.
+  const Ch* pos = text;
+  if (peek(pos, end) == Ch('+')) {
+    ++pos;
+  }
+  std::string number;
+  for (Ch ch; (ch = peek(pos, end)) != Ch('\0') && ch != Ch('"') && ch != Ch('\'') && !whitespace_pred::test(ch); ++pos) {
+    number.push_back(ch == Ch(',') ? Ch('.') : ch);
+  }
+
+#if defined(__cpp_lib_to_chars)
+  float value;
+  const auto [number_end, error] = std::from_chars(number.data(), number.data() + number.size(), value);
+  if (error == std::errc::invalid_argument) {
+    return;
+  }
+  if (error != std::errc::result_out_of_range) {
+    result = value;
+  }
+#else
+  // Note: strtof depends on the LC_NUMERIC locale
+  char* number_end;
+  const float value = std::strtof(number.c_str(), &number_end);
+  if (number_end == number.c_str()) {
+    return;
+  }
+  result = value;
+#endif
+  text = pos - (number.size() - (number_end - number.data()));
+}
+
+// Parses a float with optional sign, '.' or ',' as decimal separator and optional exponent,
+// rounding correctly to the nearest float. Like boost::spirit::qi::real_parser, which was used before,
+// text and result are left unchanged if there is no number.
+static void parse_float(const Ch*& text, const Ch* end, float& result) {
+  const Ch* pos = text;
+  const bool neg = (peek(pos, end) == Ch('-'));
+  if (neg || peek(pos, end) == Ch('+')) {
+    ++pos;
+  }
+
+  // Accumulate all digits into the significand; the exponent counts the fractional digits.
+  uint64_t significand = 0;
+  const Ch* const integer_start = pos;
+  while (digit_pred::test(peek(pos, end))) {
+    significand = significand * 10 + static_cast<uint64_t>(*pos - '0');
+    ++pos;
+  }
+  const Ch* const integer_end = pos;
+  const Ch* fraction_start = pos;
+  const Ch* fraction_end = pos;
+  if (peek(pos, end) == Ch('.') || peek(pos, end) == Ch(',')) {
+    ++pos;
+    fraction_start = pos;
+    while (digit_pred::test(peek(pos, end))) {
+      significand = significand * 10 + static_cast<uint64_t>(*pos - '0');
+      ++pos;
     }
-    ++text;
+    fraction_end = pos;
   }
-  const Ch* const dot_and_fractional_start = text;
-  if (*text == Ch('.')) {
-    ++text;  // skip "."
-    for (size_t i = 0; i < 7; i++) {
-      if (!digit_pred::test(*text)) {
-        break;
+  size_t digit_count = (integer_end - integer_start) + (fraction_end - fraction_start);
+  if (unlikely(digit_count == 0)) {
+    parse_float_slow(text, end, result);
+    return;
+  }
+
+  int64_t explicit_exponent = 0;
+  if ((peek(pos, end) | 0x20) == 'e') {
+    const Ch* exponent_pos = pos + 1;
+    const bool exponent_neg = (peek(exponent_pos, end) == Ch('-'));
+    if (exponent_neg || peek(exponent_pos, end) == Ch('+')) {
+      ++exponent_pos;
+    }
+    if (digit_pred::test(peek(exponent_pos, end))) {
+      while (digit_pred::test(peek(exponent_pos, end))) {
+        if (explicit_exponent < 0x10000) {
+          explicit_exponent = explicit_exponent * 10 + (*exponent_pos - '0');
+        }
+        ++exponent_pos;
+      }
+      if (exponent_neg) {
+        explicit_exponent = -explicit_exponent;
+      }
+      pos = exponent_pos;
+    }
+    // else: not an exponent, leave the 'e' unparsed
+  }
+  int64_t exponent = explicit_exponent - (fraction_end - fraction_start);
+
+  // More than 19 significant digits: keep the first 19 and remember that the value was truncated.
+  bool truncated = false;
+  if (unlikely(digit_count > 19)) {
+    for (const Ch* p = integer_start; p != fraction_end && (*p == '0' || p == integer_end); ++p) {
+      if (*p == '0') {
+        --digit_count;
+      }
+    }
+    if (digit_count > 19) {
+      truncated = true;
+      constexpr uint64_t min_19_digit_integer = 1000000000000000000;
+      significand = 0;
+      const Ch* p = integer_start;
+      while (significand < min_19_digit_integer && p != integer_end) {
+        significand = significand * 10 + static_cast<uint64_t>(*p - '0');
+        ++p;
+      }
+      if (significand >= min_19_digit_integer) {
+        exponent = (integer_end - p) + explicit_exponent;
+      } else {
+        p = fraction_start;
+        while (significand < min_19_digit_integer && p != fraction_end) {
+          significand = significand * 10 + static_cast<uint64_t>(*p - '0');
+          ++p;
+        }
+        exponent = (fraction_start - p) + explicit_exponent;
       }
-      ++text;
     }
   }
 
-  if (*text == Ch('"')) {
-    size_t len_integer = dot_and_fractional_start - integer_start;
-    size_t len_dot_and_fractional = text - dot_and_fractional_start;
-
-    uint32_t result_integer = 0;
-    switch(len_integer) {
-      case 7: result_integer += (*(integer_start + len_integer - 7) - '0') * 1000000; [[fallthrough]];
-      case 6: result_integer += (*(integer_start + len_integer - 6) - '0') * 100000; [[fallthrough]];
-      case 5: result_integer += (*(integer_start + len_integer - 5) - '0') * 10000; [[fallthrough]];
-      case 4: result_integer += (*(integer_start + len_integer - 4) - '0') * 1000; [[fallthrough]];
-      case 3: result_integer += (*(integer_start + len_integer - 3) - '0') * 100; [[fallthrough]];
-      case 2: result_integer += (*(integer_start + len_integer - 2) - '0') * 10; [[fallthrough]];
-      case 1: result_integer += (*(integer_start + len_integer - 1) - '0') * 1; [[fallthrough]];
-      case 0: break;
-    }
-
-    if (len_dot_and_fractional > 0) {
-      constexpr float scaleFactors[] = { 1E0, /* len_dot_and_fractional == 1 */ 1E0, /* == 2 etc. */ 1E1, 1E2, 1E3, 1E4, 1E5, 1E6, 1E7 };
-      uint32_t result_fractional = 0;
-      switch(len_dot_and_fractional - 1) {
-        case 7: result_fractional += (*(dot_and_fractional_start + len_dot_and_fractional - 7) - '0') * 1000000; [[fallthrough]];
-        case 6: result_fractional += (*(dot_and_fractional_start + len_dot_and_fractional - 6) - '0') * 100000; [[fallthrough]];
-        case 5: result_fractional += (*(dot_and_fractional_start + len_dot_and_fractional - 5) - '0') * 10000; [[fallthrough]];
-        case 4: result_fractional += (*(dot_and_fractional_start + len_dot_and_fractional - 4) - '0') * 1000; [[fallthrough]];
-        case 3: result_fractional += (*(dot_and_fractional_start + len_dot_and_fractional - 3) - '0') * 100; [[fallthrough]];
-        case 2: result_fractional += (*(dot_and_fractional_start + len_dot_and_fractional - 2) - '0') * 10; [[fallthrough]];
-        case 1: result_fractional += (*(dot_and_fractional_start + len_dot_and_fractional - 1) - '0') * 1; [[fallthrough]];
-        case 0: break;
-      }
-      result = result_integer + result_fractional / scaleFactors[len_dot_and_fractional];
-    } else {
-      result = result_integer;
+  float value;
+  if (likely(!truncated && exponent >= -10 && exponent <= 10 && significand <= (uint64_t(1) << 24))) {
+    // Both the significand and the power of ten are exact floats, so a single rounding step gives the correct result.
+    constexpr float powers_of_ten[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+    value = static_cast<float>(significand);
+    value = (exponent < 0) ? value / powers_of_ten[-exponent] : value * powers_of_ten[exponent];
+  } else {
+    const uint32_t bits = internal::decimal_to_float_bits(significand, exponent);
+    if (unlikely(truncated) && bits != internal::decimal_to_float_bits(significand + 1, exponent)) {
+      parse_float_slow(text, end, result);
+      return;
     }
-    if (neg) {
-      result = -result;
+    static_assert(sizeof(value) == sizeof(bits));
+    memcpy(&value, &bits, sizeof(value));
+  }
+  result = neg ? -value : value;
+  text = pos;
+}
+
+// Parses a decimal integer with optional sign, accepting the same input as boost::spirit::qi::int_parser<T>.
+// On overflow or if there are no digits, text and result are left unchanged.
+template<typename T>
+static bool parse_int(const Ch*& text, const Ch* end, T& result) {
+  static_assert(std::is_signed_v<T>);
+  using U = std::make_unsigned_t<T>;
+  const Ch* pos = text;
+  const bool neg = (peek(pos, end) == Ch('-'));
+  if (neg || peek(pos, end) == Ch('+')) {
+    ++pos;
+  }
+  const U limit = static_cast<U>(std::numeric_limits<T>::max()) + (neg ? 1 : 0);
+  const Ch* const digits_start = pos;
+  U value = 0;
+  while (digit_pred::test(peek(pos, end))) {
+    const U digit = static_cast<U>(*pos - '0');
+    if (unlikely(value > (limit - digit) / 10)) {
+      return false;
     }
-    return;
+    value = value * 10 + digit;
+    ++pos;
   }
+  if (unlikely(pos == digits_start)) {
+    return false;
+  }
+  result = neg ? static_cast<T>(U(0) - value) : static_cast<T>(value);
+  text = pos;
+  return true;
+}
 
-  // Slow path for everything else
-  text = text_save;
-  // std::cerr << "Delegating to slow float parser: " << std::string_view(text, 20) << "\n";
-  boost::spirit::qi::parse(text, static_cast<const char*>(nullptr), boost::spirit::qi::real_parser<float, decimal_comma_real_policies<float> >(), result);
+// Parses one to nine hexadecimal digits, accepting the same input as boost::spirit::qi::int_parser<uint32_t, 16, 1, 9>.
+// The 32 bit result is stored in @p result (uint32_t or int32_t).
+// On overflow or if there are no digits, text and result are left unchanged.
+template<typename T>
+static bool parse_hex(const Ch*& text, const Ch* end, T& result) {
+  static_assert(sizeof(T) == sizeof(uint32_t));
+  const Ch* pos = text;
+  uint64_t value = 0;
+  for (size_t i = 0; i < 9; i++, pos++) {
+    const unsigned char digit = internal::lookup_tables<0>::lookup_digits[static_cast<unsigned char>(peek(pos, end))];
+    if (digit > 0xF) {
+      break;
+    }
+    value = value * 16 + digit;
+  }
+  if (unlikely(pos == text || value > std::numeric_limits<uint32_t>::max())) {
+    return false;
+  }
+  result = static_cast<T>(static_cast<uint32_t>(value));
+  text = pos;
+  return true;
 }
 
-template<Ch Quote>
-static bool parse_datetime(const Ch*& text, struct tm& result) {
+// Result is zusixml::datetime (--compact-datetime) or struct tm, see set_date/set_time in zusi_parser/datetime.hpp.
+template<Ch Quote, typename Result>
+static bool parse_datetime(const Ch*& text, const Ch* end, Result& result) {
   // Delphi (and Zusi) accept a very wide range of things here,
   // e.g. two-digit years, times that don't specify seconds or minutes, etc.
   // We are more restrictive: we parse a date yyyy-mm-dd, or a time hh:nn:ss,
   // or both separated by a blank,
 
   const Ch* prev = text;
-  skip_max<digit_pred, 4>(text);
+  skip_max<digit_pred, 4>(text, end);
 
-  if (*text == Ch('-')) {
+  if (peek(text, end) == Ch('-')) {
     // date
     const size_t year_len = text - prev;
     int year = 0;
@@ -640,13 +1644,11 @@ static bool parse_datetime(const Ch*& text, struct tm& result) {
       default: return false;
     }
 
-    result.tm_year = year - 1900;
-
     ++text;
     prev = text;
-    skip_max<digit_pred, 2>(text);
+    skip_max<digit_pred, 2>(text, end);
 
-    if (*text != Ch('-')) {
+    if (peek(text, end) != Ch('-')) {
       return false;
     }
 
@@ -658,11 +1660,9 @@ static bool parse_datetime(const Ch*& text, struct tm& result) {
       default: return false;
     }
 
-    result.tm_mon = month;
-
     ++text;
     prev = text;
-    skip_max<digit_pred, 2>(text);
+    skip_max<digit_pred, 2>(text, end);
 
     const size_t day_len = text - prev;
     int day = 0;
@@ -672,18 +1672,18 @@ static bool parse_datetime(const Ch*& text, struct tm& result) {
       default: return false;
     }
 
-    result.tm_mday = day;
+    set_date(result, year, month, day);
 
-    if (*text == Quote) {
+    if (peek(text, end) == Quote) {
       return true;
-    } else if (*text == Ch(' ')) {
+    } else if (peek(text, end) == Ch(' ')) {
       ++text;
       prev = text;
-      skip_max<digit_pred, 2>(text);
+      skip_max<digit_pred, 2>(text, end);
     }
   }
 
-  if (*text == Ch(':')) {
+  if (peek(text, end) == Ch(':')) {
     const size_t hour_len = text - prev;
     int hour = 0;
     switch (hour_len) {
@@ -694,13 +1694,11 @@ static bool parse_datetime(const Ch*& text, struct tm& result) {
       default: return false;
     }
 
-    result.tm_hour = hour;
-
     ++text;
     prev = text;
-    skip_max<digit_pred, 2>(text);
+    skip_max<digit_pred, 2>(text, end);
 
-    if (*text != Ch(':')) {
+    if (peek(text, end) != Ch(':')) {
       return false;
     }
 
@@ -712,11 +1710,9 @@ static bool parse_datetime(const Ch*& text, struct tm& result) {
       default: return false;
     }
 
-    result.tm_min = minute;
-
     ++text;
     prev = text;
-    skip_max<digit_pred, 2>(text);
+    skip_max<digit_pred, 2>(text, end);
 
     const size_t second_len = text - prev;
     int second = 0;
@@ -726,12 +1722,23 @@ static bool parse_datetime(const Ch*& text, struct tm& result) {
       default: return false;
     }
 
-    result.tm_sec = second;
+    set_time(result, hour, minute, second);
   }
 
   return true;
 }
 
+// Perfect hash of an element or attribute name (name_size > 0), with Seed and Bits chosen by parsergen
+// per element type so that all known names of that type map to distinct values below 2^Bits.
+template<uint32_t Seed, unsigned Bits>
+static inline uint32_t name_hash(const Ch* name, size_t name_size) {
+  const uint32_t key = static_cast<uint32_t>(name_size & 0xFF)
+    | (static_cast<uint32_t>(static_cast<unsigned char>(name[0])) << 8)
+    | (static_cast<uint32_t>(static_cast<unsigned char>(name[name_size / 2])) << 16)
+    | (static_cast<uint32_t>(static_cast<unsigned char>(name[name_size - 1])) << 24);
+  return (key * Seed) >> (32 - Bits);
+}
+
 #define RAPIDXML_PARSE_ERROR(what, where) throw parse_error(what, where)
 
 [[noreturn]] static void parse_error_expected_semicolon(const Ch*& text) {
@@ -755,311 +1762,874 @@ static bool parse_datetime(const Ch*& text, struct tm& result) {
 
 )"";
 
-#ifdef ZUSIXML_SCHEMA_XML_MODE
-    out << R""(void expect(const char* expected, const char*& text) {
-  if (memcmp(text, expected, strlen(expected)) != 0) {
-    RAPIDXML_PARSE_ERROR("Wrong data type", text);
+#ifdef ZUSIXML_SCHEMA_XML_MODE
+    out << R""(void expect(const char* expected, const char*& text, const char* end) {
+  for (size_t i = 0; expected[i] != '\0'; i++) {
+    if (peek(text, end, i) != expected[i]) {
+      RAPIDXML_PARSE_ERROR("Wrong data type", text);
+    }
+  }
+  text += strlen(expected);
+}
+\n)"";
+#endif
+
+    for (const auto& elementType : m_element_types) {
+      if (m_used_element_types.find(elementType.get()) == std::end(m_used_element_types)) {
+        continue;
+      }
+      if (m_concrete_element_types.find(elementType.get()) == std::end(m_concrete_element_types)) {
+        continue;
+      }
+
+      GenerateParseFunction(out, *elementType, false);
+      if (m_config.reuse) {
+        GenerateClearFunction(out, *elementType);
+      }
+      if (m_config.cache) {
+        GenerateCacheFunctions(out, *elementType);
+      }
+    }
+    out << "}  // namespace zusixml\n";
+  }
+
+  void GenerateSaxParser(std::ostream& out) {
+    out << "#pragma once\n";
+    out << "#include \"zusi_parser/zusi_parser.hpp\"\n";
+    out << "#include <array>\n";
+    out << "#include <ctime>\n";
+    out << "#include <string_view>\n";
+    out << "#include <type_traits>\n";
+    out << "namespace zusixml::sax {\n";
+
+    std::vector<const ElementType*> elementTypes;
+    for (const auto& elementType : m_element_types) {
+      if (m_used_element_types.find(elementType.get()) != std::end(m_used_element_types)
+          && m_concrete_element_types.find(elementType.get()) != std::end(m_concrete_element_types)) {
+        elementTypes.push_back(elementType.get());
+      }
+    }
+
+    // Callbacks per element type, as pairs of name and parameter type
+    std::unordered_map<const ElementType*, std::vector<std::pair<std::string, std::string>>> callbacks;
+    for (const ElementType* elementType : elementTypes) {
+      auto& typeCallbacks = callbacks[elementType];
+      typeCallbacks.emplace_back("on_begin_" + elementType->name, "");
+      std::set<std::string> memberNames;
+      for (const auto& [curParent, attr] : GetAllAttributes(*elementType)) {
+        if (IsOnWhitelist(*curParent, attr) && memberNames.insert(GetAttributeMemberName(attr)).second) {
+          typeCallbacks.emplace_back("on_attr_" + elementType->name + "_" + GetAttributeMemberName(attr), GetSaxParameterType(attr));
+        }
+      }
+      typeCallbacks.emplace_back("on_end_" + elementType->name, "");
+    }
+
+    out << R""(
+/** Base class for handlers passed to sax::parse_root. For every element type T, it has the callbacks on_begin_T(),
+ * on_attr_T_A(value) for every attribute A, and on_end_T(), which do nothing. A handler derives from this class
+ * and declares the callbacks it needs with the same signature (no overloads). Attributes without a declared callback
+ * are skipped without converting their values, and elements without declared callbacks in their subtree are skipped entirely.
+ * String values point into the input or into a buffer that is reused for the next value; copy them to keep them. */
+struct default_handler {
+)"";
+    for (const ElementType* elementType : elementTypes) {
+      for (const auto& [name, parameterType] : callbacks[elementType]) {
+        out << "  void " << name << "(" << parameterType << ") {}\n";
+      }
+    }
+    out << "};\n\n";
+
+    out << "// True if the handler declares the callback itself instead of inheriting it from default_handler.\n";
+    out << "template<typename HandlerCallback, typename DefaultCallback>\n";
+    out << "inline constexpr bool overrides = !std::is_same_v<HandlerCallback, DefaultCallback>;\n\n";
+
+    out << "// uses_T: the handler declares a callback for element type T.\n";
+    for (const ElementType* elementType : elementTypes) {
+      out << "template<class Handler>\n";
+      out << "inline constexpr bool uses_" << elementType->name << " =";
+      const auto& typeCallbacks = callbacks[elementType];
+      for (size_t i = 0; i < typeCallbacks.size(); ++i) {
+        const std::string& name = typeCallbacks[i].first;
+        out << (i == 0 ? "\n    " : "\n    || ") << "overrides<decltype(&Handler::" << name << "), decltype(&default_handler::" << name << ")>";
+      }
+      out << ";\n";
+    }
+
+    // Child element types must come first, so sort the types in depth-first post-order.
+    std::vector<const ElementType*> elementTypesPostOrder;
+    std::unordered_set<const ElementType*> visited;
+    const std::function<void(const ElementType*)> visit = [&](const ElementType* elementType) {
+      if (!visited.insert(elementType).second) {
+        return;
+      }
+      for (const ElementType* childType : GetSaxChildTypes(*elementType)) {
+        visit(childType);
+      }
+      elementTypesPostOrder.push_back(elementType);
+    };
+    for (const ElementType* elementType : elementTypes) {
+      visit(elementType);
+    }
+
+    out << "\n// visits_T: the handler declares a callback for element type T or an element type that can occur inside it.\n";
+    for (const ElementType* elementType : elementTypesPostOrder) {
+      out << "template<class Handler>\n";
+      out << "inline constexpr bool visits_" << elementType->name << " = uses_" << elementType->name << "<Handler>";
+      for (const ElementType* childType : GetSaxChildTypes(*elementType)) {
+        out << "\n    || visits_" << childType->name << "<Handler>";
+      }
+      out << ";\n";
+    }
+    out << "\n";
+
+    for (const ElementType* elementType : elementTypes) {
+      out << "  template<class Handler>\n";
+      out << "  static void parse_element_" << elementType->name << "(const Ch *&, const Ch *, Handler*);\n";
+    }
+    for (const ElementType* elementType : elementTypes) {
+      GenerateParseFunction(out, *elementType, true);
+    }
+
+    out << R""(
+  //! Parses the XML data in [begin, end) like zusixml::parse_root, but instead of building a tree,
+  //! calls the callbacks of handler (see default_handler) for every element and attribute.
+  template<class Handler>
+  static void parse_root(const Ch *begin, const Ch *end, Handler& handler) {
+      static_assert(std::is_base_of_v<default_handler, Handler>, "SAX handlers must derive from zusixml::sax::default_handler");
+      parse_document(begin, end, [](const Ch *&text, const Ch *end, void* handlerUntyped) {
+          // Extract element name
+          const Ch *name = text;
+          skip<node_name_pred>(text, end);
+          if (text == name)
+              parse_error_expected_element_name(text);
+
+          // Skip whitespace between element name and attributes or >
+          skip<whitespace_pred>(text, end);
+          parse_element_Zusi(text, end, static_cast<Handler*>(handlerUntyped));
+      }, &handler);
+  }
+)"";
+    out << "}  // namespace zusixml::sax\n";
+  }
+
+  void ValidateWhitelist() {
+    for (const auto& [elementName, whitelistEntries] : m_config.whitelist) {
+      const auto it = std::find_if(m_element_types.begin(), m_element_types.end(),
+          [&elementName = elementName](const auto& elementTypePtr) { return elementTypePtr->name == elementName; });
+      if (it == m_element_types.end()) {
+        std::cerr << "Warning: Invalid whitelist entry: " << elementName << " is not an element type name.\n";
+        continue;
+      }
+      for (const auto& entry : whitelistEntries) {
+        const auto& children = (*it)->children;
+        const auto itChild = std::find_if(children.begin(), children.end(),
+            [&entry](const auto& child) { return child.name == entry; });
+
+        const auto& attrs = (*it)->attributes;
+        const auto itAttr = std::find_if(attrs.begin(), attrs.end(),
+            [&entry](const auto& attr) { return attr.name == entry; });
+
+        if ((itChild == children.end()) && (itAttr == attrs.end())) {
+          std::cerr << "Warning: Invalid whitelist entry: " << entry << " is not a child or attribute of " << elementName << "\n";
+          continue;
+        }
+
+        std::cout << "Whitelist entry: " << elementName << "::" << entry << "\n";
+      }
+    }
+  }
+
+  void ValidateLazy() {
+    ValidateMemberList(m_config.lazy, "lazy", "a child", [](const ElementType& type, const std::string& name) {
+      return FindChild(type, name) != nullptr;
+    });
+  }
+
+  void ValidateSoa() {
+    ValidateMemberList(m_config.soa, "soa", "a repeated child", [this](const ElementType& type, const std::string& name) {
+      const Child* child = FindChild(type, name);
+      if (child == nullptr || !child->multiple || child->type == &type) {
+        return false;
+      }
+      if (IsLazy(type, *child)) {
+        std::cerr << "Warning: Ignoring soa entry " << type.name << "::" << name << ", which is lazy\n";
+      }
+      return true;
+    });
+  }
+
+  void ValidateReserve() {
+    ValidateMemberList(m_config.reserve, "reserve", "a repeated child", [](const ElementType& type, const std::string& name) {
+      const Child* child = FindChild(type, name);
+      return child != nullptr && child->multiple;
+    });
+  }
+
+  void ValidateIntern() {
+    ValidateMemberList(m_config.intern, "intern", "a string attribute", [](const ElementType& type, const std::string& name) {
+      return std::any_of(type.attributes.begin(), type.attributes.end(), [&name](const auto& attr) {
+        return attr.name == name && attr.type == AttributeType::String; });
+    });
+  }
+
+  /** Prints the layouts chosen by --layout-profile that differ from the default, and the expected
+   * bytes and allocations per document. Call after GenerateTypeDefinitions. */
+  void PrintLayoutReport(std::ostream& out) const {
+    const double documents = m_config.layout_profile.documents;
+    LayoutCost defaultTotal;
+    LayoutCost total;
+    out << "Layout profile (" << m_config.layout_profile.documents << " documents), per document:\n";
+    for (const auto& choice : m_child_layout_choices) {
+      defaultTotal.bytes += choice.defaultCost.bytes / documents;
+      defaultTotal.allocations += choice.defaultCost.allocations / documents;
+      total.bytes += choice.cost.bytes / documents;
+      total.allocations += choice.cost.allocations / documents;
+      if (choice.layout == choice.defaultLayout) {
+        continue;
+      }
+      out << "  " << choice.parentType->name << "::" << choice.child.name << ": "
+          << choice.defaultLayout.ToString(choice.child.multiple) << " -> " << choice.layout.ToString(choice.child.multiple) << ", "
+          << static_cast<size_t>(choice.defaultCost.bytes / documents) << " -> " << static_cast<size_t>(choice.cost.bytes / documents) << " bytes, "
+          << static_cast<size_t>(choice.defaultCost.allocations / documents) << " -> " << static_cast<size_t>(choice.cost.allocations / documents) << " allocations\n";
+    }
+    out << "  Total for " << m_child_layout_choices.size() << " profiled children: "
+        << static_cast<size_t>(defaultTotal.bytes) << " -> " << static_cast<size_t>(total.bytes) << " bytes, "
+        << static_cast<size_t>(defaultTotal.allocations) << " -> " << static_cast<size_t>(total.allocations) << " allocations\n";
+
+    // Assumes that the sparse attributes of a type occur in different elements, i.e. at most one allocation per attribute.
+    for (const auto& choice : m_sparse_attribute_report) {
+      double elements = 0;
+      double presence = 0;
+      out << "  " << choice.elementType->name << " sparse attributes:";
+      for (const Attribute* attr : choice.attributes) {
+        const std::string name = choice.elementType->name + "@" + attr->name;
+        elements = m_config.layout_profile.attributes.at(name).Parents() / documents;
+        presence += m_config.layout_profile.AttributePresence(name);
+        out << " " << attr->name;
+      }
+      presence = std::min(presence, 1.0);
+      out << ", " << static_cast<size_t>(elements * choice.memberBytes) << " -> at most "
+          << static_cast<size_t>(elements * (sizeof(void*) + presence * choice.blockSize)) << " bytes, "
+          << "0 -> at most " << static_cast<size_t>(elements * presence) << " allocations\n";
+    }
+  }
+
+  void ValidateLayoutProfile() {
+    for (const auto& [name, profile] : m_config.layout_profile.children) {
+      const auto colon_pos = name.find("::");
+      const std::string elementName = name.substr(0, colon_pos);
+      const std::string childName = name.substr(colon_pos + 2);
+      const auto it = std::find_if(m_element_types.begin(), m_element_types.end(),
+          [&elementName](const auto& elementTypePtr) { return elementTypePtr->name == elementName; });
+      if (it == m_element_types.end()) {
+        std::cerr << "Warning: Invalid layout profile entry: " << elementName << " is not an element type name.\n";
+        continue;
+      }
+      const auto& children = (*it)->children;
+      if (std::none_of(children.begin(), children.end(), [&childName](const auto& child) { return child.name == childName; })) {
+        std::cerr << "Warning: Invalid layout profile entry: " << childName << " is not a child of " << elementName << "\n";
+      }
+    }
+    for (const auto& [name, profile] : m_config.layout_profile.attributes) {
+      const auto at_pos = name.find('@');
+      const std::string elementName = name.substr(0, at_pos);
+      const std::string attributeName = name.substr(at_pos + 1);
+      const auto it = std::find_if(m_element_types.begin(), m_element_types.end(),
+          [&elementName](const auto& elementTypePtr) { return elementTypePtr->name == elementName; });
+      if (it == m_element_types.end()) {
+        std::cerr << "Warning: Invalid layout profile entry: " << elementName << " is not an element type name.\n";
+        continue;
+      }
+      const auto& attributes = (*it)->attributes;
+      if (std::none_of(attributes.begin(), attributes.end(), [&attributeName](const auto& attr) { return attr.name == attributeName; })) {
+        std::cerr << "Warning: Invalid layout profile entry: " << attributeName << " is not an attribute of " << elementName << "\n";
+      }
+    }
+  }
+
+  /** Adds the number of children of every element and whether it has each of its attributes
+   * in the XML file @p fileName to @p profile (option --write-layout-profile).
+   * The root element must be a Zusi element. Elements and attributes not in the schema are ignored. */
+  bool ProfileDocument(const std::string& fileName, LayoutProfile* profile) const {
+    pugi::xml_document doc;
+    if (!doc.load_file(fileName.c_str())) {
+      std::cerr << "Cannot parse " << fileName << "\n";
+      return false;
+    }
+    const auto rootIt = std::find_if(m_element_types.begin(), m_element_types.end(),
+        [](const auto& elementTypePtr) { return elementTypePtr->name == "Zusi"; });
+    const pugi::xml_node root = doc.document_element();
+    if (rootIt == m_element_types.end() || std::string(root.name()) != "Zusi") {
+      std::cerr << fileName << ": Root element is not Zusi\n";
+      return false;
+    }
+
+    // Per element type, the histograms of all children and attributes including inherited ones,
+    // in the order of GetAllChildren and GetAllAttributes.
+    struct ChildHistograms {
+      bool initialized { false };
+      std::vector<std::pair<const ElementType*, Child>> allChildren;
+      std::vector<std::map<size_t, size_t>> histograms;
+      std::vector<std::pair<const ElementType*, Attribute>> allAttributes;
+      std::vector<std::map<size_t, size_t>> attributeHistograms;
+    };
+    std::unordered_map<const ElementType*, ChildHistograms> histogramsByType;
+    std::function<void(const pugi::xml_node&, const ElementType&)> visit = [&](const pugi::xml_node& node, const ElementType& elementType) {
+      auto& childHistograms = histogramsByType[&elementType];  // references into the map stay valid in recursive calls
+      if (!childHistograms.initialized) {
+        childHistograms.allChildren = GetAllChildren(elementType);
+        childHistograms.histograms.resize(childHistograms.allChildren.size());
+        childHistograms.allAttributes = GetAllAttributes(elementType);
+        childHistograms.attributeHistograms.resize(childHistograms.allAttributes.size());
+        childHistograms.initialized = true;
+      }
+      for (size_t i = 0; i < childHistograms.allAttributes.size(); i++) {
+        childHistograms.attributeHistograms[i][node.attribute(childHistograms.allAttributes[i].second.name.c_str()) ? 1 : 0]++;
+      }
+      const auto& allChildren = childHistograms.allChildren;
+      std::vector<size_t> counts(allChildren.size());
+      for (const pugi::xml_node& childNode : node.children()) {
+        const auto it = std::find_if(allChildren.begin(), allChildren.end(),
+            [name = childNode.name()](const auto& parentAndChild) { return parentAndChild.second.name == name; });
+        if (it != allChildren.end()) {
+          counts[it - allChildren.begin()]++;
+          visit(childNode, *it->second.type);
+        }
+      }
+      for (size_t i = 0; i < counts.size(); i++) {
+        childHistograms.histograms[i][counts[i]]++;
+      }
+    };
+    visit(root, **rootIt);
+
+    for (const auto& [elementType, childHistograms] : histogramsByType) {
+      for (size_t i = 0; i < childHistograms.allChildren.size(); i++) {
+        const auto& [declaringType, child] = childHistograms.allChildren[i];
+        auto& histogram = profile->children[declaringType->name + "::" + child.name].histogram;
+        for (const auto& [count, parents] : childHistograms.histograms[i]) {
+          histogram[count] += parents;
+        }
+      }
+      for (size_t i = 0; i < childHistograms.allAttributes.size(); i++) {
+        const auto& [declaringType, attr] = childHistograms.allAttributes[i];
+        auto& histogram = profile->attributes[declaringType->name + "@" + attr.name].histogram;
+        for (const auto& [present, elements] : childHistograms.attributeHistograms[i]) {
+          histogram[present] += elements;
+        }
+      }
+    }
+    profile->documents++;
+    return true;
+  }
+
+ private:
+  const std::vector<std::unique_ptr<ElementType>> m_element_types;
+  Config m_config;
+  const std::unordered_set<const ElementType*> m_used_element_types;
+  const std::unordered_set<const ElementType*> m_concrete_element_types;
+  std::unordered_map<const ElementType*, TypeLayout> m_element_type_layouts;
+  // Names of the members of each generated struct including those of its base classes, in declaration order.
+  std::unordered_map<const ElementType*, std::vector<std::string>> m_element_type_member_names;
+
+  /** Declaration of a member of a generated struct, for ordering the members. */
+  struct Member {
+    std::string name;
+    std::string declaration;
+    TypeLayout layout;
+    bool child;
+    double hotness;  // children: fraction of parents in the layout profile that contain the child
+  };
+
+  struct TypeLayoutReportEntry {
+    const ElementType* elementType;
+    TypeLayout layout;
+    size_t members;
+    size_t memberBytes;
+    size_t padding;
+  };
+  std::vector<TypeLayoutReportEntry> m_type_layout_report;
+
+  /** Attributes of an element type moved into zusixml::sparse_attributes by --sparse-attributes, for the report. */
+  struct SparseAttributeChoice {
+    const ElementType* elementType;
+    std::vector<const Attribute*> attributes;
+    size_t memberBytes;  // bytes of the attributes as members of the element
+    size_t blockSize;  // bytes allocated per element that has one of the attributes
+  };
+  std::vector<SparseAttributeChoice> m_sparse_attribute_report;
+
+  /** Layout of a child chosen by --layout-profile, with the expected cost per corpus, for the report. */
+  struct ChildLayoutChoice {
+    const ElementType* parentType;
+    Child child;
+    ChildLayout defaultLayout;
+    ChildLayout layout;
+    LayoutCost defaultCost;
+    LayoutCost cost;
+  };
+  std::map<std::pair<const ElementType*, std::string>, ChildLayout> m_child_layouts;
+  std::vector<ChildLayoutChoice> m_child_layout_choices;
+
+  /** Generates the function that parses an element of type @p elementType into a struct of that type,
+   * or, if @p sax is set, the function template that calls the callbacks of a SAX handler instead. */
+  /** Generates clear_element_T, which resets the element pointed to by value to the state of a new element
+   * while keeping the capacity of its strings and vectors and returning its child elements to zusixml::element_pool (option --reuse). */
+  void GenerateClearFunction(std::ostream& out, const ElementType& elementType) const {
+    // Unused for children that are only stored inline in vectors or as zusixml::lazy.
+    out << "[[maybe_unused]] static void clear_element_" << elementType.name << "(" << elementType.cppName << "* value) {\n";
+    if (elementType.name == "Vec2" || elementType.name == "Vec3" || elementType.name == "Quaternion") {
+      out << "  *value = {};\n";
+      out << "}\n\n";
+      return;
+    }
+    out << "  (void)value;\n";
+    for (const ElementType* curElementType = &elementType; curElementType != nullptr; curElementType = curElementType->base) {
+      const auto sparseAttributes = GetSparseAttributes(*curElementType);
+      for (const auto& attr : curElementType->attributes) {
+        if (!IsOnWhitelist(*curElementType, attr)
+            || std::find(sparseAttributes.begin(), sparseAttributes.end(), &attr) != sparseAttributes.end()) {
+          continue;
+        }
+        if (attr.type == AttributeType::String) {
+          out << "  value->" << attr.name << ".clear();\n";
+        } else {
+          out << "  value->" << attr.name << " = {};\n";
+        }
+      }
+      if (!sparseAttributes.empty()) {
+        out << "  value->" << (curElementType == &elementType ? "" : curElementType->name + "::") << "sparse_attributes = {};\n";
+      }
+    }
+    for (const auto& [curParent, child] : GetAllChildren(elementType)) {
+      if (IsOnWhitelist(*curParent, child)) {
+        out << GetChildStrategy(*curParent, child)->GetClearMemberCode(*curParent, child);
+      }
+    }
+    out << "}\n\n";
+  }
+
+  /** Generates write_element_T and read_element_T, which write the element pointed to by value to a snapshot
+   * of the parse cache and read it back into a new element (option --cache). Both visit the attributes from the
+   * most derived type to the base types, then the children. */
+  void GenerateCacheFunctions(std::ostream& out, const ElementType& elementType) const {
+    std::ostringstream write, read;
+    write << "[[maybe_unused]] static void write_element_" << elementType.name << "(cache::writer& out, const " << elementType.cppName << "* value) {\n";
+    read << "[[maybe_unused]] static void read_element_" << elementType.name << "(cache::reader& in, " << elementType.cppName << "* value) {\n";
+    if (elementType.name == "Vec2" || elementType.name == "Vec3" || elementType.name == "Quaternion") {
+      write << "  out.put(*value);\n";
+      read << "  in.get(*value);\n";
+    } else {
+      write << "  (void)out;\n  (void)value;\n";
+      read << "  (void)in;\n  (void)value;\n";
+      for (const ElementType* curElementType = &elementType; curElementType != nullptr; curElementType = curElementType->base) {
+        for (const auto& attr : curElementType->attributes) {
+          if (!IsOnWhitelist(*curElementType, attr)) {
+            continue;
+          }
+          const std::string member = "value->" + (curElementType == &elementType ? "" : curElementType->name + "::") + attr.name;
+          write << "  out.put(" << member << ");\n";
+          read << "  in.get(" << member << ");\n";
+        }
+      }
+      for (const auto& [curParent, child] : GetAllChildren(elementType)) {
+        if (IsOnWhitelist(*curParent, child)) {
+          const auto childStrategy = GetChildStrategy(*curParent, child);
+          write << childStrategy->GetWriteMemberCode(*curParent, child);
+          read << childStrategy->GetReadMemberCode(*curParent, child);
+        }
+      }
+    }
+    out << write.str() << "}\n\n" << read.str() << "}\n\n";
   }
-  text += strlen(expected);
-}
-\n)"";
-#endif
 
+  /** Returns a hash (FNV-1a) of the members of all generated types as written by GenerateCacheFunctions,
+   * so that snapshots written by a parser generated with other types or options are not read. */
+  uint64_t GetCacheSchema() const {
+    std::ostringstream schema;
+    schema << "cache 1\n";
     for (const auto& elementType : m_element_types) {
-      if (m_used_element_types.find(elementType.get()) == std::end(m_used_element_types)) {
+      if (m_used_element_types.find(elementType.get()) == std::end(m_used_element_types)
+          || m_concrete_element_types.find(elementType.get()) == std::end(m_concrete_element_types)) {
         continue;
       }
-      if (m_concrete_element_types.find(elementType.get()) == std::end(m_concrete_element_types)) {
-        continue;
+      schema << elementType->name << "\n";
+      for (const ElementType* curElementType = elementType.get(); curElementType != nullptr; curElementType = curElementType->base) {
+        for (const auto& attr : curElementType->attributes) {
+          if (IsOnWhitelist(*curElementType, attr)) {
+            TypeLayout layout;
+            schema << " " << attr.name << ":" << GetAttributeType(*curElementType, attr, &layout) << "\n";
+          }
+        }
+      }
+      for (const auto& [curParent, child] : GetAllChildren(*elementType)) {
+        if (IsOnWhitelist(*curParent, child)) {
+          schema << GetChildStrategy(*curParent, child)->GetMemberDeclaration(*curParent, child);
+        }
       }
+    }
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned char c : schema.str()) {
+      hash = (hash ^ c) * 0x100000001b3ULL;
+    }
+    return hash;
+  }
 
-      auto allChildren = GetAllChildren(*elementType);
-      auto allAttributes = GetAllAttributes(*elementType);
+  void GenerateParseFunction(std::ostream& out, const ElementType& elementType, bool sax) const {
+    auto allChildren = GetAllChildren(elementType);
+    auto allAttributes = GetAllAttributes(elementType);
 
-      std::ostringstream parse_children;
-      parse_children << "if (false) { (void)parseResult; }\n";
+    // Variable holding the struct to fill or the handler to call, and its type
+    const std::string result = sax ? "handler" : "parseResult";
+    const std::string resultType = sax ? "Handler" : elementType.cppName;
 
-      for (const auto& [curParent, child] : allChildren) {
-        if (!IsOnWhitelist(*curParent, child) && m_config.ignore_unknown) {
-          continue;
-        }
+    std::ostringstream parse_children;
+    parse_children << "if (false) { (void)" << result << "; }\n";
 
-        parse_children << "            else if (name_size == " << child.name.size() << " && !memcmp(name, \"" << child.name << "\", " << child.name.size() << ")) {\n";
-        if (!IsOnWhitelist(*curParent, child)) {
-          if (child.deprecated()) {
-            parse_children << "                // deprecated\n";
-          }
-          parse_children << "                skip_element(text);\n";
-          parse_children << "            }\n";
-          continue;
+    std::vector<std::pair<std::string, std::string>> child_branches;
+    for (const auto& [curParent, child] : allChildren) {
+      if (!IsOnWhitelist(*curParent, child) && m_config.ignore_unknown) {
+        continue;
+      }
+
+      std::ostringstream branch;
+      if (!IsOnWhitelist(*curParent, child)) {
+        if (child.deprecated()) {
+          branch << "                // deprecated\n";
         }
-        parse_children << "                " << GetChildStrategy(*curParent, child)->GetParseMemberCode(*curParent, child);
-        parse_children << "            }\n";
+        branch << "                skip_element(text, end);\n";
+      } else if (sax) {
+        // Skip the whole subtree if the handler has no callbacks for it.
+        branch << "                if constexpr (visits_" << child.type->name << "<Handler>) {\n";
+        branch << "                  parse_element_" << child.type->name << "(text, end, handler);\n";
+        branch << "                } else {\n";
+        branch << "                  skip_element(text, end);\n";
+        branch << "                }\n";
+      } else {
+        branch << "                " << GetChildStrategy(*curParent, child)->GetParseMemberCode(*curParent, child);
       }
+      child_branches.emplace_back(child.name, branch.str());
+    }
 
-      parse_children << "            else {\n";
-      if (!m_config.ignore_unknown) {
-        parse_children << "              std::cerr << \"Unexpected child of node " << elementType->name << ": '\" << std::string_view(name, name_size) << \"'\\n\";\n";
+    // Count the reserved children before parsing them, so that their containers are allocated only once.
+    std::ostringstream reserve_children;
+    std::vector<std::pair<const ElementType*, const Child*>> reservedChildren;
+    if (!sax) {
+      for (const auto& [curParent, child] : allChildren) {
+        if (IsReserved(*curParent, child) && IsOnWhitelist(*curParent, child)) {
+          reservedChildren.emplace_back(curParent, &child);
+        }
       }
-      parse_children << "              skip_element(text);\n";
-      parse_children << "            }\n";
+    }
+    if (!reservedChildren.empty()) {
+      reserve_children << "          {\n";
+      std::ostringstream names, nameSizes;
+      for (size_t i = 0; i < reservedChildren.size(); i++) {
+        names << (i > 0 ? ", " : "") << "\"" << reservedChildren[i].second->name << "\"";
+        nameSizes << (i > 0 ? ", " : "") << reservedChildren[i].second->name.size();
+      }
+      reserve_children << "              static const Ch *const reserve_names[] = { " << names.str() << " };\n";
+      reserve_children << "              static const size_t reserve_name_sizes[] = { " << nameSizes.str() << " };\n";
+      reserve_children << "              size_t reserve_counts[" << reservedChildren.size() << "] = {};\n";
+      reserve_children << "              if (count_child_elements(text, end, reserve_names, reserve_name_sizes, reserve_counts, " << reservedChildren.size() << ")) {\n";
+      for (size_t i = 0; i < reservedChildren.size(); i++) {
+        const Child& child = *reservedChildren[i].second;
+        const std::string member = "parseResult->children_" + child.name;
+        // StrElement and ReferenzElement are stored at the index given by their number, which starts at 1.
+        const bool indexed = (child.type->name == "StrElement" || child.type->name == "ReferenzElement") && !IsLazy(*reservedChildren[i].first, child);
+        reserve_children << "                  " << member << ".reserve(" << member << ".size() + reserve_counts[" << i << "]" << (indexed ? " + 1" : "") << ");\n";
+      }
+      reserve_children << "              }\n";
+      reserve_children << "          }\n";
+    }
 
-      // Generate attribute parsing code
-      std::ostringstream parse_attributes;
+    std::ostringstream unknown_child;
+    if (!m_config.ignore_unknown) {
+      unknown_child << "              std::cerr << \"Unexpected child of node " << elementType.name << ": '\" << std::string_view(name, name_size) << \"'\\n\";\n";
+    }
+    unknown_child << "              skip_element(text, end);\n";
+    GenerateNameDispatch(parse_children, child_branches, unknown_child.str(), "unknown_child", "            ");
 
-      bool startWhitespaceSkip = std::none_of(std::begin(allAttributes), std::end(allAttributes), [](const auto& attr) {
-          return attr.second.type == AttributeType::String || attr.second.type == AttributeType::FaceIndexes;
-      });
-      if (startWhitespaceSkip) {
-        parse_attributes << "        skip_unlikely<whitespace_pred>(text);\n";
-      }
+    // Generate attribute parsing code
+    std::ostringstream parse_attributes;
+
+    bool startWhitespaceSkip = std::none_of(std::begin(allAttributes), std::end(allAttributes), [](const auto& attr) {
+        return attr.second.type == AttributeType::String || attr.second.type == AttributeType::FaceIndexes;
+    });
+    if (startWhitespaceSkip) {
+      parse_attributes << "        skip_unlikely<whitespace_pred>(text, end);\n";
+    }
 
-      parse_attributes << "        if (false) { (void)parseResult; }\n";
+    parse_attributes << "        if (false) { (void)" << result << "; }\n";
 
 #ifndef ZUSIXML_SCHEMA_XML_MODE
-      // Special treatment for types with WXYZ as attributes
-      if (elementType->name == "Vec2") {
-        parse_attributes << "        if (name_size == 1 && *name >= 'X' && *name <= 'Y') {\n";
-        if (m_config.use_glm) {
-          parse_attributes << "          std::array<float Vec2::*, 2> members = {{ &Vec2::x, &Vec2::y }};\n";
-        } else {
-          parse_attributes << "          std::array<float Vec2::*, 2> members = {{ &Vec2::X, &Vec2::Y }};\n";
-        }
-        parse_attributes << R""(          parse_float(text, parseResult->*members[*name - 'X']);
-          skip_unlikely<whitespace_pred>(text);
-        })"" << "\n";
-        allAttributes.clear();
-      } else if (elementType->name == "Vec3") {
-        parse_attributes << "        if (name_size == 1 && *name >= 'X' && *name <= 'Z') {\n";
-        if (m_config.use_glm) {
-          parse_attributes << "          std::array<float Vec3::*, 3> members = {{ &Vec3::x, &Vec3::y, &Vec3::z }};\n";
-        } else {
-          parse_attributes << "          std::array<float Vec3::*, 3> members = {{ &Vec3::X, &Vec3::Y, &Vec3::Z }};\n";;
-        }
-        parse_attributes << R""(          parse_float(text, parseResult->*members[*name - 'X']);
-          skip_unlikely<whitespace_pred>(text);
+    // Special treatment for types with WXYZ as attributes
+    if (sax) {
+      // SAX handlers get a callback per attribute
+    } else if (elementType.name == "Vec2") {
+      parse_attributes << "        if (name_size == 1 && *name >= 'X' && *name <= 'Y') {\n";
+      if (m_config.use_glm) {
+        parse_attributes << "          std::array<float Vec2::*, 2> members = {{ &Vec2::x, &Vec2::y }};\n";
+      } else {
+        parse_attributes << "          std::array<float Vec2::*, 2> members = {{ &Vec2::X, &Vec2::Y }};\n";
+      }
+      parse_attributes << R""(          parse_float(text, end, parseResult->*members[*name - 'X']);
+          skip_unlikely<whitespace_pred>(text, end);
         })"" << "\n";
-        allAttributes.clear();
-      } else if (elementType->name == "Quaternion") {
-        parse_attributes << "        if (name_size == 1 && *name >= 'W' && *name <= 'Z') {\n";
-        if (m_config.use_glm) {
-          parse_attributes << "          std::array<float Quaternion::*, 4> members = {{ &Quaternion::w, &Quaternion::x, &Quaternion::y, &Quaternion::z }};\n";
-        } else {
-          parse_attributes << "          std::array<float Quaternion::*, 4> members = {{ &Quaternion::W, &Quaternion::X, &Quaternion::Y, &Quaternion::Z }};\n";
-        }
-        parse_attributes << R""(          parse_float(text, parseResult->*members[*name - 'W']);
-          skip_unlikely<whitespace_pred>(text);
+      allAttributes.clear();
+    } else if (elementType.name == "Vec3") {
+      parse_attributes << "        if (name_size == 1 && *name >= 'X' && *name <= 'Z') {\n";
+      if (m_config.use_glm) {
+        parse_attributes << "          std::array<float Vec3::*, 3> members = {{ &Vec3::x, &Vec3::y, &Vec3::z }};\n";
+      } else {
+        parse_attributes << "          std::array<float Vec3::*, 3> members = {{ &Vec3::X, &Vec3::Y, &Vec3::Z }};\n";;
+      }
+      parse_attributes << R""(          parse_float(text, end, parseResult->*members[*name - 'X']);
+          skip_unlikely<whitespace_pred>(text, end);
         })"" << "\n";
-        allAttributes.clear();
+      allAttributes.clear();
+    } else if (elementType.name == "Quaternion") {
+      parse_attributes << "        if (name_size == 1 && *name >= 'W' && *name <= 'Z') {\n";
+      if (m_config.use_glm) {
+        parse_attributes << "          std::array<float Quaternion::*, 4> members = {{ &Quaternion::w, &Quaternion::x, &Quaternion::y, &Quaternion::z }};\n";
+      } else {
+        parse_attributes << "          std::array<float Quaternion::*, 4> members = {{ &Quaternion::W, &Quaternion::X, &Quaternion::Y, &Quaternion::Z }};\n";
       }
+      parse_attributes << R""(          parse_float(text, end, parseResult->*members[*name - 'W']);
+          skip_unlikely<whitespace_pred>(text, end);
+        })"" << "\n";
+      allAttributes.clear();
+    }
 #endif
 
-      for (const auto& [curParent, attr] : allAttributes) {
-        if (!IsOnWhitelist(*curParent, attr) && m_config.ignore_unknown) {
-          continue;
-        }
+    std::vector<std::pair<std::string, std::string>> attribute_branches;
+    for (const auto& [curParent, attr] : allAttributes) {
+      if (!IsOnWhitelist(*curParent, attr) && m_config.ignore_unknown) {
+        continue;
+      }
 
-        parse_attributes << "        else if (name_size == " << attr.name.size() << " && !memcmp(name, \"" << attr.name << "\", " << attr.name.size() << ")) {\n";
+      std::ostringstream branch;
 
-        // Skip deprecated attributes and attributes that are not on the whitelist.
-        if (!IsOnWhitelist(*curParent, attr)) {
-          if (attr.deprecated()) {
-            parse_attributes << "          // deprecated\n";
-          }
-          parse_attributes << "          skip_attribute_value(text, quote);\n";
-          parse_attributes << "        }\n";
-          continue;
-        } else if ((attr.name == "C" || attr.name == "CA" || attr.name == "E")) {
-          // Convert deprecated old form of color attributes to new form.
-          if (!startWhitespaceSkip) {
-            parse_attributes << "          skip_unlikely<whitespace_pred>(text);\n";
-          }
-          parse_attributes << "          uint32_t tmp;\n";
-          parse_attributes << "          boost::spirit::qi::parse(text, static_cast<const char*>(nullptr), boost::spirit::qi::int_parser<uint32_t, 16, 1, 9>(), tmp);\n";
-          parse_attributes << "          parseResult->";
-          if (attr.name == "C") {
-            parse_attributes << "Cd";
-          } else if (attr.name == "CA") {
-            parse_attributes << "Ca";
-          } else if (attr.name == "E") {
-            parse_attributes << "Ce";
-          }
-          parse_attributes << " = ArgbColor { static_cast<uint8_t>((tmp >> 24) & 0xFF), static_cast<uint8_t>(tmp & 0xFF), static_cast<uint8_t>((tmp >> 8) & 0xFF), static_cast<uint8_t>((tmp >> 16) & 0xFF) };\n";
-          parse_attributes << "          skip_unlikely<whitespace_pred>(text);\n";
-          parse_attributes << "        }\n";
-          continue;
+      // In SAX mode, the value is parsed into a local variable and passed to the callback,
+      // unless the handler does not declare the callback: then the value is skipped without converting it.
+      const std::string target = sax ? "value" : GetAttributeTarget(elementType, *curParent, attr);
+      const auto add_branch = [&, &attr = attr]() {
+        if (!sax) {
+          attribute_branches.emplace_back(attr.name, branch.str());
+          return;
+        }
+        const std::string callback = "on_attr_" + elementType.name + "_" + GetAttributeMemberName(attr);
+        std::ostringstream saxBranch;
+        saxBranch << "          if constexpr (overrides<decltype(&Handler::" << callback << "), decltype(&default_handler::" << callback << ")>) {\n";
+        saxBranch << "            " << GetSaxValueType(attr) << " value {};\n";
+        saxBranch << IndentCode(branch.str(), "  ");
+        saxBranch << "            handler->" << callback << "(value);\n";
+        saxBranch << "          } else {\n";
+        saxBranch << "            skip_attribute_value(text, end, quote);\n";
+        saxBranch << "          }\n";
+        attribute_branches.emplace_back(attr.name, saxBranch.str());
+      };
+
+      // Skip deprecated attributes and attributes that are not on the whitelist.
+      if (!IsOnWhitelist(*curParent, attr)) {
+        if (attr.deprecated()) {
+          branch << "          // deprecated\n";
         }
+        branch << "          skip_attribute_value(text, end, quote);\n";
+        attribute_branches.emplace_back(attr.name, branch.str());
+        continue;
+      } else if ((attr.name == "C" || attr.name == "CA" || attr.name == "E")) {
+        // Convert deprecated old form of color attributes to new form.
+        if (!startWhitespaceSkip) {
+          branch << "          skip_unlikely<whitespace_pred>(text, end);\n";
+        }
+        branch << "          uint32_t tmp = 0;\n";
+        branch << "          parse_hex(text, end, tmp);\n";
+        branch << "          " << target << " = ArgbColor { static_cast<uint8_t>((tmp >> 24) & 0xFF), static_cast<uint8_t>(tmp & 0xFF), static_cast<uint8_t>((tmp >> 8) & 0xFF), static_cast<uint8_t>((tmp >> 16) & 0xFF) };\n";
+        branch << "          skip_unlikely<whitespace_pred>(text, end);\n";
+        add_branch();
+        continue;
+      }
 
-        switch (attr.type) {
-          case AttributeType::Int32:
+      switch (attr.type) {
+        case AttributeType::Int32:
 #ifdef ZUSIXML_SCHEMA_XML_MODE
-            parse_attributes << "          expect(\"integer\", text);\n";
-            parse_attributes << "          const char* enum_str = \" enum\";\n";
-            parse_attributes << "          if (!memcmp(enum_str, text, strlen(enum_str))) {\n";
-            parse_attributes << "            text += strlen(enum_str);\n";
-            parse_attributes << "          }\n";
+          branch << "          expect(\"integer\", text, end);\n";
+          branch << "          const char* enum_str = \" enum\";\n";
+          branch << "          if (peek(text, end, strlen(enum_str) - 1) != '\\0' && !memcmp(enum_str, text, strlen(enum_str))) {\n";
+          branch << "            text += strlen(enum_str);\n";
+          branch << "          }\n";
 #else
-            if (!startWhitespaceSkip) {
-              parse_attributes << "          skip_unlikely<whitespace_pred>(text);\n";
-            }
-            parse_attributes << "          boost::spirit::qi::parse(text, static_cast<const char*>(nullptr), boost::spirit::qi::int_, parseResult->" << attr.name << ");\n";
-            parse_attributes << "          skip_unlikely<whitespace_pred>(text);\n";
+          if (!startWhitespaceSkip) {
+            branch << "          skip_unlikely<whitespace_pred>(text, end);\n";
+          }
+          branch << "          parse_int(text, end, " << target << ");\n";
+          branch << "          skip_unlikely<whitespace_pred>(text, end);\n";
 #endif
-            break;
-          case AttributeType::Int64:
+          break;
+        case AttributeType::Int64:
 #ifdef ZUSIXML_SCHEMA_XML_MODE
-            parse_attributes << "          expect(\"integer 64bit\", text);\n";
+          branch << "          expect(\"integer 64bit\", text, end);\n";
 #else
-            if (!startWhitespaceSkip) {
-              parse_attributes << "          skip_unlikely<whitespace_pred>(text);\n";
-            }
-            parse_attributes << "          boost::spirit::qi::parse(text, static_cast<const char*>(nullptr), boost::spirit::qi::long_long, parseResult->" << attr.name << ");\n";
-            parse_attributes << "          skip_unlikely<whitespace_pred>(text);\n";
+          if (!startWhitespaceSkip) {
+            branch << "          skip_unlikely<whitespace_pred>(text, end);\n";
+          }
+          branch << "          parse_int(text, end, " << target << ");\n";
+          branch << "          skip_unlikely<whitespace_pred>(text, end);\n";
 #endif
-            break;
-          case AttributeType::Boolean:
+          break;
+        case AttributeType::Boolean:
 #ifdef ZUSIXML_SCHEMA_XML_MODE
-            parse_attributes << "          expect(\"bool\", text);\n";
+          branch << "          expect(\"bool\", text, end);\n";
 #else
-            if (!startWhitespaceSkip) {
-              parse_attributes << "          skip_unlikely<whitespace_pred>(text);\n";
-            }
-            parse_attributes << "          parseResult->" << attr.name << " = (text[0] == '1');\n";
-            parse_attributes << "          ++text;\n";
-            parse_attributes << "          skip_unlikely<whitespace_pred>(text);\n";
+          if (!startWhitespaceSkip) {
+            branch << "          skip_unlikely<whitespace_pred>(text, end);\n";
+          }
+          branch << "          " << target << " = (peek(text, end) == '1');\n";
+          branch << "          if (likely(text != end)) ++text;\n";
+          branch << "          skip_unlikely<whitespace_pred>(text, end);\n";
 #endif
-            break;
-          case AttributeType::String:
+          break;
+        case AttributeType::String:
 #ifdef ZUSIXML_SCHEMA_XML_MODE
-            parse_attributes << "          expect(\"string\", text);\n";
+          branch << "          expect(\"string\", text, end);\n";
 #else
-            parse_attributes << "          parse_string(text, parseResult->" << attr.name << ", quote);\n";
+          if (!sax && IsInterned(*curParent, attr)) {
+            branch << "          parse_string_interned(text, end, " << target << ", quote);\n";
+          } else {
+            branch << "          " << (!sax && m_config.string_view ? "parse_string_in_document" : "parse_string") << "(text, end, " << target << ", quote);\n";
+          }
 #endif
-            break;
-          case AttributeType::Float:
+          break;
+        case AttributeType::Float:
 #ifdef ZUSIXML_SCHEMA_XML_MODE
-            parse_attributes << "          expect(\"single\", text);\n";
-            parse_attributes << "          const char* decimal_places_str = \", 6 decimal places\";\n";
-            parse_attributes << "          if (!memcmp(decimal_places_str, text, strlen(decimal_places_str))) {\n";
-            parse_attributes << "            text += strlen(decimal_places_str);\n";
-            parse_attributes << "          }\n";
+          branch << "          expect(\"single\", text, end);\n";
+          branch << "          const char* decimal_places_str = \", 6 decimal places\";\n";
+          branch << "          if (peek(text, end, strlen(decimal_places_str) - 1) != '\\0' && !memcmp(decimal_places_str, text, strlen(decimal_places_str))) {\n";
+          branch << "            text += strlen(decimal_places_str);\n";
+          branch << "          }\n";
 #else
-            if (!startWhitespaceSkip) {
-              parse_attributes << "          skip_unlikely<whitespace_pred>(text);\n";
-            }
-            parse_attributes << "          parse_float(text, parseResult->" << attr.name << ");\n";
-            parse_attributes << "          skip_unlikely<whitespace_pred>(text);\n";
+          if (!startWhitespaceSkip) {
+            branch << "          skip_unlikely<whitespace_pred>(text, end);\n";
+          }
+          branch << "          parse_float(text, end, " << target << ");\n";
+          branch << "          skip_unlikely<whitespace_pred>(text, end);\n";
 #endif
-            break;
-          case AttributeType::DateTime:
+          break;
+        case AttributeType::DateTime:
 #ifdef ZUSIXML_SCHEMA_XML_MODE
-            parse_attributes << "          expect(\"date,time\", text);\n";
+          branch << "          expect(\"date,time\", text, end);\n";
 #else
-            if (!startWhitespaceSkip) {
-              parse_attributes << "          skip_unlikely<whitespace_pred>(text);\n";
-            }
-            parse_attributes << "          [[maybe_unused]] bool result = (unlikely(quote == Ch('\\\''))) ?\n";
-            parse_attributes << "            parse_datetime<Ch('\\\'')>(text, parseResult->" << attr.name << ") :\n";
-            parse_attributes << "            parse_datetime<Ch('\"')>(text, parseResult->" << attr.name << ");\n";
+          if (!startWhitespaceSkip) {
+            branch << "          skip_unlikely<whitespace_pred>(text, end);\n";
+          }
+          branch << "          [[maybe_unused]] bool result = (unlikely(quote == Ch('\\\''))) ?\n";
+          branch << "            parse_datetime<Ch('\\\'')>(text, end, " << target << ") :\n";
+          branch << "            parse_datetime<Ch('\"')>(text, end, " << target << ");\n";
 #endif
-            break;
-          case AttributeType::HexInt32:
+          break;
+        case AttributeType::HexInt32:
 #ifdef ZUSIXML_SCHEMA_XML_MODE
-            parse_attributes << "          expect(\"D3DColor\", text);\n";
+          branch << "          expect(\"D3DColor\", text, end);\n";
 #else
-            if (!startWhitespaceSkip) {
-              parse_attributes << "          skip_unlikely<whitespace_pred>(text);\n";
-            }
-            parse_attributes << "          boost::spirit::qi::parse(text, static_cast<const char*>(nullptr), boost::spirit::qi::int_parser<uint32_t, 16, 1, 9>(), parseResult->" << attr.name << ");\n";
-            parse_attributes << "          skip_unlikely<whitespace_pred>(text);\n";
+          if (!startWhitespaceSkip) {
+            branch << "          skip_unlikely<whitespace_pred>(text, end);\n";
+          }
+          branch << "          parse_hex(text, end, " << target << ");\n";
+          branch << "          skip_unlikely<whitespace_pred>(text, end);\n";
 #endif
-            break;
-          case AttributeType::ArgbColor:
+          break;
+        case AttributeType::ArgbColor:
 #ifdef ZUSIXML_SCHEMA_XML_MODE
-            parse_attributes << "          expect(\"D3DColor\", text);\n";
+          branch << "          expect(\"D3DColor\", text, end);\n";
 #else
-            if (!startWhitespaceSkip) {
-              parse_attributes << "          skip_unlikely<whitespace_pred>(text);\n";
-            }
-            parse_attributes << "          uint32_t tmp;\n";
-            parse_attributes << "          boost::spirit::qi::parse(text, static_cast<const char*>(nullptr), boost::spirit::qi::int_parser<uint32_t, 16, 1, 9>(), tmp);\n";
-            parse_attributes << "          parseResult->" << attr.name << " = ArgbColor { static_cast<uint8_t>((tmp >> 24) & 0xFF), static_cast<uint8_t>((tmp >> 16) & 0xFF), static_cast<uint8_t>((tmp >> 8) & 0xFF), static_cast<uint8_t>(tmp & 0xFF) };\n";
-            parse_attributes << "          skip_unlikely<whitespace_pred>(text);\n";
+          if (!startWhitespaceSkip) {
+            branch << "          skip_unlikely<whitespace_pred>(text, end);\n";
+          }
+          branch << "          uint32_t tmp = 0;\n";
+          branch << "          parse_hex(text, end, tmp);\n";
+          branch << "          " << target << " = ArgbColor { static_cast<uint8_t>((tmp >> 24) & 0xFF), static_cast<uint8_t>((tmp >> 16) & 0xFF), static_cast<uint8_t>((tmp >> 8) & 0xFF), static_cast<uint8_t>(tmp & 0xFF) };\n";
+          branch << "          skip_unlikely<whitespace_pred>(text, end);\n";
 #endif
-            break;
-          case AttributeType::FaceIndexes:
+          break;
+        case AttributeType::FaceIndexes:
 #ifdef ZUSIXML_SCHEMA_XML_MODE
-            parse_attributes << "          expect(\"string\", text);\n";
+          branch << "          expect(\"string\", text, end);\n";
 #else
-            // no whitespace skipping here, Zusi doesn't do that either
-            parse_attributes << "          const Ch* values[4];\n";
-            parse_attributes << "          values[0] = text;\n";
-            parse_attributes << "          while (*text >= '0' && *text <= '9') ++text;\n";
-            parse_attributes << "          if (*text != ';') parse_error_expected_semicolon(text);\n";
-            parse_attributes << "          ++text;\n";
-            parse_attributes << "          values[1] = text;\n";
-            parse_attributes << "          while (*text >= '0' && *text <= '9') ++text;\n";
-            parse_attributes << "          if (*text != ';') parse_error_expected_semicolon(text);\n";
-            parse_attributes << "          ++text;\n";
-            parse_attributes << "          values[2] = text;\n";
-            parse_attributes << "          while (*text >= '0' && *text <= '9') ++text;\n";
-            parse_attributes << "          values[3] = text + 1;\n";
-            parse_attributes << "          for (size_t i = 0; i < 3; i++) {\n";
-            parse_attributes << "            uint16_t result = 0;\n";
-            parse_attributes << "            if (values[i+1] != values[i]) {\n";
-            parse_attributes << "              size_t len = values[i+1] - 1 - values[i];\n";
-            // Adapted from https://tombarta.wordpress.com/2008/04/23/specializing-atoi/
-            parse_attributes << "              switch(len) {  // 16 bit short - max. 5 characters\n";
-            parse_attributes << "                case 5: result += (*(values[i] + (len-5)) - '0') * 10000; [[fallthrough]];\n";
-            parse_attributes << "                case 4: result += (*(values[i] + (len-4)) - '0') * 1000; [[fallthrough]];\n";
-            parse_attributes << "                case 3: result += (*(values[i] + (len-3)) - '0') * 100; [[fallthrough]];\n";
-            parse_attributes << "                case 2: result += (*(values[i] + (len-2)) - '0') * 10; [[fallthrough]];\n";
-            parse_attributes << "                case 1: result += (*(values[i] + (len-1)) - '0') * 1; [[fallthrough]];\n";
-            parse_attributes << "                case 0: break;\n";
-            parse_attributes << "                default: parse_error_value_too_long(text);\n";
-            parse_attributes << "              }\n";
-            parse_attributes << "            }\n";
-            parse_attributes << "            parseResult->" << attr.name << "[i] = result;\n";
-            parse_attributes << "          }\n";
-            parse_attributes << "          if (*text == ';') ++text;\n";
+          // no whitespace skipping here, Zusi doesn't do that either
+          branch << "          const Ch* values[4];\n";
+          branch << "          values[0] = text;\n";
+          branch << "          while (digit_pred::test(peek(text, end))) ++text;\n";
+          branch << "          if (peek(text, end) != ';') parse_error_expected_semicolon(text);\n";
+          branch << "          ++text;\n";
+          branch << "          values[1] = text;\n";
+          branch << "          while (digit_pred::test(peek(text, end))) ++text;\n";
+          branch << "          if (peek(text, end) != ';') parse_error_expected_semicolon(text);\n";
+          branch << "          ++text;\n";
+          branch << "          values[2] = text;\n";
+          branch << "          while (digit_pred::test(peek(text, end))) ++text;\n";
+          branch << "          values[3] = text + 1;\n";
+          branch << "          for (size_t i = 0; i < 3; i++) {\n";
+          branch << "            uint16_t result = 0;\n";
+          branch << "            if (values[i+1] != values[i]) {\n";
+          branch << "              size_t len = values[i+1] - 1 - values[i];\n";
+          // Adapted from https://tombarta.wordpress.com/2008/04/23/specializing-atoi/
+          branch << "              switch(len) {  // 16 bit short - max. 5 characters\n";
+          branch << "                case 5: result += (*(values[i] + (len-5)) - '0') * 10000; [[fallthrough]];\n";
+          branch << "                case 4: result += (*(values[i] + (len-4)) - '0') * 1000; [[fallthrough]];\n";
+          branch << "                case 3: result += (*(values[i] + (len-3)) - '0') * 100; [[fallthrough]];\n";
+          branch << "                case 2: result += (*(values[i] + (len-2)) - '0') * 10; [[fallthrough]];\n";
+          branch << "                case 1: result += (*(values[i] + (len-1)) - '0') * 1; [[fallthrough]];\n";
+          branch << "                case 0: break;\n";
+          branch << "                default: parse_error_value_too_long(text);\n";
+          branch << "              }\n";
+          branch << "            }\n";
+          branch << "            " << target << "[i] = result;\n";
+          branch << "          }\n";
+          branch << "          if (peek(text, end) == ';') ++text;\n";
 #endif
-            break;
-        }
-        parse_attributes << "        }\n";
+          break;
       }
+      add_branch();
+    }
 
-      parse_attributes << "        else {\n";
-      if (!m_config.ignore_unknown) {
-        parse_attributes << "          std::cerr << \"Unexpected attribute of node " << elementType->name << ": '\" << std::string_view(name, name_size) << \"'\\n\";\n";
-      }
-      parse_attributes << "          skip_attribute_value(text, quote);\n";
-      parse_attributes << "        }\n";
-
-      // Generate code for parsing method
-      out << R""(  static void parse_element_)"" << elementType->name << "(const Ch *& text, " << elementType->cppName << R""(* parseResult) {
-
+    std::ostringstream unknown_attribute;
+    if (!m_config.ignore_unknown) {
+      unknown_attribute << "          std::cerr << \"Unexpected attribute of node " << elementType.name << ": '\" << std::string_view(name, name_size) << \"'\\n\";\n";
+    }
+    unknown_attribute << "          skip_attribute_value(text, end, quote);\n";
+    GenerateNameDispatch(parse_attributes, attribute_branches, unknown_attribute.str(), "unknown_attribute", "        ");
+
+    // Generate code for parsing method
+    if (sax) {
+      out << "  template<class Handler>\n";
+      out << "  static void parse_element_" << elementType.name << "(const Ch *& text, const Ch * end, Handler* handler) {\n";
+      out << "      handler->on_begin_" << elementType.name << "();\n";
+    } else {
+      out << "  static void parse_element_" << elementType.name << "(const Ch *& text, const Ch * end, " << elementType.cppName << "* parseResult) {\n";
+    }
+    out << R""(
       // For all attributes
-      while (attribute_name_pred::test(*text))
+      while (attribute_name_pred::test(peek(text, end)))
       {
           // Extract attribute name
           const Ch *name = text;
           ++text;     // Skip first character of attribute name
-          skip<attribute_name_pred>(text);
+          skip<attribute_name_pred>(text, end);
           const size_t name_size [[maybe_unused]] = text - name;
 
           // Skip whitespace after attribute name
-          skip_unlikely<whitespace_pred>(text);
+          skip_unlikely<whitespace_pred>(text, end);
 
           // Skip =
-          if (*text != Ch('='))
+          if (peek(text, end) != Ch('='))
               parse_error_expected_equals(text);
           ++text;
 
           // Skip whitespace after =
-          skip_unlikely<whitespace_pred>(text);
+          skip_unlikely<whitespace_pred>(text, end);
 
           // Skip quote and remember if it was ' or "
-          Ch quote = *text;
+          Ch quote = peek(text, end);
           if (quote != Ch('\'') && quote != Ch('"'))
               parse_error_expected_quote(text);
           ++text;
@@ -1068,84 +2638,126 @@ static bool parse_datetime(const Ch*& text, struct tm& result) {
           )"" << parse_attributes.str() << R""(
 
           // Make sure that end quote is present
-          if (*text != quote)
+          if (peek(text, end) != quote)
               parse_error_expected_quote(text);
           ++text;     // Skip quote
 
           // Skip whitespace after attribute value
-          skip<whitespace_pred>(text);
+          skip<whitespace_pred>(text, end);
       }
 
       // Determine ending type
-      if ()"" << (allChildren.empty() ? "unlikely(*text == Ch('>'))" : "*text == Ch('>')") << R""()
+      if ()"" << (allChildren.empty() ? "unlikely(peek(text, end) == Ch('>'))" : "peek(text, end) == Ch('>')") << R""()
       {
           ++text;
-          parse_node_contents(text, [](const Ch *&text, void* parseResultUntyped) {
-              )"" << elementType->cppName << R""(* parseResult = static_cast<)"" << elementType->cppName << R""(*>(parseResultUntyped);
+)"" << reserve_children.str() << R""(          parse_node_contents(text, end, [](const Ch *&text, const Ch *end, void* )"" << result << R""(Untyped) {
+              )"" << resultType << "* " << result << " = static_cast<" << resultType << "*>(" << result << R""(Untyped);
               // Extract element name
               const Ch *name = text;
-              skip<node_name_pred>(text);
+              skip<node_name_pred>(text, end);
               if (text == name)
                   parse_error_expected_element_name(text);
               const size_t name_size [[maybe_unused]] = text - name;
 
               // Skip whitespace between element name and attributes or >
-              skip<whitespace_pred>(text);
+              skip<whitespace_pred>(text, end);
 
               )"" << parse_children.str() << R""(
-          }, parseResult);
+          }, )"" << result << R""();
       }
-      else if ((text[0] == Ch('/')) && (text[1] == Ch('>')))
+      else if ((peek(text, end, 0) == Ch('/')) && (peek(text, end, 1) == Ch('>')))
       {
           text += 2;
       }
       else
           parse_error_expected_tag_end(text);
-    })"" << "\n";
+)"";
+    if (sax) {
+      out << "      handler->on_end_" << elementType.name << "();\n";
+    }
+    out << "    }\n";
+  }
 
+  /** Returns the strategy to use when embedding the given @p child into the given @parentType as a member. */
+  std::unique_ptr<ChildStrategy> GetChildStrategy(const ElementType& parentType, const Child& child) const {
+    if (IsLazy(parentType, child)) {
+      return std::make_unique<LazyChildStrategy>(m_config.arena,
+          (m_config.arena || m_config.string_view ? 1 : 0) + (m_config.intern.empty() ? 0 : 1));
+    }
+    if (IsSoa(parentType, child)) {
+      const auto& it = m_element_type_member_names.find(child.type);
+      assert(it != m_element_type_member_names.end());
+      return std::make_unique<SoaChildStrategy>(it->second);
+    }
+    const auto& it = m_child_layouts.find(std::make_pair(&parentType, child.name));
+    const ChildLayout layout = (it != m_child_layouts.end() ? it->second : GetDefaultChildLayout(parentType, child));
+    switch (layout.kind) {
+      case ChildLayout::Kind::Optional:
+        return std::make_unique<OptionalChildStrategy>();
+      case ChildLayout::Kind::Inline:
+        return std::make_unique<InlineChildStrategy>(m_config.arena, layout.smallVectorSize);
+      case ChildLayout::Kind::UniquePtr:
+      default:
+        return std::make_unique<UniquePtrChildStrategy>(m_config.arena, layout.smallVectorSize, m_config.reuse);
     }
-    out << "}  // namespace zusixml\n";
   }
 
-  void ValidateWhitelist() {
-    for (const auto& [elementName, whitelistEntries] : m_config.whitelist) {
+  static const Child* FindChild(const ElementType& parentType, const std::string& name) {
+    const auto it = std::find_if(parentType.children.begin(), parentType.children.end(), [&name](const auto& child) { return child.name == name; });
+    return it == parentType.children.end() ? nullptr : &*it;
+  }
+
+  /** Warns about the entries of the member list option --@p option that name no element type,
+   * or whose member is not @p description of the element type according to @p isValid. */
+  template <typename Predicate>
+  void ValidateMemberList(const MemberList& members, const char* option, const char* description, Predicate isValid) const {
+    for (const auto& [elementName, memberNames] : members) {
       const auto it = std::find_if(m_element_types.begin(), m_element_types.end(),
           [&elementName = elementName](const auto& elementTypePtr) { return elementTypePtr->name == elementName; });
       if (it == m_element_types.end()) {
-        std::cerr << "Warning: Invalid whitelist entry: " << elementName << " is not an element type name.\n";
+        std::cerr << "Warning: Invalid " << option << " entry: " << elementName << " is not an element type name.\n";
         continue;
       }
-      for (const auto& entry : whitelistEntries) {
-        const auto& children = (*it)->children;
-        const auto itChild = std::find_if(children.begin(), children.end(),
-            [&entry](const auto& child) { return child.name == entry; });
-
-        const auto& attrs = (*it)->attributes;
-        const auto itAttr = std::find_if(attrs.begin(), attrs.end(),
-            [&entry](const auto& attr) { return attr.name == entry; });
-
-        if ((itChild == children.end()) && (itAttr == attrs.end())) {
-          std::cerr << "Warning: Invalid whitelist entry: " << entry << " is not a child or attribute of " << elementName << "\n";
-          continue;
+      for (const auto& memberName : memberNames) {
+        if (!isValid(**it, memberName)) {
+          std::cerr << "Warning: Invalid " << option << " entry: " << memberName << " is not " << description << " of " << elementName << "\n";
         }
-
-        std::cout << "Whitelist entry: " << elementName << "::" << entry << "\n";
       }
     }
   }
 
- private:
-  const std::vector<std::unique_ptr<ElementType>> m_element_types;
-  Config m_config;
-  const std::unordered_set<const ElementType*> m_used_element_types;
-  const std::unordered_set<const ElementType*> m_concrete_element_types;
-  std::unordered_map<const ElementType*, size_t> m_element_type_sizes;
+  bool IsLazy(const ElementType& parentType, const Child& child) const {
+    const auto& it = m_config.lazy.find(parentType.name);
+    return it != m_config.lazy.end() && it->second.count(child.name);
+  }
 
-  /** Returns the strategy to use when embedding the given @p child into the given @parentType as a member. */
-  std::unique_ptr<ChildStrategy> GetChildStrategy(const ElementType& parentType, const Child& child) const {
+  bool IsReserved(const ElementType& parentType, const Child& child) const {
+    const auto& it = m_config.reserve.find(parentType.name);
+    return child.multiple && it != m_config.reserve.end() && it->second.count(child.name);
+  }
+
+  bool IsSoa(const ElementType& parentType, const Child& child) const {
+    const auto& it = m_config.soa.find(parentType.name);
+    return child.multiple && child.type != &parentType && it != m_config.soa.end() && it->second.count(child.name);
+  }
+
+  /** Returns the fraction of @p parentType elements in the layout profile that contain @p child, or 0 if not profiled. */
+  double GetPresence(const ElementType& parentType, const Child& child) const {
+    const auto& it = m_config.layout_profile.children.find(parentType.name + "::" + child.name);
+    if (it == m_config.layout_profile.children.end() || it->second.Parents() == 0) {
+      return 0;
+    }
+    const auto& zeroIt = it->second.histogram.find(0);
+    const size_t absent = (zeroIt == it->second.histogram.end() ? 0 : zeroIt->second);
+    return 1.0 - static_cast<double>(absent) / it->second.Parents();
+  }
+
+  /** Returns the layout of @p child inside @p parentType if it is not chosen by --layout-profile. */
+  ChildLayout GetDefaultChildLayout(const ElementType& parentType, const Child& child) const {
+    const size_t smallVectorSize = (child.multiple ? SmallVectorSize(parentType, child) : 0);
     if (child.type != &parentType) {
       if (!child.multiple && child.type->name == "StreckenelementRichtungsInfo") {
-        return std::make_unique<OptionalChildStrategy>();
+        return { ChildLayout::Kind::Optional, 0 };
       }
       if (child.type->name == "Vertex"
           || child.type->name == "Face"
@@ -1156,13 +2768,191 @@ static bool parse_datetime(const Ch*& text, struct tm& result) {
           || child.type->name == "Tastaturzuordnung"
           || child.type->name == "Bremsgewicht"
           || child.type->name == "MatrixEintrag") {
-        return std::make_unique<InlineChildStrategy>();
+        return { ChildLayout::Kind::Inline, smallVectorSize };
+      }
+      if (smallVectorSize > 0) {
+        return { ChildLayout::Kind::Inline, smallVectorSize };
+      }
+    }
+    return { ChildLayout::Kind::UniquePtr, smallVectorSize };
+  }
+
+  /** Chooses the layout of @p child inside @p parentType with the least expected cost for the corpus
+   * of the layout profile. Must be called before the first call to GetChildStrategy for this child. */
+  void ChooseChildLayout(const ElementType& parentType, const Child& child, const TypeLayout& childLayout) {
+    const auto& profileIt = m_config.layout_profile.children.find(parentType.name + "::" + child.name);
+    if (profileIt == m_config.layout_profile.children.end() || IsLazy(parentType, child) || IsSoa(parentType, child)) {
+      return;
+    }
+    const ChildLayout defaultLayout = GetDefaultChildLayout(parentType, child);
+    ChildLayoutChoice choice { &parentType, child, defaultLayout, defaultLayout, {}, {} };
+    choice.defaultCost = GetLayoutCost(defaultLayout, child.multiple, profileIt->second, childLayout);
+    choice.cost = choice.defaultCost;
+
+    std::vector<ChildLayout> candidates;
+    if (child.type == &parentType
+        || (child.multiple && (child.type->name == "StrElement" || child.type->name == "ReferenzElement"))
+        || (!child.multiple && defaultLayout.kind == ChildLayout::Kind::Inline)) {
+      // Keep: recursive children need a pointer, StrElement and ReferenzElement may contain null entries
+      // (see UniquePtrChildStrategy), and inlined single children cannot be absent.
+    } else if (!child.multiple) {
+      candidates = { { ChildLayout::Kind::UniquePtr, 0 }, { ChildLayout::Kind::Optional, 0 } };
+    } else {
+      for (size_t smallVectorSize = 0; smallVectorSize <= 8; smallVectorSize++) {
+        candidates.push_back({ ChildLayout::Kind::UniquePtr, smallVectorSize });
+        candidates.push_back({ ChildLayout::Kind::Inline, smallVectorSize });
+      }
+    }
+    for (const auto& candidate : candidates) {
+      const LayoutCost cost = GetLayoutCost(candidate, child.multiple, profileIt->second, childLayout);
+      if (cost.Weighted() < choice.cost.Weighted()) {
+        choice.layout = candidate;
+        choice.cost = cost;
+      }
+    }
+    m_child_layouts[std::make_pair(&parentType, child.name)] = choice.layout;
+    m_child_layout_choices.push_back(std::move(choice));
+  }
+
+  /** Generates code that executes the branch whose name equals the element or attribute name given by
+   * the variables name and name_size, or @p fallback if there is no such branch.
+   * @p branches are pairs of name and code, @p label is a jump label that must be unique within the generated function. */
+  void GenerateNameDispatch(std::ostream& out, const std::vector<std::pair<std::string, std::string>>& branches,
+      const std::string& fallback, const std::string& label, const std::string& indent) const {
+    const auto generate_compare = [](const std::string& name) {
+      std::ostringstream out;
+      out << "name_size == " << name.size() << " && !memcmp(name, \"" << name << "\", " << name.size() << ")";
+      return out.str();
+    };
+    const auto generate_indented = [](const std::string& code) {
+      return IndentCode(code, "    ");
+    };
+
+    // Find a seed for name_hash that maps all branch names with distinct keys to distinct values.
+    std::map<uint32_t, std::vector<size_t>> branchesByHash;
+    uint32_t seed = 0;
+    unsigned bits = 1;
+    if (m_config.name_dispatch == NameDispatch::Switch && !branches.empty()) {
+      std::set<uint32_t> keys;
+      for (const auto& [name, code] : branches) {
+        keys.insert(NameHashKey(name));
+      }
+      while ((size_t { 1 } << bits) < keys.size()) {
+        ++bits;
+      }
+      for (const unsigned maxBits = bits + 4; seed == 0 && bits <= maxBits; ++bits) {
+        uint32_t candidate = 0x9E3779B9u;
+        for (size_t attempt = 0; attempt < 10000; ++attempt, candidate = candidate * 1664525u + 1013904223u) {
+          std::set<uint32_t> hashes;
+          for (uint32_t key : keys) {
+            hashes.insert(NameHash(key, candidate | 1, bits));
+          }
+          if (hashes.size() == keys.size()) {
+            seed = candidate | 1;
+            break;
+          }
+        }
+        if (seed != 0) {
+          break;
+        }
+      }
+      if (seed != 0) {
+        for (size_t i = 0; i < branches.size(); ++i) {
+          branchesByHash[NameHash(NameHashKey(branches[i].first), seed, bits)].push_back(i);
+        }
+      }
+    }
+
+    if (branchesByHash.empty()) {
+      for (const auto& [name, code] : branches) {
+        out << indent << "else if (" << generate_compare(name) << ") {\n";
+        out << code;
+        out << indent << "}\n";
+      }
+      out << indent << "else {\n";
+      out << fallback;
+      out << indent << "}\n";
+      return;
+    }
+
+    // Names with the same key share a case and are told apart by memcmp.
+    out << indent << "switch (name_hash<" << seed << "u, " << bits << ">(name, name_size)) {\n";
+    for (const auto& [hash, indices] : branchesByHash) {
+      out << indent << "  case " << hash << ":\n";
+      for (size_t i = 0; i < indices.size(); ++i) {
+        const auto& [name, code] = branches[indices[i]];
+        out << indent << "    " << (i == 0 ? "if (" : "else if (") << generate_compare(name) << ") {\n";
+        out << generate_indented(code);
+        out << indent << "    }\n";
       }
-      if (child.multiple && SmallVectorSize(parentType, child) > 0) {
-        return std::make_unique<InlineChildStrategy>();
+      out << indent << "    else goto " << label << ";\n";
+      out << indent << "    break;\n";
+    }
+    out << indent << "  default:\n";
+    out << indent << "  " << label << ":\n";
+    out << generate_indented(fallback);
+    out << indent << "}\n";
+  }
+
+  /** Returns the name of the member that holds the value of @p attr.
+   * The deprecated color attributes C, CA and E are stored in the members of their new forms. */
+  static std::string GetAttributeMemberName(const Attribute& attr) {
+    if (attr.name == "C") {
+      return "Cd";
+    } else if (attr.name == "CA") {
+      return "Ca";
+    } else if (attr.name == "E") {
+      return "Ce";
+    }
+    return attr.name;
+  }
+
+  /** Returns the type of the variable into which the SAX parser converts the value of @p attr. */
+  std::string GetSaxValueType(const Attribute& attr) const {
+    if (attr.name == "C" || attr.name == "CA" || attr.name == "E") {
+      return "ArgbColor";
+    }
+    switch (attr.type) {
+      case AttributeType::Int32:
+      case AttributeType::HexInt32:
+        return "int32_t";
+      case AttributeType::Int64:
+        return "int64_t";
+      case AttributeType::Boolean:
+        return "bool";
+      case AttributeType::String:
+        return "std::string_view";
+      case AttributeType::Float:
+        return "float";
+      case AttributeType::DateTime:
+        return m_config.compact_datetime ? "zusixml::datetime" : "struct tm";
+      case AttributeType::FaceIndexes:
+        return "std::array<uint16_t, 3>";
+      case AttributeType::ArgbColor:
+        return "ArgbColor";
+    }
+    return {};
+  }
+
+  /** Returns the parameter type of the SAX callback for @p attr. */
+  std::string GetSaxParameterType(const Attribute& attr) const {
+    const std::string valueType = GetSaxValueType(attr);
+    if (valueType == "struct tm" || valueType == "std::array<uint16_t, 3>") {
+      return "const " + valueType + "&";
+    }
+    return valueType;
+  }
+
+  /** Returns the types of the whitelisted children of @p elementType, except @p elementType itself. */
+  std::vector<const ElementType*> GetSaxChildTypes(const ElementType& elementType) const {
+    std::vector<const ElementType*> result;
+    for (const auto& [curParent, child] : GetAllChildren(elementType)) {
+      if (IsOnWhitelist(*curParent, child) && child.type != &elementType
+          && std::find(result.begin(), result.end(), child.type) == result.end()) {
+        result.push_back(child.type);
       }
     }
-    return std::make_unique<UniquePtrChildStrategy>();
+    return result;
   }
 
   /** Returns the base type, i.e. the least derived parent type, of the given element type. */
@@ -1232,6 +3022,71 @@ static bool parse_datetime(const Ch*& text, struct tm& result) {
     return result;
   }
 
+  /** Returns whether the string attribute @p attr of @p elementType is stored as zusixml::interned_string (option --intern). */
+  bool IsInterned(const ElementType& elementType, const Attribute& attr) const {
+    const auto& it = m_config.intern.find(elementType.name);
+    return attr.type == AttributeType::String && it != m_config.intern.end() && it->second.count(attr.name);
+  }
+
+  /** Returns the attributes declared by @p elementType that are stored in its zusixml::sparse_attributes
+   * (option --sparse-attributes) in the order of their presence bits: those present in fewer than
+   * the threshold fraction of elements in the layout profile, at most 64. None if moving them would not
+   * reduce the expected bytes per element. */
+  std::vector<const Attribute*> GetSparseAttributes(const ElementType& elementType) const {
+    std::vector<const Attribute*> result;
+    if (m_config.sparse_threshold <= 0
+        // parsed through pointers to their members, or laid out for compatibility
+        || elementType.name == "Vec2" || elementType.name == "Vec3" || elementType.name == "Quaternion" || elementType.name == "Vertex") {
+      return result;
+    }
+    for (const auto& attr : elementType.attributes) {
+      // The deprecated color attributes are parsed into the members of their new forms;
+      // the numbers of StrElement and ReferenzElement are needed for indexing;
+      // an accessor with the name of the type would be a constructor.
+      if (!IsOnWhitelist(elementType, attr) || attr.name == elementType.name || attr.name == "C" || attr.name == "CA" || attr.name == "E"
+          || attr.name == "Cd" || attr.name == "Ca" || attr.name == "Ce"
+          || (elementType.name == "StrElement" && attr.name == "Nr") || (elementType.name == "ReferenzElement" && attr.name == "ReferenzNr")) {
+        continue;
+      }
+      const double presence = m_config.layout_profile.AttributePresence(elementType.name + "@" + attr.name);
+      if (presence >= 0 && presence < m_config.sparse_threshold && result.size() < 64) {
+        result.push_back(&attr);
+      }
+    }
+
+    // Assumes that the attributes occur in different elements, i.e. at most one allocation per attribute.
+    size_t memberBytes = 0;
+    double presence = 0;
+    std::vector<TypeLayout> layouts;
+    for (const Attribute* attr : result) {
+      TypeLayout layout;
+      GetAttributeType(elementType, *attr, &layout);
+      memberBytes += layout.size;
+      layouts.push_back(layout);
+      presence += m_config.layout_profile.AttributePresence(elementType.name + "@" + attr->name);
+    }
+    std::stable_sort(layouts.begin(), layouts.end(), [](const TypeLayout& lhs, const TypeLayout& rhs) { return lhs.alignment > rhs.alignment; });
+    if (!result.empty() && memberBytes <= sizeof(void*) + std::min(presence, 1.0) * SparseAttributesBlockSize(layouts)) {
+      result.clear();
+    }
+    return result;
+  }
+
+  /** Returns the expression for the member that holds the value of @p attr of @p declaringType
+   * in the element pointed to by parseResult, marking the attribute as present if it is sparse. */
+  std::string GetAttributeTarget(const ElementType& elementType, const ElementType& declaringType, const Attribute& attr) const {
+    const std::string memberName = GetAttributeMemberName(attr);
+    const auto sparseAttributes = GetSparseAttributes(declaringType);
+    for (size_t i = 0; i < sparseAttributes.size(); i++) {
+      if (sparseAttributes[i]->name == memberName) {
+        // The member of a base class is hidden by that of the derived class.
+        return "parseResult->" + (&declaringType == &elementType ? "" : declaringType.name + "::")
+            + "sparse_attributes.set(" + std::to_string(i) + ")." + memberName;
+      }
+    }
+    return "parseResult->" + memberName;
+  }
+
   bool IsOnWhitelist(const ElementType& parentType, const Thing& thing) const {
     if (m_config.whitelist.empty()) {
       return !thing.deprecated() || thing.name == "C" || thing.name == "CA" || thing.name == "E";
@@ -1416,9 +3271,31 @@ class ParserGeneratorBuilder {
   }
 };
 
+/** Adds the entries of the member list option --@p option, each in the form ParentName::MemberName, to @p result. */
+void ParseMemberList(const std::vector<std::string>& entries, const char* option, MemberList& result) {
+  for (const auto& entry : entries) {
+    const auto colon_pos = entry.find("::");
+    if (colon_pos == std::string::npos || entry.find("::", colon_pos + 2) != std::string::npos) {
+      std::cerr << "Invalid " << option << " entry: \"" << entry << "\"\n";
+      continue;
+    }
+    result[entry.substr(0, colon_pos)].insert(entry.substr(colon_pos + 2));
+  }
+}
+
 int main(int argc, char** argv) {
   Config config;
   std::vector<std::string> whitelist;
+  std::vector<std::string> lazy;
+  std::vector<std::string> intern;
+  std::vector<std::string> soa;
+  std::vector<std::string> reserve;
+  std::string layout_profile;
+  std::string write_layout_profile;
+  std::string layout_report;
+  std::vector<std::string> profile_corpus;
+  std::string name_dispatch;
+  bool sax = false;
   std::string xsd;
   std::string out_dir;
 
@@ -1428,7 +3305,24 @@ int main(int argc, char** argv) {
     ("out-dir", po::value<std::string>(&out_dir), "Root XSD file to process")
     ("ignore-unknown", po::bool_switch(&config.ignore_unknown), "Do not produce an error message on encountering unknown element or attribute names. This speeds up parsing.")
     ("use-glm", po::bool_switch(&config.use_glm), "Use glm::tvec2, glm::tvec3 and glm::tquat for vector and quaternion types.")
+    ("string-view", po::bool_switch(&config.string_view), "Generate std::string_view members for string attributes. Values without character references refer to the XML data, others are expanded into memory owned by the document. parse_root returns a zusixml::document, which can also keep the XML data alive (see parseFile).")
+    ("arena", po::bool_switch(&config.arena), "Allocate all elements, vectors and strings of a document in a monotonic arena (zusi_parser/arena.hpp). parse_root returns a zusixml::document owning the arena, whose destruction releases the whole document at once.")
+    ("compact-datetime", po::bool_switch(&config.compact_datetime), "Generate zusixml::datetime members (8 bytes, zusi_parser/datetime.hpp) instead of struct tm for date/time attributes. Values compare as integers; to_tm() converts back to struct tm.")
+    ("reorder-members", po::bool_switch(&config.reorder_members), "Order the members of each generated struct by decreasing alignment to avoid padding (attributes before children, children more often present in the --layout-profile first; Vertex keeps its layout). Adds static_asserts on the struct sizes computed by parsergen.")
+    ("sparse-attributes", po::value<double>(&config.sparse_threshold), "Store the attributes that are present in fewer than the given fraction (e.g. 0.05) of the elements in the --layout-profile in a zusixml::sparse_attributes (zusi_parser/sparse.hpp), which is only allocated if one of them is present. The attribute Name is then read with Name() (the default value if absent) and has_Name().")
+    ("cache", po::bool_switch(&config.cache), "Generate write_element and read_element functions (zusi_parser/cache.hpp) for zusixml::ParseCache, which keeps binary snapshots of parsed files on disk and reads them instead of the XML while the file is unchanged. Children declared with --lazy are parsed when writing the snapshot. Cannot be combined with --arena, --string-view, --intern, --soa or --sparse-attributes.")
+    ("reuse", po::bool_switch(&config.reuse), "Generate zusixml::parse_root_into, which parses into an existing Zusi object. The previous contents are cleared, but strings and vectors keep their capacity and child elements are kept in a zusixml::element_pool (zusi_parser/pool.hpp) for the next document, so that parsing many similar files in a row allocates almost no memory. Cannot be combined with --arena, --string-view or --intern.")
+    ("layout-report", po::value<std::string>(&layout_report), "Write the size, alignment and padding of every generated struct to the given CSV file.")
+    ("sax", po::bool_switch(&sax), "Also generate zusi_sax_parser.hpp with a parser that calls handler callbacks instead of building structs.")
+    ("name-dispatch", po::value<std::string>(&name_dispatch)->default_value("chain"), "How to find the parse code for an element or attribute name: 'switch' (perfect hash) or 'chain' (sequence of string comparisons).")
     ("whitelist", po::value<std::vector<std::string>>(&whitelist), "Whitelist an element or attribute name to parse, in the form ParentName::Name. Can be specified multiple times. If no whitelist is specified, all known elements and attributes are parsed.")
+    ("soa", po::value<std::vector<std::string>>(&soa), "Store the given repeated child element as a zusixml::soa_vector, in the form ParentName::ChildName. Each member of the child type is kept in its own contiguous array (e.g. SubSet::Vertex: positions, normals and texture coordinates). Indexing and iteration still yield the child type by value. Can be specified multiple times.")
+    ("reserve", po::value<std::vector<std::string>>(&reserve), "Count the given repeated child elements in a fast pre-pass over the parent element and reserve the capacity of their container before parsing them, in the form ParentName::ChildName. Avoids repeated reallocation of large collections such as Strecke::StrElement at the cost of scanning the parent element twice. Can be specified multiple times.")
+    ("intern", po::value<std::vector<std::string>>(&intern), "Store the given string attribute only once per document, in the form ElementTypeName::AttributeName. The attribute is a zusixml::interned_string referring to the intern table of the document, or to the table installed with zusixml::intern_table::scope for sharing values between documents. Can be specified multiple times.")
+    ("lazy", po::value<std::vector<std::string>>(&lazy), "Do not parse the given child element together with its parent, in the form ParentName::ChildName. The child is stored as zusixml::lazy, which records its position in the XML data and parses it on first access. Can be specified multiple times.")
+    ("layout-profile", po::value<std::string>(&layout_profile), "Choose how children are stored (std::unique_ptr, std::optional, inline, vector or small_vector of size N) by the child counts in the given profile written by --write-layout-profile, and print the expected bytes and allocations per document. Children not in the profile keep their default storage.")
+    ("write-layout-profile", po::value<std::string>(&write_layout_profile), "Count the children of every element in the files given by --profile-corpus and write the statistics to the given file for use with --layout-profile, instead of generating a parser.")
+    ("profile-corpus", po::value<std::vector<std::string>>(&profile_corpus)->multitoken(), "XML files to profile for --write-layout-profile.")
     ("xsd", po::value<std::string>(&xsd), "Root XSD file to process")
     ;
 
@@ -1444,6 +3338,15 @@ int main(int argc, char** argv) {
     return 1;
   }
 
+  if (name_dispatch == "chain") {
+    config.name_dispatch = NameDispatch::Chain;
+  } else if (name_dispatch == "switch") {
+    config.name_dispatch = NameDispatch::Switch;
+  } else {
+    std::cerr << "Invalid name dispatch: \"" << name_dispatch << "\"\n";
+    return 1;
+  }
+
   for (const auto& entry : whitelist) {
     auto colon_pos = entry.find("::");
     decltype(colon_pos) start = 0;
@@ -1460,12 +3363,53 @@ int main(int argc, char** argv) {
     } while (colon_pos != std::string::npos);
   }
 
+  ParseMemberList(lazy, "lazy", config.lazy);
+  ParseMemberList(intern, "intern", config.intern);
+  ParseMemberList(reserve, "reserve", config.reserve);
+  ParseMemberList(soa, "soa", config.soa);
+
   ParserGeneratorBuilder builder;
   builder.AddXsdFile(xsd);
 
+  if (!layout_profile.empty() && !config.layout_profile.Read(layout_profile)) {
+    return 1;
+  }
+
+  if (config.sparse_threshold > 0 && config.layout_profile.documents == 0) {
+    std::cerr << "--sparse-attributes requires a --layout-profile\n";
+    return 1;
+  }
+
+  // Memory of the arena and of the XML data referred to by string views is not owned by the elements.
+  if (config.reuse && (config.arena || config.string_view || !config.intern.empty())) {
+    std::cerr << "--reuse cannot be combined with --arena, --string-view or --intern\n";
+    return 1;
+  }
+
+  // Snapshots are read into elements that own all their members.
+  if (config.cache && (config.arena || config.string_view || !config.intern.empty() || !config.soa.empty() || config.sparse_threshold > 0)) {
+    std::cerr << "--cache cannot be combined with --arena, --string-view, --intern, --soa or --sparse-attributes\n";
+    return 1;
+  }
+
   ParserGenerator generator = builder.Build(config);
 
+  if (!write_layout_profile.empty()) {
+    LayoutProfile profile;
+    for (const auto& fileName : profile_corpus) {
+      generator.ProfileDocument(fileName, &profile);
+    }
+    ofstream out_profile(write_layout_profile);
+    profile.Write(out_profile);
+    return 0;
+  }
+
   generator.ValidateWhitelist();
+  generator.ValidateLazy();
+  generator.ValidateIntern();
+  generator.ValidateSoa();
+  generator.ValidateReserve();
+  generator.ValidateLayoutProfile();
 
   ofstream out_types_fwd(fs::path(out_dir) / "zusi_types_fwd.hpp");
   generator.GenerateTypeDeclarations(out_types_fwd);
@@ -1473,10 +3417,22 @@ int main(int argc, char** argv) {
   ofstream out_types(fs::path(out_dir) / "zusi_types.hpp");
   generator.GenerateTypeIncludes(out_types);
   generator.GenerateTypeDefinitions(out_types);
+  if (config.layout_profile.documents > 0) {
+    generator.PrintLayoutReport(std::cout);
+  }
+  if (!layout_report.empty()) {
+    ofstream out_layout_report(layout_report);
+    generator.WriteLayoutReport(out_layout_report);
+  }
 
   ofstream out_parser_fwd(fs::path(out_dir) / "zusi_parser_fwd.hpp");
   generator.GenerateParseFunctionDeclarations(out_parser_fwd);
 
   ofstream out_parser(fs::path(out_dir) / "zusi_parser.hpp");
   generator.GenerateParseFunctionDefinitions(out_parser);
+
+  if (sax) {
+    ofstream out_sax_parser(fs::path(out_dir) / "zusi_sax_parser.hpp");
+    generator.GenerateSaxParser(out_sax_parser);
+  }
 }
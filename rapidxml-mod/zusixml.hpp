@@ -9,8 +9,11 @@
 // If standard library is disabled, user must provide implementations of required functions and typedefs
 #if !defined(ZUSIXML_NO_STDLIB)
     #include <cstdlib>      // For std::size_t
+    #include <cstdint>      // For std::uint64_t
     #include <cassert>      // For assert
+    #include <cstring>      // For std::strlen
     #include <memory>       // For std::unique_ptr
+    #include <type_traits>  // For std::void_t
 #endif
 
 // On MSVC, disable "conditional expression is constant" warning (level 4). 
@@ -23,6 +26,35 @@
 #define likely(x) __builtin_expect((x), 1)
 #define unlikely(x) __builtin_expect((x), 0)
 
+///////////////////////////////////////////////////////////////////////////
+// ZUSIXML_SIMD
+
+// Selects the kernel used to scan whitespace, text and attribute values.
+// ZUSIXML_SIMD_AUTO uses AVX2 if the CPU supports it (checked once at runtime) and SSE2 otherwise.
+#define ZUSIXML_SIMD_SCALAR 0
+#define ZUSIXML_SIMD_SSE2 1
+#define ZUSIXML_SIMD_AVX2 2
+#define ZUSIXML_SIMD_AUTO 3
+
+#if !defined(ZUSIXML_SIMD)
+    #if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+        #define ZUSIXML_SIMD ZUSIXML_SIMD_AUTO
+    #else
+        #define ZUSIXML_SIMD ZUSIXML_SIMD_SCALAR
+    #endif
+#endif
+
+// Number of characters tested with the lookup tables before switching to the vectorized kernel.
+// Most runs (whitespace between tags, numeric attribute values) are shorter than a block.
+#if !defined(ZUSIXML_SIMD_SCALAR_PREFIX)
+    #define ZUSIXML_SIMD_SCALAR_PREFIX 16
+#endif
+
+#if ZUSIXML_SIMD != ZUSIXML_SIMD_SCALAR
+    #include <cstdint>      // For std::uintptr_t
+    #include <immintrin.h>  // For SSE2/AVX2 intrinsics
+#endif
+
 ///////////////////////////////////////////////////////////////////////////
 // ZUSIXML_PARSE_ERROR
     
@@ -60,7 +92,7 @@ namespace zusixml
 namespace zusixml
 {
     using Ch = char;
-    using parse_function = void (*)(const Ch *&, void*);
+    using parse_function = void (*)(const Ch *&, const Ch *, void*);
 
     //! Parse error exception. 
     //! This exception is thrown by the parser when an error occurs. 
@@ -133,22 +165,154 @@ namespace zusixml
             static const unsigned char lookup_attribute_data_2[256];        // Attribute data table with double quotes
             static const unsigned char lookup_attribute_data_2_pure[256];   // Attribute data table with double quotes
             static const unsigned char lookup_digits[256];                  // Digits
+            static const std::uint64_t power_of_five_128[2 * 103];          // 5^q for q in [-64, 38], normalized to 128 bits (high, low)
+        };
+
+        // Character set for the vectorized scanning kernels.
+        // If Skip is true, scanning stops at the first character that is not one of Chars,
+        // otherwise scanning stops at the first character that is one of Chars.
+        template<bool Skip, char... Chars>
+        struct char_set
+        {
+        };
+
+#if ZUSIXML_SIMD != ZUSIXML_SIMD_SCALAR
+        // Returns a bit mask of the positions in block where scanning has to stop.
+        template<bool Skip, char... Chars>
+        static inline unsigned stop_mask_sse2(__m128i block, char_set<Skip, Chars...>)
+        {
+            __m128i match = _mm_setzero_si128();
+            ((match = _mm_or_si128(match, _mm_cmpeq_epi8(block, _mm_set1_epi8(Chars)))), ...);
+            const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(match));
+            return Skip ? (~mask & 0xFFFFu) : mask;
+        }
+
+        // Returns a pointer to the first character in [text, end) where scanning has to stop, or end.
+        // Only aligned blocks that start before end are loaded, so this never reads across a page boundary
+        // beyond the end of the input.
+        template<class Set>
+        static inline const Ch *scan_sse2(const Ch *text, const Ch *end)
+        {
+            if (unlikely(text >= end))
+                return end;
+            const std::uintptr_t misalignment = reinterpret_cast<std::uintptr_t>(text) & 15;
+            const __m128i *block = reinterpret_cast<const __m128i *>(text - misalignment);
+            unsigned mask = stop_mask_sse2(_mm_load_si128(block), Set()) & (~0u << misalignment);
+            while (!mask)
+            {
+                if (reinterpret_cast<const Ch *>(++block) >= end)
+                    return end;
+                mask = stop_mask_sse2(_mm_load_si128(block), Set());
+            }
+            const Ch *result = reinterpret_cast<const Ch *>(block) + __builtin_ctz(mask);
+            return result < end ? result : end;
+        }
+
+        template<bool Skip, char... Chars>
+        __attribute__((target("avx2")))
+        static inline unsigned stop_mask_avx2(__m256i block, char_set<Skip, Chars...>)
+        {
+            __m256i match = _mm256_setzero_si256();
+            ((match = _mm256_or_si256(match, _mm256_cmpeq_epi8(block, _mm256_set1_epi8(Chars)))), ...);
+            const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(match));
+            return Skip ? ~mask : mask;
+        }
+
+        template<class Set>
+        __attribute__((target("avx2")))
+        static inline const Ch *scan_avx2(const Ch *text, const Ch *end)
+        {
+            if (unlikely(text >= end))
+                return end;
+            const std::uintptr_t misalignment = reinterpret_cast<std::uintptr_t>(text) & 31;
+            const __m256i *block = reinterpret_cast<const __m256i *>(text - misalignment);
+            unsigned mask = stop_mask_avx2(_mm256_load_si256(block), Set()) & (~0u << misalignment);
+            while (!mask)
+            {
+                if (reinterpret_cast<const Ch *>(++block) >= end)
+                    return end;
+                mask = stop_mask_avx2(_mm256_load_si256(block), Set());
+            }
+            const Ch *result = reinterpret_cast<const Ch *>(block) + __builtin_ctz(mask);
+            return result < end ? result : end;
+        }
+
+#if ZUSIXML_SIMD == ZUSIXML_SIMD_AUTO
+        static bool cpu_has_avx2()
+        {
+            static const bool result = []() {
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx2") != 0;
+            }();
+            return result;
+        }
+#endif
+
+        template<class Set>
+        static inline const Ch *scan(const Ch *text, const Ch *end)
+        {
+#if ZUSIXML_SIMD == ZUSIXML_SIMD_AVX2
+            return scan_avx2<Set>(text, end);
+#elif ZUSIXML_SIMD == ZUSIXML_SIMD_SSE2
+            return scan_sse2<Set>(text, end);
+#else
+            return likely(cpu_has_avx2()) ? scan_avx2<Set>(text, end) : scan_sse2<Set>(text, end);
+#endif
+        }
+
+        // Tests the first characters using the lookup table lut and switches to the vectorized kernel for longer runs.
+        template<class Set>
+        static inline const Ch *scan_prefix(const Ch *text, const Ch *end, const unsigned char (&lut)[256])
+        {
+            for (size_t i = 0; i < ZUSIXML_SIMD_SCALAR_PREFIX; ++i, ++text)
+                if (text == end || !lut[static_cast<unsigned char>(*text)])
+                    return text;
+            return scan<Set>(text, end);
+        }
+#endif
+
+        // Detects predicates that provide a character set for the vectorized scanning kernels.
+        template<class Pred, class = void>
+        struct has_simd_chars : std::false_type
+        {
+        };
+
+        template<class Pred>
+        struct has_simd_chars<Pred, std::void_t<typename Pred::simd_chars>> : std::true_type
+        {
         };
     }
     //! \endcond
+
+    //! Returns the name of the kernel used to scan whitespace, text and attribute values
+    //! ("scalar", "sse2" or "avx2").
+    static inline const char *simd_kernel()
+    {
+#if ZUSIXML_SIMD == ZUSIXML_SIMD_AVX2
+        return "avx2";
+#elif ZUSIXML_SIMD == ZUSIXML_SIMD_SSE2
+        return "sse2";
+#elif ZUSIXML_SIMD == ZUSIXML_SIMD_AUTO
+        return internal::cpu_has_avx2() ? "avx2" : "sse2";
+#else
+        return "scalar";
+#endif
+    }
     
     // Forward declarations.
-    static void parse_bom(const Ch *&text);
-    static void parse_comment(const Ch *&text);
-    static void parse_doctype(const Ch *&text);
-    static void parse_pi(const Ch *&text);
-    static void parse_cdata(const Ch *&text);
+    static void parse_bom(const Ch *&text, const Ch *end);
+    static void parse_comment(const Ch *&text, const Ch *end);
+    static void parse_doctype(const Ch *&text, const Ch *end);
+    static void parse_pi(const Ch *&text, const Ch *end);
+    static void parse_cdata(const Ch *&text, const Ch *end);
 
-    static void parse_node(const Ch *&text, parse_function parse_element_function, void* parseResult);
-    static void parse_node_contents(const Ch *&text, parse_function parse_element_function, void* parseResult);
+    static void parse_document(const Ch *begin, const Ch *end, parse_function parse_element_function, void* parseResult);
+    static void parse_node(const Ch *&text, const Ch *end, parse_function parse_element_function, void* parseResult);
+    static void parse_node_contents(const Ch *&text, const Ch *end, parse_function parse_element_function, void* parseResult);
 
-    static void skip_element(const Ch *&text);
-    static void skip_node_attributes(const Ch *&text);
+    static void skip_element(const Ch *&text, const Ch *end);
+    static void skip_node_attributes(const Ch *&text, const Ch *end);
+    [[maybe_unused]] static bool count_child_elements(const Ch *text, const Ch *end, const Ch *const *names, const std::size_t *name_sizes, std::size_t *counts, std::size_t name_count);
 
     ///////////////////////////////////////////////////////////////////////
     // Internal character utility functions
@@ -156,6 +320,12 @@ namespace zusixml
     // Detect whitespace character
     struct whitespace_pred
     {
+        typedef internal::char_set<true, ' ', '\t', '\n', '\r'> simd_chars;
+        static const unsigned char (&lookup_table())[256]
+        {
+            return internal::lookup_tables<0>::lookup_whitespace;
+        }
+
         static unsigned char test(Ch ch)
         {
             return internal::lookup_tables<0>::lookup_whitespace[static_cast<unsigned char>(ch)];
@@ -183,6 +353,12 @@ namespace zusixml
     // Detect text character (PCDATA)
     struct text_pred
     {
+        typedef internal::char_set<false, '<', '\0'> simd_chars;
+        static const unsigned char (&lookup_table())[256]
+        {
+            return internal::lookup_tables<0>::lookup_text;
+        }
+
         static unsigned char test(Ch ch)
         {
             return internal::lookup_tables<0>::lookup_text[static_cast<unsigned char>(ch)];
@@ -198,6 +374,194 @@ namespace zusixml
         }
     };
 
+    ///////////////////////////////////////////////////////////////////////
+    // Incremental input
+
+    //! Supplies more data to a parser that has reached the end of the data it was given.
+    //! This allows parsing data that arrives in chunks: the parser pauses wherever the data ends,
+    //! even in the middle of a tag or attribute value, until the source has appended more.
+    //! New data must be appended in place, i.e. directly behind the previous end.
+    //! The source is installed per thread with set_refill_source().
+    //! Refill sources are only consulted if ZUSIXML_INCREMENTAL is defined before zusixml.hpp is included;
+    //! otherwise the end of the data given to the parser is final and checking for more costs nothing.
+    class refill_source
+    {
+    public:
+        //! Waits until the data extends beyond position wanted or no more data will follow.
+        //! Called on the parsing thread.
+        //! \param end Current end of the data as known to the parser.
+        //! \param wanted Position the parser needs to read.
+        //! \return New end of the data (not less than end).
+        virtual const Ch *refill(const Ch *end, const Ch *wanted) = 0;
+
+    protected:
+        ~refill_source() = default;
+    };
+
+    //! \cond internal
+    namespace internal
+    {
+        inline thread_local refill_source *current_refill_source = nullptr;
+
+        // Asks the refill source of the current thread for more data.
+        // Returns the new end (end itself if there is no source).
+        // Takes and returns end by value so that the callers' end can stay in a register.
+#if defined(ZUSIXML_INCREMENTAL)
+        __attribute__((noinline, cold)) static const Ch *refill(const Ch *end, const Ch *position)
+        {
+            if (current_refill_source == nullptr)
+                return end;
+            return current_refill_source->refill(end, position);
+        }
+#else
+        static inline const Ch *refill(const Ch *end, const Ch *)
+        {
+            return end;
+        }
+#endif
+
+        // Each parse function has its own copy of end, so after a nested function has refilled,
+        // text may already lie beyond the caller's end. Brings end up to date in that case.
+        static inline void catch_up(const Ch *text, const Ch *&end)
+        {
+#if defined(ZUSIXML_INCREMENTAL)
+            if (unlikely(text > end))
+                end = refill(end, text);
+#else
+            (void)text;
+            (void)end;
+#endif
+        }
+    }
+    //! \endcond
+
+    //! Installs the refill source for parsers running on the calling thread (nullptr for none).
+    //! \return Previously installed refill source.
+    inline refill_source *set_refill_source(refill_source *source)
+    {
+        refill_source *previous = internal::current_refill_source;
+        internal::current_refill_source = source;
+        return previous;
+    }
+
+    // Returns the character at text + offset, or 0 if that position is at or beyond end.
+    // This lets the parser treat the end of the input like a terminating zero.
+    // If a refill source is installed, end is first extended as far as possible.
+    static inline Ch peek(const Ch *text, const Ch *&end, size_t offset = 0)
+    {
+        if (likely(text + offset < end))
+            return text[offset];
+        end = internal::refill(end, text + offset);
+        return text + offset < end ? text[offset] : Ch('\0');
+    }
+
+    //! \cond internal
+    namespace internal
+    {
+        // Computes the high and low 64 bits of the 128 bit product a * b.
+        static inline void multiply_64x64(std::uint64_t a, std::uint64_t b, std::uint64_t &high, std::uint64_t &low)
+        {
+#if defined(__SIZEOF_INT128__)
+            const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+            high = static_cast<std::uint64_t>(product >> 64);
+            low = static_cast<std::uint64_t>(product);
+#else
+            const std::uint64_t a_lo = a & 0xFFFFFFFF, a_hi = a >> 32;
+            const std::uint64_t b_lo = b & 0xFFFFFFFF, b_hi = b >> 32;
+            const std::uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+            const std::uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+            high = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+            low = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+#endif
+        }
+
+        // Number of leading zero bits, value must not be 0.
+        static inline int count_leading_zeros(std::uint64_t value)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_clzll(value);
+#else
+            int result = 0;
+            while (!(value & (std::uint64_t(1) << 63)))
+            {
+                value <<= 1;
+                ++result;
+            }
+            return result;
+#endif
+        }
+
+        // Returns the bit pattern of the float nearest to w * 10^q (ties to even), using the Eisel-Lemire algorithm.
+        // w must have at most 19 decimal digits. The result is exact for every such w and q,
+        // including subnormal results, underflow to zero and overflow to infinity.
+        static inline std::uint32_t decimal_to_float_bits(std::uint64_t w, std::int64_t q)
+        {
+            constexpr int mantissa_bits = 23;
+            constexpr int minimum_exponent = -127;
+            constexpr std::uint32_t infinity_bits = std::uint32_t(0xFF) << mantissa_bits;
+            if (w == 0 || q < -64)
+                return 0;
+            if (q > 38)
+                return infinity_bits;
+
+            const int leading_zeros = count_leading_zeros(w);
+            w <<= leading_zeros;
+
+            // Multiply with the truncated power of five. The lower half of the table entry is only needed
+            // if the bits below the precision we need are all ones, i.e. the truncation might matter.
+            const std::uint64_t *const power_of_five = &lookup_tables<0>::power_of_five_128[2 * (q + 64)];
+            std::uint64_t high, low;
+            multiply_64x64(w, power_of_five[0], high, low);
+            constexpr std::uint64_t precision_mask = ~std::uint64_t(0) >> (mantissa_bits + 3);
+            if ((high & precision_mask) == precision_mask)
+            {
+                std::uint64_t second_high, second_low;
+                multiply_64x64(w, power_of_five[1], second_high, second_low);
+                low += second_high;
+                if (second_high > low)
+                    ++high;
+            }
+
+            const int upper_bit = static_cast<int>(high >> 63);
+            const int shift = upper_bit + 64 - mantissa_bits - 3;
+            std::uint64_t mantissa = high >> shift;
+            // floor(log2(10^q)) + 63 == ((217706 * q) >> 16) + 63
+            std::int32_t power2 = static_cast<std::int32_t>((((152170 + 65536) * q) >> 16) + 63 + upper_bit - leading_zeros - minimum_exponent);
+
+            if (power2 <= 0)
+            {
+                // Subnormal (or zero). Round-to-even ties cannot occur here.
+                if (-power2 + 1 >= 64)
+                    return 0;
+                mantissa >>= -power2 + 1;
+                mantissa += (mantissa & 1);
+                mantissa >>= 1;
+                // Rounding up may have produced the smallest normal number
+                power2 = (mantissa < (std::uint64_t(1) << mantissa_bits)) ? 0 : 1;
+                return static_cast<std::uint32_t>(mantissa) | (static_cast<std::uint32_t>(power2) << mantissa_bits);
+            }
+
+            // Exactly halfway between two floats: round to even. This is only possible for small q.
+            if (low <= 1 && q >= -17 && q <= 10 && (mantissa & 3) == 1)
+            {
+                if ((mantissa << shift) == high)
+                    mantissa &= ~std::uint64_t(1);
+            }
+            mantissa += (mantissa & 1);
+            mantissa >>= 1;
+            if (mantissa >= (std::uint64_t(2) << mantissa_bits))
+            {
+                mantissa = std::uint64_t(1) << mantissa_bits;
+                ++power2;
+            }
+            mantissa &= ~(std::uint64_t(1) << mantissa_bits);
+            if (power2 >= 0xFF)
+                return infinity_bits;
+            return static_cast<std::uint32_t>(mantissa) | (static_cast<std::uint32_t>(power2) << mantissa_bits);
+        }
+    }
+    //! \endcond
+
     // Insert coded character, using UTF8 or 8-bit ASCII
     static void insert_coded_character(Ch *&text, unsigned long code)
     {
@@ -235,40 +599,74 @@ namespace zusixml
     }
 
     // Skip characters until predicate evaluates to false
+    // (If the end of the data is reached, skipping continues after a refill, see refill_source.)
     template<class StopPred>
-    static void skip(const Ch *&text)
+    static void skip(const Ch *&text, const Ch *end)
     {
+        internal::catch_up(text, end);
         const Ch *tmp = text;
-        while (StopPred::test(*tmp))
-            ++tmp;
+        do
+        {
+#if ZUSIXML_SIMD != ZUSIXML_SIMD_SCALAR
+            if constexpr (internal::has_simd_chars<StopPred>::value)
+            {
+                tmp = internal::scan_prefix<typename StopPred::simd_chars>(tmp, end, StopPred::lookup_table());
+                continue;
+            }
+#endif
+            while (tmp != end && StopPred::test(*tmp))
+                ++tmp;
+        } while (unlikely(tmp == end) && tmp != (end = internal::refill(end, tmp)));
         text = tmp;
     }
 
-    static void skip_attribute_value(const Ch *&text, Ch quote)
+    static void skip_attribute_value(const Ch *&text, const Ch *end, Ch quote)
     {
+        internal::catch_up(text, end);
         const Ch *tmp = text;
-        const auto& lut = (unlikely(quote == Ch('\''))) ? internal::lookup_tables<0>::lookup_attribute_data_1 : internal::lookup_tables<0>::lookup_attribute_data_2;
-        while (lut[static_cast<unsigned char>(*tmp)])
-            ++tmp;
+        do
+        {
+#if ZUSIXML_SIMD != ZUSIXML_SIMD_SCALAR
+            if (unlikely(quote == Ch('\'')))
+                tmp = internal::scan_prefix<internal::char_set<false, '\'', '\0'>>(tmp, end, internal::lookup_tables<0>::lookup_attribute_data_1);
+            else
+                tmp = internal::scan_prefix<internal::char_set<false, '"', '\0'>>(tmp, end, internal::lookup_tables<0>::lookup_attribute_data_2);
+#else
+            const auto& lut = (unlikely(quote == Ch('\''))) ? internal::lookup_tables<0>::lookup_attribute_data_1 : internal::lookup_tables<0>::lookup_attribute_data_2;
+            while (tmp != end && lut[static_cast<unsigned char>(*tmp)])
+                ++tmp;
+#endif
+        } while (unlikely(tmp == end) && tmp != (end = internal::refill(end, tmp)));
         text = tmp;
     }
 
-    static void skip_attribute_value_pure(const Ch *&text, Ch quote)
+    static void skip_attribute_value_pure(const Ch *&text, const Ch *end, Ch quote)
     {
+        internal::catch_up(text, end);
         const Ch *tmp = text;
-        const auto& lut = (unlikely(quote == Ch('\''))) ? internal::lookup_tables<0>::lookup_attribute_data_1_pure : internal::lookup_tables<0>::lookup_attribute_data_2_pure;
-        while (lut[static_cast<unsigned char>(*tmp)])
-            ++tmp;
+        do
+        {
+#if ZUSIXML_SIMD != ZUSIXML_SIMD_SCALAR
+            if (unlikely(quote == Ch('\'')))
+                tmp = internal::scan_prefix<internal::char_set<false, '\'', '&', '\0'>>(tmp, end, internal::lookup_tables<0>::lookup_attribute_data_1_pure);
+            else
+                tmp = internal::scan_prefix<internal::char_set<false, '"', '&', '\0'>>(tmp, end, internal::lookup_tables<0>::lookup_attribute_data_2_pure);
+#else
+            const auto& lut = (unlikely(quote == Ch('\''))) ? internal::lookup_tables<0>::lookup_attribute_data_1_pure : internal::lookup_tables<0>::lookup_attribute_data_2_pure;
+            while (tmp != end && lut[static_cast<unsigned char>(*tmp)])
+                ++tmp;
+#endif
+        } while (unlikely(tmp == end) && tmp != (end = internal::refill(end, tmp)));
         text = tmp;
     }
 
     // Skip characters until predicate evaluates to false
     // or the given number of characters has been skipped
     template<class StopPred, size_t MaxSkip>
-    static void skip_max(const Ch *&text)
+    static void skip_max(const Ch *&text, const Ch *end)
     {
         const Ch *tmp = text;
-        for (size_t i = 0; i < MaxSkip && StopPred::test(*tmp); ++i) {
+        for (size_t i = 0; i < MaxSkip && StopPred::test(peek(tmp, end)); ++i) {
             ++tmp;
         }
         text = tmp;
@@ -277,39 +675,37 @@ namespace zusixml
     // Skip characters until predicate evaluates to false
     // while assuming that the predicate will evaluate to false on the first iteration
     template<class StopPred>
-    static void skip_unlikely(const Ch *&text)
+    static void skip_unlikely(const Ch *&text, const Ch *end)
     {
-        const Ch *tmp = text;
-        while (unlikely(StopPred::test(*tmp)))
-            ++tmp;
-        text = tmp;
+        if (unlikely(StopPred::test(peek(text, end))))
+            skip<StopPred>(text, end);
     }
 
     // Skip characters until predicate evaluates to true while
     // replacing XML character entity references with proper characters (&apos; &amp; &quot; &lt; &gt; &#...;)
-    static size_t copy_and_expand_character_refs(const Ch *&src, Ch *dest, Ch quote)
+    static size_t copy_and_expand_character_refs(const Ch *&src, const Ch *end, Ch *dest, Ch quote)
     {
         const Ch *dest_start = dest;
 
         const auto& lut = (unlikely(quote == Ch('\''))) ? internal::lookup_tables<0>::lookup_attribute_data_1 : internal::lookup_tables<0>::lookup_attribute_data_2;
-        while (lut[static_cast<unsigned char>(*src)])
+        while (lut[static_cast<unsigned char>(peek(src, end))])
         {
             // Test if replacement is needed
             if (src[0] == Ch('&'))
             {
-                switch (src[1])
+                switch (peek(src, end, 1))
                 {
 
                 // &amp; &apos;
                 case Ch('a'): 
-                    if (src[2] == Ch('m') && src[3] == Ch('p') && src[4] == Ch(';'))
+                    if (peek(src, end, 2) == Ch('m') && peek(src, end, 3) == Ch('p') && peek(src, end, 4) == Ch(';'))
                     {
                         *dest = Ch('&');
                         ++dest;
                         src += 5;
                         continue;
                     }
-                    if (src[2] == Ch('p') && src[3] == Ch('o') && src[4] == Ch('s') && src[5] == Ch(';'))
+                    if (peek(src, end, 2) == Ch('p') && peek(src, end, 3) == Ch('o') && peek(src, end, 4) == Ch('s') && peek(src, end, 5) == Ch(';'))
                     {
                         *dest = Ch('\'');
                         ++dest;
@@ -320,7 +716,7 @@ namespace zusixml
 
                 // &quot;
                 case Ch('q'): 
-                    if (src[2] == Ch('u') && src[3] == Ch('o') && src[4] == Ch('t') && src[5] == Ch(';'))
+                    if (peek(src, end, 2) == Ch('u') && peek(src, end, 3) == Ch('o') && peek(src, end, 4) == Ch('t') && peek(src, end, 5) == Ch(';'))
                     {
                         *dest = Ch('"');
                         ++dest;
@@ -331,7 +727,7 @@ namespace zusixml
 
                 // &gt;
                 case Ch('g'): 
-                    if (src[2] == Ch('t') && src[3] == Ch(';'))
+                    if (peek(src, end, 2) == Ch('t') && peek(src, end, 3) == Ch(';'))
                     {
                         *dest = Ch('>');
                         ++dest;
@@ -342,7 +738,7 @@ namespace zusixml
 
                 // &lt;
                 case Ch('l'): 
-                    if (src[2] == Ch('t') && src[3] == Ch(';'))
+                    if (peek(src, end, 2) == Ch('t') && peek(src, end, 3) == Ch(';'))
                     {
                         *dest = Ch('<');
                         ++dest;
@@ -353,13 +749,13 @@ namespace zusixml
 
                 // &#...; - assumes ASCII
                 case Ch('#'): 
-                    if (src[2] == Ch('x'))
+                    if (peek(src, end, 2) == Ch('x'))
                     {
                         unsigned long code = 0;
                         src += 3;   // Skip &#x
                         while (1)
                         {
-                            unsigned char digit = internal::lookup_tables<0>::lookup_digits[static_cast<unsigned char>(*src)];
+                            unsigned char digit = internal::lookup_tables<0>::lookup_digits[static_cast<unsigned char>(peek(src, end))];
                             if (digit == 0xFF)
                                 break;
                             code = code * 16 + digit;
@@ -373,7 +769,7 @@ namespace zusixml
                         src += 2;   // Skip &#
                         while (1)
                         {
-                            unsigned char digit = internal::lookup_tables<0>::lookup_digits[static_cast<unsigned char>(*src)];
+                            unsigned char digit = internal::lookup_tables<0>::lookup_digits[static_cast<unsigned char>(peek(src, end))];
                             if (digit == 0xFF)
                                 break;
                             code = code * 10 + digit;
@@ -381,7 +777,7 @@ namespace zusixml
                         }
                         insert_coded_character(dest, code);    // Put character in output
                     }
-                    if (*src == Ch(';'))
+                    if (peek(src, end) == Ch(';'))
                         ++src;
                     else
                         ZUSIXML_PARSE_ERROR("expected ;", src);
@@ -405,85 +801,163 @@ namespace zusixml
 }
 
 #include "zusi_parser/zusi_parser_fwd.hpp"
+#if defined(ZUSIXML_ARENA) || defined(ZUSIXML_STRING_VIEW) || defined(ZUSIXML_INTERN) || defined(ZUSIXML_LAZY)
+#include "zusi_parser/document.hpp"
+#endif
 
 namespace zusixml {
 
-    //! Parses zero-terminated XML string according to given flags.
-    //! Passed string will be modified by the parser, unless zusixml::parse_non_destructive flag is used.
-    //! The string must persist for the lifetime of the document.
+    //! Owning pointer to a parsed document as returned by parse_root.
+    //! If the parser was generated with --arena, --string-view, --intern or --lazy, this is a zusixml::document, which owns
+    //! the arena and intern table of the document and optionally the XML data; otherwise it is a std::unique_ptr.
+#if defined(ZUSIXML_ARENA) || defined(ZUSIXML_STRING_VIEW) || defined(ZUSIXML_INTERN) || defined(ZUSIXML_LAZY)
+    template<typename Result>
+    using root_ptr = document<Result>;
+#else
+    template<typename Result>
+    using root_ptr = std::unique_ptr<Result>;
+#endif
+
+    //! Parses the XML data in [begin, end).
+    //! The data does not need to be zero-terminated, and the parser never reads at or beyond end.
+    //! A zero character before end is treated as the end of the data.
+    //! The data is not modified by the parser.
+    //! If the parser was generated with --string-view or --lazy, string attributes or lazy children refer to the data,
+    //! which must outlive the result (see document::hold_input).
     //! In case of error, zusixml::parse_error exception will be thrown.
-    //! <br><br>
+    //! \param begin Start of the XML data to parse.
+    //! \param end End of the XML data to parse.
+    template<typename Result>
+    static root_ptr<Result> parse_root(const Ch *begin, const Ch *end)
+    {
+        root_ptr<Result> parseResult { nullptr };
+        parse_document(begin, end, [](const Ch *&text, const Ch *end, void* parseResult) {
+            // Extract element name
+            const Ch *name = text;
+            skip<node_name_pred>(text, end);
+            if (text == name)
+                ZUSIXML_PARSE_ERROR("expected element name", text);
+
+            // Skip whitespace between element name and attributes or >
+            skip<whitespace_pred>(text, end);
+            auto* parse_result_typed = static_cast<root_ptr<Result>*>(parseResult);
+#if defined(ZUSIXML_ARENA) || defined(ZUSIXML_STRING_VIEW) || defined(ZUSIXML_INTERN) || defined(ZUSIXML_LAZY)
+#  if defined(ZUSIXML_ARENA)
+            *parse_result_typed = document<Result>::create(true);
+#  else
+            *parse_result_typed = document<Result>::create(false);
+#  endif
+            const arena::scope scope(parse_result_typed->memory());
+#  if defined(ZUSIXML_INTERN)
+            // Intern into the table installed by the caller (e.g. one shared by several documents),
+            // otherwise into a table owned by the document.
+            if (intern_table* installed = intern_table::current())
+                parse_result_typed->use_strings(*installed);
+            else
+                parse_result_typed->own_strings();
+            const intern_table::scope intern_scope(*parse_result_typed->strings());
+#  endif
+#else
+            parse_result_typed->reset(new Result());
+#endif
+            parse_element_Zusi(text, end, parse_result_typed->get());
+        }, &parseResult);
+        return parseResult;
+    }
+
+    //! Parses zero-terminated XML string.
     //! If you want to parse contents of a file, you must first load the file into the memory, and pass pointer to its beginning.
-    //! Make sure that data is zero-terminated.
-    //! <br><br>
-    //! Document can be parsed into multiple times. 
-    //! Each new call to parse removes previous nodes and attributes (if any), but does not clear memory pool.
-    //! \param text XML data to parse; pointer is non-const to denote fact that this data may be modified by the parser.
+    //! Make sure that data is zero-terminated, or use the overload taking the end of the data.
+    //! \param text XML data to parse.
     template<typename Result>
-    static std::unique_ptr<Result> parse_root(const Ch *text)
+    static root_ptr<Result> parse_root(const Ch *text)
     {
         assert(text);
-        std::unique_ptr<Result> parseResult { nullptr };
-        
+        return parse_root<Result>(text, text + std::strlen(text));
+    }
+
+#if defined(ZUSIXML_REUSE)
+    //! Parses the XML data in [begin, end) like parse_root, but into the existing result (parser generated with --reuse).
+    //! The previous contents of result are cleared first; strings and vectors keep their capacity, and child elements
+    //! are returned to zusixml::element_pool, from which the parser takes new ones. Parsing many similar files
+    //! into the same result in a row therefore allocates almost no memory once the capacities have grown.
+    //! Children declared with --lazy refer to the data, which must remain valid until they are accessed.
+    //! In case of error, zusixml::parse_error exception will be thrown and result holds the part parsed so far.
+    //! \param result Element to parse into.
+    //! \param begin Start of the XML data to parse.
+    //! \param end End of the XML data to parse.
+    template<typename Result>
+    static void parse_root_into(Result& result, const Ch *begin, const Ch *end)
+    {
+        clear_element_Zusi(&result);
+        parse_document(begin, end, [](const Ch *&text, const Ch *end, void* parseResult) {
+            // Extract element name
+            const Ch *name = text;
+            skip<node_name_pred>(text, end);
+            if (text == name)
+                ZUSIXML_PARSE_ERROR("expected element name", text);
+
+            // Skip whitespace between element name and attributes or >
+            skip<whitespace_pred>(text, end);
+            auto* parse_result_typed = static_cast<Result*>(parseResult);
+            // Like parse_root, a later top-level element replaces an earlier one.
+            clear_element_Zusi(parse_result_typed);
+            parse_element_Zusi(text, end, parse_result_typed);
+        }, &result);
+    }
+#endif
+
+    ///////////////////////////////////////////////////////////////////////
+    // Internal parsing functions
+    
+    // Parses the XML data in [begin, end). For element nodes at the top level, calls the provided parse_element_function
+    // with the provided result as parameter.
+    static void parse_document(const Ch *begin, const Ch *end, parse_function parse_element_function, void* parseResult)
+    {
+        assert(begin && begin <= end);
+        const Ch *text = begin;
+
         // Parse BOM, if any
-        parse_bom(text);
+        parse_bom(text, end);
         
         // Parse children
         while (1)
         {
             // Skip whitespace before node
-            skip<whitespace_pred>(text);
-            if (*text == 0)
+            skip<whitespace_pred>(text, end);
+            if (peek(text, end) == 0)
                 break;
 
             // Parse and append new child
             if (*text == Ch('<'))
             {
                 ++text;     // Skip '<'
-                parse_node(text, [](const Ch *&text, void* parseResult) {
-                    // Extract element name
-                    const Ch *name = text;
-                    skip<node_name_pred>(text);
-                    if (text == name)
-                        ZUSIXML_PARSE_ERROR("expected element name", text);
-
-                    // Skip whitespace between element name and attributes or >
-                    skip<whitespace_pred>(text);
-                    auto* parse_result_typed = static_cast<std::unique_ptr<Result>*>(parseResult);
-                    parse_result_typed->reset(new Result());
-                    parse_element_Zusi(text, parse_result_typed->get());
-                }, &parseResult);
-
+                parse_node(text, end, parse_element_function, parseResult);
             }
             else
                 ZUSIXML_PARSE_ERROR("expected <", text);
         }
-
-        return parseResult;
     }
 
-    ///////////////////////////////////////////////////////////////////////
-    // Internal parsing functions
-    
     // Parse BOM, if any
-    static void parse_bom(const Ch *&text)
+    static void parse_bom(const Ch *&text, const Ch *end)
     {
         // UTF-8?
-        if (static_cast<unsigned char>(text[0]) == 0xEF && 
-            static_cast<unsigned char>(text[1]) == 0xBB && 
-            static_cast<unsigned char>(text[2]) == 0xBF)
+        if (static_cast<unsigned char>(peek(text, end, 0)) == 0xEF && 
+            static_cast<unsigned char>(peek(text, end, 1)) == 0xBB && 
+            static_cast<unsigned char>(peek(text, end, 2)) == 0xBF)
         {
             text += 3;      // Skip utf-8 bom
         }
     }
 
     // Parse XML comment (<!--...)
-    static void parse_comment(const Ch *&text)
+    static void parse_comment(const Ch *&text, const Ch *end)
     {
         // Skip until end of comment
-        while (text[0] != Ch('-') || text[1] != Ch('-') || text[2] != Ch('>'))
+        while (peek(text, end, 0) != Ch('-') || peek(text, end, 1) != Ch('-') || peek(text, end, 2) != Ch('>'))
         {
-            if (!text[0])
+            if (!peek(text, end))
                 ZUSIXML_PARSE_ERROR("unexpected end of data", text);
             ++text;
         }
@@ -491,13 +965,13 @@ namespace zusixml {
     }
 
     // Parse DOCTYPE
-    static void parse_doctype(const Ch *&text)
+    static void parse_doctype(const Ch *&text, const Ch *end)
     {
         // Skip to >
-        while (*text != Ch('>'))
+        while (peek(text, end) != Ch('>'))
         {
             // Determine character type
-            switch (*text)
+            switch (peek(text, end))
             {
             
             // If '[' encountered, scan for matching ending ']' using naive algorithm with depth
@@ -508,7 +982,7 @@ namespace zusixml {
                 int depth = 1;
                 while (depth > 0)
                 {
-                    switch (*text)
+                    switch (peek(text, end))
                     {
                         case Ch('['): ++depth; break;
                         case Ch(']'): --depth; break;
@@ -534,12 +1008,12 @@ namespace zusixml {
     }
 
     // Parse PI
-    static void parse_pi(const Ch *&text)
+    static void parse_pi(const Ch *&text, const Ch *end)
     {
         // Skip to '?>'
-        while (text[0] != Ch('?') || text[1] != Ch('>'))
+        while (peek(text, end, 0) != Ch('?') || peek(text, end, 1) != Ch('>'))
         {
-            if (*text == Ch('\0'))
+            if (peek(text, end) == Ch('\0'))
                 ZUSIXML_PARSE_ERROR("unexpected end of data", text);
             ++text;
         }
@@ -547,25 +1021,25 @@ namespace zusixml {
     }
 
     // Skip data.
-    static Ch parse_and_append_data(const Ch *&text, const Ch *contents_start)
+    static Ch parse_and_append_data(const Ch *&text, const Ch *end, const Ch *contents_start)
     {
         // Backup to contents start if whitespace trimming is disabled
         text = contents_start;     
         
         // Skip until end of data
-        skip<text_pred>(text);
+        skip<text_pred>(text, end);
 
         // Return character that ends data
-        return *text;
+        return peek(text, end);
     }
 
     // Parse CDATA
-    static void parse_cdata(const Ch *&text)
+    static void parse_cdata(const Ch *&text, const Ch *end)
     {
         // Skip until end of cdata
-        while (text[0] != Ch(']') || text[1] != Ch(']') || text[2] != Ch('>'))
+        while (peek(text, end, 0) != Ch(']') || peek(text, end, 1) != Ch(']') || peek(text, end, 2) != Ch('>'))
         {
-            if (!text[0])
+            if (!peek(text, end))
                 ZUSIXML_PARSE_ERROR("unexpected end of data", text);
             ++text;
         }
@@ -574,17 +1048,17 @@ namespace zusixml {
 
     // Parses an XML node. For element nodes, calls the provided parse_element_function with the provided result as parameter.
     // All other nodes (XML declaration etc.) are ignored.
-    static void parse_node(const Ch *&text, parse_function parse_element_function, void* parseResult)
+    static void parse_node(const Ch *&text, const Ch *end, parse_function parse_element_function, void* parseResult)
     {
         // Parse proper node type
-        switch (text[0])
+        switch (peek(text, end))
         {
 
         // <...
         default:
         {
             // Parse and append element node
-            parse_element_function(text, parseResult);
+            parse_element_function(text, end, parseResult);
             break;
         }
 
@@ -592,58 +1066,58 @@ namespace zusixml {
         case Ch('?'): 
             ++text;     // Skip ?
             // Parse PI
-            parse_pi(text);
+            parse_pi(text, end);
             break;
 
         // <!...
         case Ch('!'): 
 
             // Parse proper subset of <! node
-            switch (text[1])    
+            switch (peek(text, end, 1))    
             {
 
             // <!-
             case Ch('-'):
-                if (text[2] == Ch('-'))
+                if (peek(text, end, 2) == Ch('-'))
                 {
                     // '<!--' - xml comment
                     text += 3;     // Skip '!--'
-                    parse_comment(text);
-                    break;
+                    parse_comment(text, end);
+                    return;
                 }
                 break;
 
             // <![
             case Ch('['):
-                if (text[2] == Ch('C') && text[3] == Ch('D') && text[4] == Ch('A') && 
-                    text[5] == Ch('T') && text[6] == Ch('A') && text[7] == Ch('['))
+                if (peek(text, end, 2) == Ch('C') && peek(text, end, 3) == Ch('D') && peek(text, end, 4) == Ch('A') && 
+                    peek(text, end, 5) == Ch('T') && peek(text, end, 6) == Ch('A') && peek(text, end, 7) == Ch('['))
                 {
                     // '<![CDATA[' - cdata
                     text += 8;     // Skip '![CDATA['
-                    parse_cdata(text);
-                    break;
+                    parse_cdata(text, end);
+                    return;
                 }
                 break;
 
             // <!D
             case Ch('D'):
-                if (text[2] == Ch('O') && text[3] == Ch('C') && text[4] == Ch('T') && 
-                    text[5] == Ch('Y') && text[6] == Ch('P') && text[7] == Ch('E') && 
-                    whitespace_pred::test(text[8]))
+                if (peek(text, end, 2) == Ch('O') && peek(text, end, 3) == Ch('C') && peek(text, end, 4) == Ch('T') && 
+                    peek(text, end, 5) == Ch('Y') && peek(text, end, 6) == Ch('P') && peek(text, end, 7) == Ch('E') && 
+                    whitespace_pred::test(peek(text, end, 8)))
                 {
                     // '<!DOCTYPE ' - doctype
                     text += 9;      // skip '!DOCTYPE '
-                    parse_doctype(text);
-                    break;
+                    parse_doctype(text, end);
+                    return;
                 }
 
             }   // switch
 
             // Attempt to skip other, unrecognized node types starting with <!
             ++text;     // Skip !
-            while (*text != Ch('>'))
+            while (peek(text, end) != Ch('>'))
             {
-                if (*text == 0)
+                if (peek(text, end) == 0)
                     ZUSIXML_PARSE_ERROR("unexpected end of data", text);
                 ++text;
             }
@@ -654,32 +1128,32 @@ namespace zusixml {
     }
     
     // Skip element node
-    static void skip_element(const Ch *&text)
+    static void skip_element(const Ch *&text, const Ch *end)
     {
         // Parse attributes, if any
-        skip_node_attributes(text);
+        skip_node_attributes(text, end);
 
         // Determine ending type
-        if (*text == Ch('>'))
+        if (peek(text, end) == Ch('>'))
         {
             ++text;
-            parse_node_contents(text, [](const Ch *&text, void* parseResult) {
+            parse_node_contents(text, end, [](const Ch *&text, const Ch *end, void* parseResult) {
                 (void)parseResult;
                 // Extract element name
                 const Ch *name = text;
-                skip<node_name_pred>(text);
+                skip<node_name_pred>(text, end);
                 if (text == name)
                     ZUSIXML_PARSE_ERROR("expected element name", text);
 
                 // Skip whitespace between element name and attributes or >
-                skip<whitespace_pred>(text);
-                skip_element(text);
+                skip<whitespace_pred>(text, end);
+                skip_element(text, end);
             }, nullptr);
         }
-        else if (*text == Ch('/'))
+        else if (peek(text, end) == Ch('/'))
         {
             ++text;
-            if (*text != Ch('>'))
+            if (peek(text, end) != Ch('>'))
                 ZUSIXML_PARSE_ERROR("expected >", text);
             ++text;
         }
@@ -687,18 +1161,67 @@ namespace zusixml {
             ZUSIXML_PARSE_ERROR("expected >", text);
     }
 
+    //! \cond internal
+    namespace internal
+    {
+        struct child_element_counts
+        {
+            const Ch *const *names;
+            const std::size_t *name_sizes;
+            std::size_t *counts;
+            std::size_t name_count;
+        };
+    }
+    //! \endcond
+
+    // Counts the direct child elements with the given names of the element whose contents start at text
+    // (behind the '>' of its start tag), skipping their contents like skip_element. text is not advanced.
+    // Used by generated parsers to reserve capacities before parsing the children (parsergen option --reserve).
+    // Returns false without counting if a refill source is installed: counting would have to wait for the
+    // whole element to arrive.
+    [[maybe_unused]] static bool count_child_elements(const Ch *text, const Ch *end, const Ch *const *names, const std::size_t *name_sizes, std::size_t *counts, std::size_t name_count)
+    {
+#if defined(ZUSIXML_INCREMENTAL)
+        if (internal::current_refill_source != nullptr)
+            return false;
+#endif
+        internal::child_element_counts child_counts { names, name_sizes, counts, name_count };
+        parse_node_contents(text, end, [](const Ch *&text, const Ch *end, void* parseResult) {
+            const internal::child_element_counts &child_counts = *static_cast<const internal::child_element_counts *>(parseResult);
+            // Extract element name
+            const Ch *name = text;
+            skip<node_name_pred>(text, end);
+            if (text == name)
+                ZUSIXML_PARSE_ERROR("expected element name", text);
+            const std::size_t name_size = text - name;
+            for (std::size_t i = 0; i < child_counts.name_count; ++i)
+            {
+                if (child_counts.name_sizes[i] == name_size && !std::memcmp(child_counts.names[i], name, name_size))
+                {
+                    ++child_counts.counts[i];
+                    break;
+                }
+            }
+
+            // Skip whitespace between element name and attributes or >
+            skip<whitespace_pred>(text, end);
+            skip_element(text, end);
+        }, &child_counts);
+        return true;
+    }
+
     // Parse contents of the node - children, data etc.
     // In order to avoid having to specialize this function for all possible result types,
     // the result is passed as a void* pointer and must be cast to the appropriate type in parse_element_function.
-    static void parse_node_contents(const Ch *&text, parse_function parse_element_function, void* parseResult)
+    static void parse_node_contents(const Ch *&text, const Ch *end, parse_function parse_element_function, void* parseResult)
     {
         // For all children and text
         while (1)
         {
             // Skip whitespace between > and node contents
             const Ch *contents_start = text;      // Store start of node contents before whitespace is skipped
-            skip<whitespace_pred>(text);
-            Ch next_char = *text;
+            skip<whitespace_pred>(text, end);
+            Ch next_char = peek(text, end);
 
         // After data nodes, instead of continuing the loop, control jumps here.
         // This is because zero termination inside parse_and_append_data() function
@@ -712,15 +1235,15 @@ namespace zusixml {
             
             // Node closing or child node
             case Ch('<'):
-                if (text[1] == Ch('/'))
+                if (peek(text, end, 1) == Ch('/'))
                 {
                     // Node closing
                     text += 2;      // Skip '</'
                     // No validation, just skip name
-                    skip<node_name_pred>(text);
+                    skip<node_name_pred>(text, end);
                     // Skip remaining whitespace after node name
-                    skip_unlikely<whitespace_pred>(text);
-                    if (*text != Ch('>'))
+                    skip_unlikely<whitespace_pred>(text, end);
+                    if (peek(text, end) != Ch('>'))
                         ZUSIXML_PARSE_ERROR("expected >", text);
                     ++text;     // Skip '>'
                     return;     // Node closed, finished parsing contents
@@ -729,7 +1252,7 @@ namespace zusixml {
                 {
                     // Child node
                     ++text;     // Skip '<'
-                    parse_node(text, parse_element_function, parseResult);
+                    parse_node(text, end, parse_element_function, parseResult);
                 }
                 break;
 
@@ -739,7 +1262,7 @@ namespace zusixml {
 
             // Data node
             default:
-                next_char = parse_and_append_data(text, contents_start);
+                next_char = parse_and_append_data(text, end, contents_start);
                 goto after_data_node;   // Bypass regular processing after data nodes
 
             }
@@ -747,42 +1270,42 @@ namespace zusixml {
     }
     
     // Parse XML attributes of the node
-    static void skip_node_attributes(const Ch *&text)
+    static void skip_node_attributes(const Ch *&text, const Ch *end)
     {
         // For all attributes 
-        while (attribute_name_pred::test(*text))
+        while (attribute_name_pred::test(peek(text, end)))
         {
             // Skip attribute name
             ++text;     // Skip first character of attribute name
-            skip<attribute_name_pred>(text);
+            skip<attribute_name_pred>(text, end);
 
             // Skip whitespace after attribute name
-            skip_unlikely<whitespace_pred>(text);
+            skip_unlikely<whitespace_pred>(text, end);
 
             // Skip =
-            if (*text != Ch('='))
+            if (peek(text, end) != Ch('='))
                 ZUSIXML_PARSE_ERROR("expected =", text);
             ++text;
 
             // Skip whitespace after =
-            skip_unlikely<whitespace_pred>(text);
+            skip_unlikely<whitespace_pred>(text, end);
 
             // Skip quote and remember if it was ' or "
-            Ch quote = *text;
+            Ch quote = peek(text, end);
             if (quote != Ch('\'') && quote != Ch('"'))
                 ZUSIXML_PARSE_ERROR("expected ' or \"", text);
             ++text;
 
             // Extract attribute value
-            skip_attribute_value(text, quote);
+            skip_attribute_value(text, end, quote);
             
             // Make sure that end quote is present
-            if (*text != quote)
+            if (peek(text, end) != quote)
                 ZUSIXML_PARSE_ERROR("expected ' or \"", text);
             ++text;     // Skip quote
 
             // Skip whitespace after attribute value
-            skip<whitespace_pred>(text);
+            skip<whitespace_pred>(text, end);
         }
     }
 
@@ -996,6 +1519,117 @@ namespace zusixml {
            255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,  // E
            255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255   // F
         };
+
+        // Powers of five for the Eisel-Lemire algorithm (see parse_decimal_float).
+        // For q >= 0, 5^q shifted so that its most significant bit is bit 127, truncated to 128 bits.
+        // For q < 0, 2^b / 5^-q + 1 for a suitable b, truncated the same way.
+        template<int Dummy>
+        const std::uint64_t lookup_tables<Dummy>::power_of_five_128[2 * 103] =
+        {
+          0xa87fea27a539e9a5, 0x3f2398d747b36224,  // 5^-64
+          0xd29fe4b18e88640e, 0x8eec7f0d19a03aad,  // 5^-63
+          0x83a3eeeef9153e89, 0x1953cf68300424ac,  // 5^-62
+          0xa48ceaaab75a8e2b, 0x5fa8c3423c052dd7,  // 5^-61
+          0xcdb02555653131b6, 0x3792f412cb06794d,  // 5^-60
+          0x808e17555f3ebf11, 0xe2bbd88bbee40bd0,  // 5^-59
+          0xa0b19d2ab70e6ed6, 0x5b6aceaeae9d0ec4,  // 5^-58
+          0xc8de047564d20a8b, 0xf245825a5a445275,  // 5^-57
+          0xfb158592be068d2e, 0xeed6e2f0f0d56712,  // 5^-56
+          0x9ced737bb6c4183d, 0x55464dd69685606b,  // 5^-55
+          0xc428d05aa4751e4c, 0xaa97e14c3c26b886,  // 5^-54
+          0xf53304714d9265df, 0xd53dd99f4b3066a8,  // 5^-53
+          0x993fe2c6d07b7fab, 0xe546a8038efe4029,  // 5^-52
+          0xbf8fdb78849a5f96, 0xde98520472bdd033,  // 5^-51
+          0xef73d256a5c0f77c, 0x963e66858f6d4440,  // 5^-50
+          0x95a8637627989aad, 0xdde7001379a44aa8,  // 5^-49
+          0xbb127c53b17ec159, 0x5560c018580d5d52,  // 5^-48
+          0xe9d71b689dde71af, 0xaab8f01e6e10b4a6,  // 5^-47
+          0x9226712162ab070d, 0xcab3961304ca70e8,  // 5^-46
+          0xb6b00d69bb55c8d1, 0x3d607b97c5fd0d22,  // 5^-45
+          0xe45c10c42a2b3b05, 0x8cb89a7db77c506a,  // 5^-44
+          0x8eb98a7a9a5b04e3, 0x77f3608e92adb242,  // 5^-43
+          0xb267ed1940f1c61c, 0x55f038b237591ed3,  // 5^-42
+          0xdf01e85f912e37a3, 0x6b6c46dec52f6688,  // 5^-41
+          0x8b61313bbabce2c6, 0x2323ac4b3b3da015,  // 5^-40
+          0xae397d8aa96c1b77, 0xabec975e0a0d081a,  // 5^-39
+          0xd9c7dced53c72255, 0x96e7bd358c904a21,  // 5^-38
+          0x881cea14545c7575, 0x7e50d64177da2e54,  // 5^-37
+          0xaa242499697392d2, 0xdde50bd1d5d0b9e9,  // 5^-36
+          0xd4ad2dbfc3d07787, 0x955e4ec64b44e864,  // 5^-35
+          0x84ec3c97da624ab4, 0xbd5af13bef0b113e,  // 5^-34
+          0xa6274bbdd0fadd61, 0xecb1ad8aeacdd58e,  // 5^-33
+          0xcfb11ead453994ba, 0x67de18eda5814af2,  // 5^-32
+          0x81ceb32c4b43fcf4, 0x80eacf948770ced7,  // 5^-31
+          0xa2425ff75e14fc31, 0xa1258379a94d028d,  // 5^-30
+          0xcad2f7f5359a3b3e, 0x096ee45813a04330,  // 5^-29
+          0xfd87b5f28300ca0d, 0x8bca9d6e188853fc,  // 5^-28
+          0x9e74d1b791e07e48, 0x775ea264cf55347e,  // 5^-27
+          0xc612062576589dda, 0x95364afe032a819e,  // 5^-26
+          0xf79687aed3eec551, 0x3a83ddbd83f52205,  // 5^-25
+          0x9abe14cd44753b52, 0xc4926a9672793543,  // 5^-24
+          0xc16d9a0095928a27, 0x75b7053c0f178294,  // 5^-23
+          0xf1c90080baf72cb1, 0x5324c68b12dd6339,  // 5^-22
+          0x971da05074da7bee, 0xd3f6fc16ebca5e04,  // 5^-21
+          0xbce5086492111aea, 0x88f4bb1ca6bcf585,  // 5^-20
+          0xec1e4a7db69561a5, 0x2b31e9e3d06c32e6,  // 5^-19
+          0x9392ee8e921d5d07, 0x3aff322e62439fd0,  // 5^-18
+          0xb877aa3236a4b449, 0x09befeb9fad487c3,  // 5^-17
+          0xe69594bec44de15b, 0x4c2ebe687989a9b4,  // 5^-16
+          0x901d7cf73ab0acd9, 0x0f9d37014bf60a11,  // 5^-15
+          0xb424dc35095cd80f, 0x538484c19ef38c95,  // 5^-14
+          0xe12e13424bb40e13, 0x2865a5f206b06fba,  // 5^-13
+          0x8cbccc096f5088cb, 0xf93f87b7442e45d4,  // 5^-12
+          0xafebff0bcb24aafe, 0xf78f69a51539d749,  // 5^-11
+          0xdbe6fecebdedd5be, 0xb573440e5a884d1c,  // 5^-10
+          0x89705f4136b4a597, 0x31680a88f8953031,  // 5^-9
+          0xabcc77118461cefc, 0xfdc20d2b36ba7c3e,  // 5^-8
+          0xd6bf94d5e57a42bc, 0x3d32907604691b4d,  // 5^-7
+          0x8637bd05af6c69b5, 0xa63f9a49c2c1b110,  // 5^-6
+          0xa7c5ac471b478423, 0x0fcf80dc33721d54,  // 5^-5
+          0xd1b71758e219652b, 0xd3c36113404ea4a9,  // 5^-4
+          0x83126e978d4fdf3b, 0x645a1cac083126ea,  // 5^-3
+          0xa3d70a3d70a3d70a, 0x3d70a3d70a3d70a4,  // 5^-2
+          0xcccccccccccccccc, 0xcccccccccccccccd,  // 5^-1
+          0x8000000000000000, 0x0000000000000000,  // 5^0
+          0xa000000000000000, 0x0000000000000000,  // 5^1
+          0xc800000000000000, 0x0000000000000000,  // 5^2
+          0xfa00000000000000, 0x0000000000000000,  // 5^3
+          0x9c40000000000000, 0x0000000000000000,  // 5^4
+          0xc350000000000000, 0x0000000000000000,  // 5^5
+          0xf424000000000000, 0x0000000000000000,  // 5^6
+          0x9896800000000000, 0x0000000000000000,  // 5^7
+          0xbebc200000000000, 0x0000000000000000,  // 5^8
+          0xee6b280000000000, 0x0000000000000000,  // 5^9
+          0x9502f90000000000, 0x0000000000000000,  // 5^10
+          0xba43b74000000000, 0x0000000000000000,  // 5^11
+          0xe8d4a51000000000, 0x0000000000000000,  // 5^12
+          0x9184e72a00000000, 0x0000000000000000,  // 5^13
+          0xb5e620f480000000, 0x0000000000000000,  // 5^14
+          0xe35fa931a0000000, 0x0000000000000000,  // 5^15
+          0x8e1bc9bf04000000, 0x0000000000000000,  // 5^16
+          0xb1a2bc2ec5000000, 0x0000000000000000,  // 5^17
+          0xde0b6b3a76400000, 0x0000000000000000,  // 5^18
+          0x8ac7230489e80000, 0x0000000000000000,  // 5^19
+          0xad78ebc5ac620000, 0x0000000000000000,  // 5^20
+          0xd8d726b7177a8000, 0x0000000000000000,  // 5^21
+          0x878678326eac9000, 0x0000000000000000,  // 5^22
+          0xa968163f0a57b400, 0x0000000000000000,  // 5^23
+          0xd3c21bcecceda100, 0x0000000000000000,  // 5^24
+          0x84595161401484a0, 0x0000000000000000,  // 5^25
+          0xa56fa5b99019a5c8, 0x0000000000000000,  // 5^26
+          0xcecb8f27f4200f3a, 0x0000000000000000,  // 5^27
+          0x813f3978f8940984, 0x4000000000000000,  // 5^28
+          0xa18f07d736b90be5, 0x5000000000000000,  // 5^29
+          0xc9f2c9cd04674ede, 0xa400000000000000,  // 5^30
+          0xfc6f7c4045812296, 0x4d00000000000000,  // 5^31
+          0x9dc5ada82b70b59d, 0xf020000000000000,  // 5^32
+          0xc5371912364ce305, 0x6c28000000000000,  // 5^33
+          0xf684df56c3e01bc6, 0xc732000000000000,  // 5^34
+          0x9a130b963a6c115c, 0x3c7f400000000000,  // 5^35
+          0xc097ce7bc90715b3, 0x4b9f100000000000,  // 5^36
+          0xf0bdc21abb48db20, 0x1e86d40000000000,  // 5^37
+          0x96769950b50d88f4, 0x1314448000000000   // 5^38
+        };
     }
     //! \endcond
 
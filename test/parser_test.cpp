@@ -1,7 +1,30 @@
 #include "zusi_parser/zusi_parser.hpp"
+#include "zusi_parser/utils.hpp"
+#include "zusi_parser/compressed.hpp"
+#include "zusi_parser/zusi_sax_parser.hpp"
+#include "temp_verzeichnis.hpp"
 
 #include <boost/test/unit_test.hpp>
 
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#ifndef _WIN32
+#  include <cstring>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
 BOOST_AUTO_TEST_SUITE(ZusiParserTest)
 
 BOOST_AUTO_TEST_CASE(Anfuehrungszeichen) {
@@ -44,4 +67,1046 @@ BOOST_AUTO_TEST_CASE(XMLEntities) {
   BOOST_TEST(result->Info->children_AutorEintrag[1]->AutorName == "Test <\"2&quot>&quot;");
 }
 
+BOOST_AUTO_TEST_CASE(KommentareUndCDATA) {
+  // The element directly behind a comment, CDATA section or DOCTYPE is parsed, not skipped.
+  const auto result = zusixml::parse_root<Zusi>(R""(<Zusi><!-- <Strecke/> --><Info ObjektID="1"><![CDATA[<AutorEintrag/>]]><AutorEintrag AutorName="A"/></Info>
+<!DOCTYPE Zusi><Strecke/></Zusi>)"");
+  BOOST_TEST_REQUIRE(static_cast<bool>(result->Info));
+  BOOST_TEST(result->Info->ObjektID == 1);
+  BOOST_TEST_REQUIRE(result->Info->children_AutorEintrag.size() == 1);
+  BOOST_TEST(result->Info->children_AutorEintrag[0]->AutorName == "A");
+  BOOST_TEST(static_cast<bool>(result->Strecke));
+}
+
+BOOST_AUTO_TEST_CASE(LangeWerte) {
+  // Attribute values and whitespace runs of different lengths and alignments (exercises the vectorized scanning kernels)
+  for (size_t laenge = 0; laenge < 80; laenge++) {
+    const std::string wert = std::string(laenge, 'x') + "&amp;" + std::string(laenge % 7, 'y');
+    const std::string leerraum(laenge, laenge % 2 ? ' ' : '\n');
+    const std::string xml = "<Zusi>" + leerraum + "<Info DateiTyp=\"author\">" + leerraum
+      + "<AutorEintrag AutorName=\"" + wert + "\"" + leerraum + "/>"
+      + "<AutorEintrag AutorName='" + wert + "'/>" + leerraum
+      + "</Info>" + leerraum + "<author/></Zusi>" + leerraum;
+    const auto result = zusixml::parse_root<Zusi>(xml.c_str());
+    BOOST_TEST_REQUIRE(static_cast<bool>(result));
+    BOOST_TEST_REQUIRE(static_cast<bool>(result->Info));
+    BOOST_TEST_REQUIRE(result->Info->children_AutorEintrag.size() == 2);
+
+    const std::string erwartet = std::string(laenge, 'x') + "&" + std::string(laenge % 7, 'y');
+    BOOST_TEST(result->Info->children_AutorEintrag[0]->AutorName == std::string_view(erwartet));
+    BOOST_TEST(result->Info->children_AutorEintrag[1]->AutorName == std::string_view(erwartet));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Ganzzahlen) {
+  const auto result = zusixml::parse_root<Zusi>(R""(<Zusi>
+<Strecke>
+<StrElement Nr="1" Volt="-2147483648" Anschluss=" +2147483647 " Fkt="-9223372036854775808"/>
+<StrElement Nr='007' Fkt='9223372036854775807' Volt=""/>
+</Strecke>
+<Landschaft>
+<SubSet Cd="FF102030" Ca="0A0B0C0D" C="0FF102030"/>
+</Landschaft>
+</Zusi>)"");
+  BOOST_TEST_REQUIRE(static_cast<bool>(result->Strecke));
+  BOOST_TEST_REQUIRE(result->Strecke->children_StrElement.size() == 8);
+  BOOST_TEST_REQUIRE(static_cast<bool>(result->Strecke->children_StrElement[1]));
+  BOOST_TEST_REQUIRE(static_cast<bool>(result->Strecke->children_StrElement[7]));
+  BOOST_TEST(result->Strecke->children_StrElement[1]->Volt == std::numeric_limits<int32_t>::min());
+  BOOST_TEST(result->Strecke->children_StrElement[1]->Anschluss == std::numeric_limits<int32_t>::max());
+  BOOST_TEST(result->Strecke->children_StrElement[1]->Fkt == std::numeric_limits<int64_t>::min());
+  BOOST_TEST(result->Strecke->children_StrElement[7]->Nr == 7);
+  BOOST_TEST(result->Strecke->children_StrElement[7]->Fkt == std::numeric_limits<int64_t>::max());
+  BOOST_TEST(result->Strecke->children_StrElement[7]->Volt == 0);
+
+  BOOST_TEST_REQUIRE(static_cast<bool>(result->Landschaft));
+  BOOST_TEST_REQUIRE(result->Landschaft->children_SubSet.size() == 1);
+  const auto& subset = *result->Landschaft->children_SubSet[0];
+  // C (0AABBGGRR) is converted to Cd (AARRGGBB) and overrides the earlier Cd attribute
+  BOOST_TEST(subset.Cd.a == 0xFF);
+  BOOST_TEST(subset.Cd.r == 0x30);
+  BOOST_TEST(subset.Cd.g == 0x20);
+  BOOST_TEST(subset.Cd.b == 0x10);
+  BOOST_TEST(subset.Ca.a == 0x0A);
+  BOOST_TEST(subset.Ca.r == 0x0B);
+  BOOST_TEST(subset.Ca.g == 0x0C);
+  BOOST_TEST(subset.Ca.b == 0x0D);
+
+  // Overflow and missing digits are errors
+  BOOST_CHECK_THROW(zusixml::parse_root<Zusi>("<Zusi><Strecke><StrElement Volt=\"2147483648\"/></Strecke></Zusi>"), zusixml::parse_error);
+  BOOST_CHECK_THROW(zusixml::parse_root<Zusi>("<Zusi><Strecke><StrElement Fkt=\"-9223372036854775809\"/></Strecke></Zusi>"), zusixml::parse_error);
+  BOOST_CHECK_THROW(zusixml::parse_root<Zusi>("<Zusi><Strecke><StrElement Volt=\"-\"/></Strecke></Zusi>"), zusixml::parse_error);
+  BOOST_CHECK_THROW(zusixml::parse_root<Zusi>("<Zusi><Landschaft><SubSet Cd=\"1FF102030\"/></Landschaft></Zusi>"), zusixml::parse_error);
+}
+
+BOOST_AUTO_TEST_CASE(Gleitkommazahlen) {
+  const auto result = zusixml::parse_root<Zusi>(R""(<Zusi>
+<Strecke>
+<StrElement Nr="1" Ueberh='0.1' kr="-1,25E-3" spTrass=" 1.435 " Drahthoehe="16777217"/>
+<StrElement Nr="2" Ueberh="3.4028235e38" kr="1e-46" spTrass=".5" Drahthoehe="1.00000005960464477539062500000000001"/>
+</Strecke>
+</Zusi>)"");
+  BOOST_TEST_REQUIRE(static_cast<bool>(result->Strecke));
+  BOOST_TEST_REQUIRE(result->Strecke->children_StrElement.size() == 3);
+  const auto& element1 = *result->Strecke->children_StrElement[1];
+  BOOST_TEST(element1.Ueberh == 0.1f);
+  BOOST_TEST(element1.kr == -1.25e-3f);
+  BOOST_TEST(element1.spTrass == 1.435f);
+  BOOST_TEST(element1.Drahthoehe == 16777216.0f);  // ties to even
+  const auto& element2 = *result->Strecke->children_StrElement[2];
+  BOOST_TEST(element2.Ueberh == std::numeric_limits<float>::max());
+  BOOST_TEST(element2.kr == 0.0f);
+  BOOST_TEST(element2.spTrass == 0.5f);
+  BOOST_TEST(element2.Drahthoehe == 1.0000001f);  // just above the midpoint between 1 and the next float
+
+  const size_t slow_path_count = zusixml::float_slow_path_count;
+  const auto nan_result = zusixml::parse_root<Zusi>("<Zusi><Strecke><StrElement Nr=\"1\" kr=\"nan\"/></Strecke></Zusi>");
+  BOOST_TEST(std::isnan(nan_result->Strecke->children_StrElement[1]->kr));
+  BOOST_TEST(zusixml::float_slow_path_count == slow_path_count + 1);
+
+  BOOST_CHECK_THROW(zusixml::parse_root<Zusi>("<Zusi><Strecke><StrElement kr=\"-\"/></Strecke></Zusi>"), zusixml::parse_error);
+  BOOST_CHECK_THROW(zusixml::parse_root<Zusi>("<Zusi><Strecke><StrElement kr=\"1e\"/></Strecke></Zusi>"), zusixml::parse_error);
+}
+
+BOOST_AUTO_TEST_CASE(DatumUndUhrzeit) {
+  const auto result = zusixml::parse_root<Zusi>(R""(<Zusi>
+<Zug>
+<FahrplanEintrag Ank="2019-05-01 08:15:00" Abf='2019-05-01 08:16:30'/>
+<FahrplanEintrag Ank="2019-05-01 9:02:07"/>
+<FahrplanEintrag Abf="25:00:00"/>
+</Zug>
+</Zusi>)"");
+  BOOST_TEST_REQUIRE(static_cast<bool>(result->Zug));
+  const auto& eintraege = result->Zug->children_FahrplanEintrag;
+  BOOST_TEST_REQUIRE(eintraege.size() == 3);
+
+#if defined(ZUSIXML_COMPACT_DATETIME)
+  static_assert(sizeof(FahrplanEintrag::Ank) == 8);
+  const std::tm ank = eintraege[0]->Ank.to_tm();
+  BOOST_TEST(eintraege[1]->Ank.hour() == 9);
+  BOOST_TEST(eintraege[1]->Ank.minute() == 2);
+  BOOST_TEST(eintraege[1]->Ank.second() == 7);
+  BOOST_TEST((eintraege[0]->Ank < eintraege[0]->Abf));
+  BOOST_TEST((eintraege[0]->Abf < eintraege[1]->Ank));
+  BOOST_TEST(eintraege[2]->Abf.year() == 0);
+  BOOST_TEST(eintraege[2]->Abf.seconds_of_day() == 25 * 3600);
+  BOOST_TEST((zusixml::datetime::from_tm(ank) == eintraege[0]->Ank));
+  BOOST_TEST((eintraege[0]->Ank == zusixml::datetime(2019, 5, 1, 8, 15, 0)));
+#else
+  const std::tm& ank = eintraege[0]->Ank;
+  BOOST_TEST(eintraege[1]->Ank.tm_hour == 9);
+  BOOST_TEST(eintraege[1]->Ank.tm_min == 2);
+  BOOST_TEST(eintraege[1]->Ank.tm_sec == 7);
+  BOOST_TEST(eintraege[2]->Abf.tm_year == 0);
+  BOOST_TEST(eintraege[2]->Abf.tm_hour == 25);
+#endif
+  BOOST_TEST(ank.tm_year == 119);
+  BOOST_TEST(ank.tm_mon == 5);
+  BOOST_TEST(ank.tm_mday == 1);
+  BOOST_TEST(ank.tm_hour == 8);
+  BOOST_TEST(ank.tm_min == 15);
+  BOOST_TEST(ank.tm_sec == 0);
+}
+
+BOOST_AUTO_TEST_CASE(DateienStapelweiseLaden) {
+  // Every file is delivered exactly once, including the one that cannot be opened.
+  const TempVerzeichnis temp;
+  std::vector<std::string> dateinamen;
+  for (size_t i = 0; i < 20; i++) {
+    const fs::path pfad = temp / (std::to_string(i) + ".xml");
+    if (i != 7) {
+      std::ofstream datei(pfad.string(), std::ios::binary);
+      datei << "<Zusi><Info ObjektID=\"" << i << "\"/></Zusi>";
+    }
+    dateinamen.push_back(pfad.string());
+  }
+
+  std::vector<int> geliefert(dateinamen.size(), 0);
+  size_t fehler = 0;
+  {
+    zusixml::FileBatchLoader loader(dateinamen, 3);
+    while (true) {
+      size_t index = 0;
+      std::unique_ptr<zusixml::FileReader> reader;
+      try {
+        if (!loader.next(index, reader)) {
+          break;
+        }
+      } catch (const std::runtime_error&) {
+        BOOST_TEST(index == 7);
+        fehler++;
+        continue;
+      }
+      BOOST_TEST_REQUIRE(index < dateinamen.size());
+      geliefert[index]++;
+      const auto result = zusixml::parse_root<Zusi>(reader->data(), reader->data() + reader->size());
+      BOOST_TEST(result->Info->ObjektID == static_cast<int32_t>(index));
+    }
+  }
+  BOOST_TEST(fehler == 1);
+  for (size_t i = 0; i < dateinamen.size(); i++) {
+    BOOST_TEST(geliefert[i] == (i == 7 ? 0 : 1));
+  }
+
+  // Stops loading when destroyed before all files were taken.
+  zusixml::FileBatchLoader abgebrochen(dateinamen, 2);
+}
+
+#ifndef _WIN32
+BOOST_AUTO_TEST_CASE(DateienStapelweiseLadenBegrenzt) {
+  // At most maxGeladen files are loaded ahead of next(): the others are only opened after
+  // they were replaced below.
+  const TempVerzeichnis temp;
+  std::vector<std::string> dateinamen;
+  const auto schreibe = [&](size_t i, int objektId) {
+    const fs::path pfad = temp / (std::to_string(i) + ".xml");
+    const fs::path neu = temp / "neu.xml";
+    {
+      std::ofstream datei(neu.string(), std::ios::binary);
+      datei << "<Zusi><Info ObjektID=\"" << objektId << "\"/></Zusi>";
+    }
+    fs::rename(neu, pfad);  // mapped files keep the old contents
+    return pfad.string();
+  };
+  for (size_t i = 0; i < 20; i++) {
+    dateinamen.push_back(schreibe(i, 1));
+  }
+
+  zusixml::FileBatchLoader loader(dateinamen, 4, {}, 2);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  for (size_t i = 0; i < dateinamen.size(); i++) {
+    schreibe(i, 2);
+  }
+
+  size_t alt = 0;
+  size_t anzahl = 0;
+  loader.forEach([&](size_t, zusixml::FileReader& reader) {
+    const auto result = zusixml::parse_root<Zusi>(reader.data(), reader.data() + reader.size());
+    alt += result->Info->ObjektID == 1;
+    anzahl++;
+  });
+  BOOST_TEST(anzahl == dateinamen.size());
+  BOOST_TEST(alt <= 2u);
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(LadeHinweise) {
+  // The hints change how a file is loaded, but not its contents.
+  const TempVerzeichnis temp;
+  const fs::path pfad = temp / "policy.xml";
+  const std::string xml = "<Zusi><Info DateiTyp=\"author\"><AutorEintrag AutorName=\"" + std::string(10000, 'x') + "\"/></Info></Zusi>";
+  {
+    std::ofstream datei(pfad.string(), std::ios::binary);
+    datei << xml;
+  }
+  std::vector<zusixml::FileLoadPolicy> policies(5);
+  policies[1].read = true;
+  policies[1].sequential = true;
+  policies[1].willNeed = true;
+  policies[2].sequential = true;
+  policies[2].willNeed = true;
+  policies[3].populateMaxSize = xml.size();
+  policies[4].hugePages = true;
+  for (const auto& policy : policies) {
+    zusixml::FileReader reader(pfad.string(), policy);
+    BOOST_TEST_REQUIRE(reader.size() == xml.size());
+    BOOST_TEST(std::string_view(reader.data(), reader.size()) == xml);
+    reader.dontNeed();
+    BOOST_TEST(std::string_view(reader.data(), reader.size()) == xml);
+  }
+}
+
+#ifndef _WIN32
+BOOST_AUTO_TEST_CASE(DateiAnSeitengrenze) {
+  // The file contents are followed by a zero byte for all sizes, including exact multiples of the page size.
+  const TempVerzeichnis temp;
+  const fs::path pfad = temp / "page.xml";
+  const size_t seite = getpagesize();
+  const std::string anfang = "<Zusi><Info DateiTyp=\"";
+  const std::string ende = "\"/></Zusi>";
+  for (size_t groesse : { size_t(0), size_t(1), seite - 1, seite, seite + 1, 2 * seite - 1, 2 * seite, 3 * seite }) {
+    std::string inhalt(groesse, ' ');
+    if (groesse >= anfang.size() + ende.size()) {
+      inhalt = anfang + std::string(groesse - anfang.size() - ende.size(), 'x') + ende;
+    }
+    {
+      std::ofstream datei(pfad.string(), std::ios::binary);
+      datei << inhalt;
+    }
+    for (bool read : { false, true }) {
+      zusixml::FileLoadPolicy policy;
+      policy.read = read;
+      zusixml::FileReader reader(pfad.string(), policy);
+      BOOST_TEST_REQUIRE(reader.size() == groesse);
+      BOOST_TEST(std::string_view(reader.data(), reader.size()) == inhalt);
+      BOOST_TEST(reader.data()[groesse] == '\0');
+      if (groesse >= anfang.size() + ende.size()) {
+        // zero-terminated overload
+        const auto result = zusixml::parse_root<Zusi>(reader.data());
+        BOOST_TEST(result->Info->DateiTyp.size() == groesse - anfang.size() - ende.size());
+      }
+    }
+  }
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(Paket) {
+  const TempVerzeichnis temp;
+  const fs::path pfad = temp / "test.zusipack";
+  {
+    std::ofstream datei(pfad.string(), std::ios::binary);
+    zusixml::pack::writer writer(datei);
+    writer.add("Routes\\Deutschland\\Strecke.st3", "<Zusi><Info ObjektID=\"3\"/></Zusi>", 1234567890);
+    writer.add("\\Loks\\Lok.fzg", "<Zusi><Info ObjektID=\"1\"/></Zusi>", 1);
+    writer.add("leer.txt", "", 2);
+    writer.finish();
+  }
+
+  const auto paket = std::make_shared<const zusixml::PackReader>(pfad.string());
+  BOOST_TEST_REQUIRE(paket->size() == 3);
+  BOOST_TEST((*paket)[0].path() == "leer.txt");  // sorted case-insensitively
+  BOOST_TEST((*paket)[1].path() == "Loks\\Lok.fzg");
+
+  const auto strecke = paket->find("\\routes\\DEUTSCHLAND\\strecke.ST3");
+  BOOST_TEST_REQUIRE(strecke.has_value());
+  BOOST_TEST(strecke->path() == "Routes\\Deutschland\\Strecke.st3");
+  BOOST_TEST(strecke->mtime() == 1234567890);
+  BOOST_TEST(strecke->data()[strecke->size()] == '\0');
+  BOOST_TEST(paket->find("leer.txt")->size() == 0);
+  BOOST_TEST(!paket->find("Loks\\Lok.fz").has_value());
+  BOOST_TEST(!paket->find("Loks\\Lok.fzg2").has_value());
+
+  const auto result = zusixml::parseFile(paket, "Routes\\Deutschland\\Strecke.st3");
+  BOOST_TEST_REQUIRE(static_cast<bool>(result));
+  BOOST_TEST(result->Info->ObjektID == 3);
+  BOOST_TEST(!zusixml::parseFile(paket, "Routes\\Fehlt.st3"));
+
+  // Paths differing only in case cannot be told apart.
+  std::ostringstream doppelt;
+  zusixml::pack::writer doppeltWriter(doppelt);
+  doppeltWriter.add("a.st3", "", 0);
+  doppeltWriter.add("A.ST3", "", 0);
+  BOOST_CHECK_THROW(doppeltWriter.finish(), std::runtime_error);
+
+  // An entry without its terminating zero byte is only detected on access and reported like an unreadable file.
+  std::ostringstream beschaedigt;
+  zusixml::pack::writer beschaedigtWriter(beschaedigt);
+  beschaedigtWriter.add("a.st3", "<Zusi/>", 0);
+  beschaedigtWriter.finish();
+  std::string beschaedigtDaten = beschaedigt.str();
+  beschaedigtDaten[beschaedigtDaten.find("<Zusi/>") + 7] = 'x';
+  {
+    std::ofstream datei(pfad.string(), std::ios::binary);
+    datei << beschaedigtDaten;
+  }
+  BOOST_TEST(!zusixml::parseFile(std::make_shared<const zusixml::PackReader>(pfad.string()), "a.st3"));
+
+  {
+    std::ofstream datei(pfad.string(), std::ios::binary);
+    datei << "<Zusi/>";
+  }
+  BOOST_CHECK_THROW(zusixml::PackReader(pfad.string()), std::runtime_error);
+}
+
+#if defined(ZUSIXML_CACHE)
+BOOST_AUTO_TEST_CASE(ParseCache) {
+  // Built in the parser_test executable only (parsergen --cache).
+  BOOST_TEST(zusixml::cache::content_hash("", 0) == 0xEF46DB3751D8E999ULL);
+  BOOST_TEST(zusixml::cache::content_hash("abc", 3) == 0x44BC2CF5AD770999ULL);
+  const std::string_view lang = "Nobody inspects the spammish repetition";
+  BOOST_TEST(zusixml::cache::content_hash(lang.data(), lang.size()) == 0xFBCEA83C8A378BF1ULL);
+
+  const TempVerzeichnis temp;
+  const fs::path verzeichnis = temp / "cache";
+  const fs::path pfad = temp / "Strecke1.st3";
+  const auto schreibe = [&pfad](const std::string& inhalt) {
+    std::ofstream datei(pfad.string(), std::ios::binary | std::ios::trunc);
+    datei << inhalt;
+  };
+  const std::string xml = R""(<Zusi><Info ObjektID="5" Beschreibung="A &amp; B" EinsatzAb="2019-05-01 08:15:00"><AutorEintrag AutorName="C"/></Info>
+<Strecke><StrElement Nr="1" Oberbau="Schotter"><g X="1.5" Y="-2" Z="3"/><NachNorm Nr="3"/></StrElement><StrElement Nr="3"/>
+<Fahrstrasse FahrstrName="F1"><FahrstrStart Ref="3"/></Fahrstrasse></Strecke>
+<Landschaft><SubSet Cd="FF102030"/></Landschaft></Zusi>)"";
+  schreibe(xml);
+
+  auto cache = std::make_shared<zusixml::ParseCache>(verzeichnis.string());
+  const auto pruefe = [](const Zusi& result) {
+    BOOST_TEST_REQUIRE(static_cast<bool>(result.Info));
+    BOOST_TEST(result.Info->ObjektID == 5);
+    BOOST_TEST(result.Info->Beschreibung == "A & B");
+    BOOST_TEST(result.Info->EinsatzAb.tm_year == 119);
+    BOOST_TEST(result.Info->EinsatzAb.tm_min == 15);
+    BOOST_TEST_REQUIRE(result.Info->children_AutorEintrag.size() == 1);
+    BOOST_TEST(result.Info->children_AutorEintrag[0]->AutorName == "C");
+    BOOST_TEST_REQUIRE(static_cast<bool>(result.Strecke));
+    const auto& elemente = result.Strecke->children_StrElement;
+    BOOST_TEST_REQUIRE(elemente.size() == 4);
+    BOOST_TEST(!elemente[0]);
+    BOOST_TEST(!elemente[2]);
+    BOOST_TEST_REQUIRE(static_cast<bool>(elemente[1]));
+    BOOST_TEST_REQUIRE(static_cast<bool>(elemente[3]));
+    BOOST_TEST(elemente[1]->Oberbau == "Schotter");
+    BOOST_TEST(elemente[1]->g.X == 1.5f);
+    BOOST_TEST(elemente[1]->g.Y == -2.0f);
+    BOOST_TEST(elemente[1]->g.Z == 3.0f);
+    BOOST_TEST_REQUIRE(elemente[1]->children_NachNorm.size() == 1);
+    BOOST_TEST(elemente[1]->children_NachNorm[0].Nr == 3);
+    BOOST_TEST(elemente[3]->Nr == 3);
+    BOOST_TEST_REQUIRE(result.Strecke->children_Fahrstrasse.size() == 1);
+    BOOST_TEST(result.Strecke->children_Fahrstrasse[0]->FahrstrName == "F1");
+    BOOST_TEST_REQUIRE(static_cast<bool>(result.Strecke->children_Fahrstrasse[0]->FahrstrStart));
+    BOOST_TEST(result.Strecke->children_Fahrstrasse[0]->FahrstrStart->Ref == 3);
+    BOOST_TEST_REQUIRE(static_cast<bool>(result.Landschaft));
+    BOOST_TEST_REQUIRE(result.Landschaft->children_SubSet.size() == 1);
+    BOOST_TEST(result.Landschaft->children_SubSet[0]->Cd.r == 0x10);
+    BOOST_TEST(result.Landschaft->children_SubSet[0]->Cd.b == 0x30);
+  };
+
+  const auto erstes = cache->parseFile(pfad.string());
+  BOOST_TEST_REQUIRE(static_cast<bool>(erstes));
+  pruefe(*erstes);
+  BOOST_TEST(cache->stats().verfehlt == 1);
+  BOOST_TEST(cache->stats().geschrieben == 1);
+  BOOST_TEST(cache->size() > 0);
+
+  // Second time from the snapshot; lazy children are already parsed.
+  const auto zweites = cache->parseFile(pfad.string());
+  BOOST_TEST_REQUIRE(static_cast<bool>(zweites));
+  BOOST_TEST(cache->stats().treffer == 1);
+  BOOST_TEST(zweites->Strecke->children_Fahrstrasse[0].parsed());
+  pruefe(*zweites);
+
+  // Same contents with a new modification time: still a hit, decided by the content hash.
+  schreibe(xml);
+  BOOST_TEST(static_cast<bool>(cache->parseFile(pfad.string())));
+  BOOST_TEST(cache->stats().treffer == 2);
+  BOOST_TEST(cache->stats().verfehlt == 1);
+
+  // Changed contents replace the snapshot.
+  schreibe("<Zusi><Info ObjektID=\"6\"/></Zusi>");
+  auto geaendert = cache->parseFile(pfad.string());
+  BOOST_TEST_REQUIRE(static_cast<bool>(geaendert));
+  BOOST_TEST(geaendert->Info->ObjektID == 6);
+  BOOST_TEST(cache->stats().verfehlt == 2);
+  geaendert = cache->parseFile(pfad.string());
+  BOOST_TEST(geaendert->Info->ObjektID == 6);
+  BOOST_TEST(cache->stats().treffer == 3);
+
+  cache->invalidate(pfad.string());
+  BOOST_TEST(cache->size() == 0);
+  BOOST_TEST(static_cast<bool>(cache->parseFile(pfad.string())));
+  BOOST_TEST(cache->stats().verfehlt == 3);
+
+  // Parse errors in lazy children are only detected when writing the snapshot, which is skipped then.
+  schreibe("<Zusi><Strecke><Fahrstrasse Laenge=\"x\"/></Strecke></Zusi>");
+  BOOST_TEST(static_cast<bool>(cache->parseFile(pfad.string())));
+  BOOST_TEST(cache->stats().geschrieben == 3);
+  BOOST_TEST(!zusixml::ParseCache(verzeichnis.string()).parseFile((verzeichnis / "fehlt.st3").string()));
+
+  // parseFile uses the cache once set.
+  schreibe(xml);
+  zusixml::setParseCache(cache);
+  pruefe(*zusixml::parseFile(pfad.string()));
+  pruefe(*zusixml::parseFile(pfad.string()));
+  zusixml::setParseCache(nullptr);
+  BOOST_TEST(cache->stats().treffer == 4);
+
+  // A new cache finds the snapshots of the old one.
+  BOOST_TEST(zusixml::ParseCache(verzeichnis.string()).size() == cache->size());
+  cache->clear();
+  BOOST_TEST(cache->size() == 0);
+  BOOST_TEST(fs::is_empty(verzeichnis));
+
+  // Beyond the maximum size, the least recently used snapshots are removed.
+  const fs::path pfad2 = temp / "Strecke2.st3";
+  fs::copy_file(pfad, pfad2, fs::copy_options::overwrite_existing);
+  cache->parseFile(pfad.string());
+  const uint64_t einSchnappschuss = cache->size();
+  zusixml::ParseCache klein(verzeichnis.string(), einSchnappschuss * 3 / 2);
+  klein.parseFile(pfad2.string());
+  BOOST_TEST(klein.stats().verdraengt == 1);
+  BOOST_TEST(klein.size() <= einSchnappschuss * 3 / 2);
+  klein.parseFile(pfad2.string());
+  BOOST_TEST(klein.stats().treffer == 1);
+  klein.parseFile(pfad.string());
+  BOOST_TEST(klein.stats().verfehlt == 2);
+}
+#endif
+
+#if defined(ZUSI_PARSER_USE_ZLIB)
+namespace {
+  std::string komprimiere(std::string_view daten, int windowBits) {
+    z_stream stream {};
+    BOOST_TEST_REQUIRE(deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+    std::string result(deflateBound(&stream, daten.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(daten.data()));
+    stream.avail_in = daten.size();
+    stream.next_out = reinterpret_cast<Bytef*>(result.data());
+    stream.avail_out = result.size();
+    BOOST_TEST_REQUIRE(deflate(&stream, Z_FINISH) == Z_STREAM_END);
+    result.resize(stream.total_out);
+    deflateEnd(&stream);
+    return result;
+  }
+
+  void schreibeLe(std::string& ziel, uint32_t wert, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+      ziel.push_back(static_cast<char>((wert >> (8 * i)) & 0xff));
+    }
+  }
+
+  struct ZipEintrag {
+    std::string name;
+    std::string inhalt;
+    bool komprimiert;
+  };
+
+  std::string zipArchiv(const std::vector<ZipEintrag>& eintraege) {
+    std::string archiv;
+    std::string verzeichnis;
+    for (const auto& eintrag : eintraege) {
+      const std::string daten = eintrag.komprimiert ? komprimiere(eintrag.inhalt, -MAX_WBITS) : eintrag.inhalt;
+      const uint32_t crc = crc32(0, reinterpret_cast<const Bytef*>(eintrag.inhalt.data()), eintrag.inhalt.size());
+      std::string felder;  // ab "version needed", in beiden Kopfarten gleich
+      schreibeLe(felder, 20, 2);
+      schreibeLe(felder, 0, 2);
+      schreibeLe(felder, eintrag.komprimiert ? 8 : 0, 2);
+      schreibeLe(felder, 0, 4);  // Zeit und Datum
+      schreibeLe(felder, crc, 4);
+      schreibeLe(felder, daten.size(), 4);
+      schreibeLe(felder, eintrag.inhalt.size(), 4);
+      schreibeLe(felder, eintrag.name.size(), 2);
+      schreibeLe(felder, 0, 2);
+
+      schreibeLe(verzeichnis, 0x02014b50, 4);
+      schreibeLe(verzeichnis, 20, 2);
+      verzeichnis += felder;
+      schreibeLe(verzeichnis, 0, 2);  // Kommentar
+      schreibeLe(verzeichnis, 0, 4);  // Disk, interne Attribute
+      schreibeLe(verzeichnis, 0, 4);  // externe Attribute
+      schreibeLe(verzeichnis, archiv.size(), 4);
+      verzeichnis += eintrag.name;
+
+      schreibeLe(archiv, 0x04034b50, 4);
+      archiv += felder;
+      archiv += eintrag.name;
+      archiv += daten;
+    }
+    const size_t verzeichnisOffset = archiv.size();
+    archiv += verzeichnis;
+    schreibeLe(archiv, 0x06054b50, 4);
+    schreibeLe(archiv, 0, 4);
+    schreibeLe(archiv, eintraege.size(), 2);
+    schreibeLe(archiv, eintraege.size(), 2);
+    schreibeLe(archiv, verzeichnis.size(), 4);
+    schreibeLe(archiv, verzeichnisOffset, 4);
+    schreibeLe(archiv, 3, 2);
+    archiv += "zip";  // Kommentar
+    return archiv;
+  }
+
+  void schreibeDatei(const fs::path& pfad, std::string_view inhalt) {
+    std::ofstream datei(pfad.string(), std::ios::binary);
+    datei << inhalt;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ZipArchiv) {
+  // Larger than a decompression block, so that the parser sees the entry in several pieces.
+  const std::string gross = "<Zusi><Info DateiTyp=\"author\"><AutorEintrag AutorName=\"" + std::string(600000, 'x') + "\"/></Info></Zusi>";
+  const TempVerzeichnis temp;
+  const fs::path pfad = temp / "test.zip";
+  schreibeDatei(pfad, zipArchiv({
+    { "Routes/", "", false },
+    { "Routes/Deutschland/Strecke.st3", "<Zusi><Info ObjektID=\"3\"/></Zusi>", false },
+    { "Loks/Lok.fzg", gross, true },
+    { "Loks/Kaputt.fzg", "<Zusi><Info", true },
+  }));
+
+  const auto zip = std::make_shared<const zusixml::ZipReader>(pfad.string());
+  BOOST_TEST_REQUIRE(zip->size() == 3);  // without the directory
+  const auto* strecke = zip->find("\\routes\\DEUTSCHLAND\\strecke.ST3");
+  BOOST_TEST_REQUIRE(strecke != nullptr);
+  BOOST_TEST(strecke->name == "Routes/Deutschland/Strecke.st3");
+  BOOST_TEST(zip->find("Loks/Lok.fzg") != nullptr);
+  BOOST_TEST(zip->find("Loks\\Lok.fz") == nullptr);
+  BOOST_TEST(zip->read(*zip->find("loks\\lok.fzg")) == gross);
+
+  const auto result = zusixml::parseFile(zip, "Routes\\Deutschland\\Strecke.st3");
+  BOOST_TEST_REQUIRE(static_cast<bool>(result));
+  BOOST_TEST(result->Info->ObjektID == 3);
+  const auto lok = zusixml::parseFile(zip, "Loks\\Lok.fzg");
+  BOOST_TEST_REQUIRE(static_cast<bool>(lok));
+  BOOST_TEST(lok->Info->children_AutorEintrag[0]->AutorName.size() == 600000);
+  BOOST_TEST(!zusixml::parseFile(zip, "Loks\\Kaputt.fzg"));
+  BOOST_TEST(!zusixml::parseFile(zip, "Loks\\Fehlt.fzg"));
+
+  // Damaged contents are detected by the CRC.
+  std::string beschaedigt = zipArchiv({ { "a.st3", "<Zusi><Info ObjektID=\"3\"/></Zusi>", false } });
+  beschaedigt[30 + 5 + 20] = '4';
+  schreibeDatei(pfad, beschaedigt);
+  zusixml::ZipReader beschaedigtReader(pfad.string());
+  BOOST_CHECK_THROW(beschaedigtReader.read(beschaedigtReader[0]), std::runtime_error);
+
+  schreibeDatei(pfad, "<Zusi/>");
+  BOOST_CHECK_THROW(zusixml::ZipReader(pfad.string()), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(GzipDatei) {
+  const std::string xml = "<Zusi><Info DateiTyp=\"author\"><AutorEintrag AutorName=\"" + std::string(600000, 'y') + "\"/></Info></Zusi>";
+  const TempVerzeichnis temp;
+  const fs::path pfad = temp / "test.xml.gz";
+  // Two gzip members, split inside the attribute value
+  schreibeDatei(pfad, komprimiere(xml.substr(0, 1000), MAX_WBITS + 16) + komprimiere(xml.substr(1000), MAX_WBITS + 16));
+  const auto result = zusixml::parseCompressedFile(pfad.string());
+  BOOST_TEST_REQUIRE(static_cast<bool>(result));
+  BOOST_TEST(result->Info->children_AutorEintrag[0]->AutorName.size() == 600000);
+
+  // Truncated
+  const std::string gz = komprimiere(xml, MAX_WBITS + 16);
+  schreibeDatei(pfad, std::string_view(gz).substr(0, gz.size() / 2));
+  BOOST_TEST(!zusixml::parseCompressedFile(pfad.string()));
+
+  // Uncompressed files are parsed as they are.
+  schreibeDatei(pfad, "<Zusi><Info ObjektID=\"5\"/></Zusi>");
+  const auto unkomprimiert = zusixml::parseCompressedFile(pfad.string());
+  BOOST_TEST_REQUIRE(static_cast<bool>(unkomprimiert));
+  BOOST_TEST(unkomprimiert->Info->ObjektID == 5);
+}
+#endif
+
+namespace {
+  struct DateiSammler : zusixml::sax::default_handler {
+    std::vector<std::string> dateinamen;
+    size_t strElemente = 0;
+    std::vector<float> x;
+    int32_t autorId = 0;
+    ArgbColor farbe {};
+
+    void on_attr_Dateiverknuepfung_Dateiname(std::string_view dateiname) { dateinamen.emplace_back(dateiname); }
+    void on_begin_StrElement() { ++strElemente; }
+    void on_attr_Vec3_X(float value) { x.push_back(value); }
+    void on_attr_AutorEintrag_AutorID(int32_t value) { autorId = value; }
+    void on_attr_SubSet_Cd(ArgbColor value) { farbe = value; }
+  };
+
+  struct NurInfo : zusixml::sax::default_handler {
+    std::string autorName;
+    void on_attr_AutorEintrag_AutorName(std::string_view value) { autorName = value; }
+  };
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(SAX) {
+  const std::string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<Zusi>\n<Info DateiTyp=\"Landschaft\">\n"
+    "<AutorEintrag AutorID=\"42\" AutorName=\"A &amp; B\"/>\n</Info>\n"
+    "<Landschaft><SubSet C=\"FF102030\"/></Landschaft>\n"
+    "<Strecke>\n<Datei Dateiname=\"a\\b.fpn\"/>\n"
+    "<StrElement Nr=\"1\" kr=\"-\"><g X=\"1.5\"/><b X=\"-2\"/></StrElement>\n"
+    "<StrElement Nr=\"2\"/>\n<HintergrundDatei Dateiname=\"&lt;x&gt;.ls3\"/>\n"
+    "</Strecke>\n</Zusi>";
+
+  DateiSammler sammler;
+  zusixml::sax::parse_root(xml.data(), xml.data() + xml.size(), sammler);
+  BOOST_TEST(sammler.dateinamen == std::vector<std::string>({ "a\\b.fpn", "<x>.ls3" }), boost::test_tools::per_element());
+  BOOST_TEST(sammler.strElemente == 2);
+  BOOST_TEST(sammler.x == std::vector<float>({ 1.5f, -2.0f }), boost::test_tools::per_element());
+  BOOST_TEST(sammler.autorId == 42);
+  BOOST_TEST(sammler.farbe.a == 0xFF);
+  BOOST_TEST(sammler.farbe.r == 0x30);
+  BOOST_TEST(sammler.farbe.g == 0x20);
+  BOOST_TEST(sammler.farbe.b == 0x10);
+
+  // Without a callback, kr="-" is skipped instead of converted; the element tree would throw here.
+  NurInfo nurInfo;
+  zusixml::sax::parse_root(xml.data(), xml.data() + xml.size(), nurInfo);
+  BOOST_TEST(nurInfo.autorName == "A & B");
+  BOOST_CHECK_THROW(zusixml::parse_root<Zusi>(xml.data(), xml.data() + xml.size()), zusixml::parse_error);
+}
+
+BOOST_AUTO_TEST_CASE(LazyKindelemente) {
+  // Strecke::Fahrstrasse is marked as lazy in CMakeLists.txt.
+  const std::string xml = "<Zusi><Strecke>"
+    "<Fahrstrasse FahrstrName=\"A &amp; B\" Laenge=\"1.5\"><FahrstrStart Ref=\"3\"/></Fahrstrasse>"
+    "<StrElement Nr=\"1\"/>"
+    "<Fahrstrasse FahrstrName=\"C\" Laenge=\"x\"/>"
+    "</Strecke></Zusi>";
+  const auto result = zusixml::parse_root<Zusi>(xml.data(), xml.data() + xml.size());
+  BOOST_TEST_REQUIRE(result->Strecke->children_Fahrstrasse.size() == 2);
+  BOOST_TEST(result->Strecke->children_StrElement.size() == 2);
+
+  const auto& fahrstrasse1 = result->Strecke->children_Fahrstrasse[0];
+  BOOST_TEST(!fahrstrasse1.parsed());
+  BOOST_TEST(fahrstrasse1->FahrstrName == "A & B");
+  BOOST_TEST(fahrstrasse1.parsed());
+  BOOST_TEST(fahrstrasse1->Laenge == 1.5f);
+  BOOST_TEST_REQUIRE(static_cast<bool>(fahrstrasse1->FahrstrStart));
+  BOOST_TEST(fahrstrasse1->FahrstrStart->Ref == 3);
+
+  // Errors are only detected on access.
+  BOOST_CHECK_THROW(result->Strecke->children_Fahrstrasse[1].get(), zusixml::parse_error);
+}
+
+BOOST_AUTO_TEST_CASE(LazyKindelementFehlt) {
+  // Strecke::UTM is marked as lazy in CMakeLists.txt. An absent child reads as a default-constructed element.
+  const std::string xml = "<Zusi><Strecke><StrElement Nr=\"1\"/></Strecke></Zusi>";
+  const auto result = zusixml::parse_root<Zusi>(xml.data(), xml.data() + xml.size());
+  BOOST_TEST_REQUIRE(static_cast<bool>(result->Strecke));
+  BOOST_TEST(result->Strecke->UTM.empty());
+  BOOST_TEST(!result->Strecke->UTM);
+  BOOST_TEST(result->Strecke->UTM->UTM_WE == 0);
+  BOOST_TEST(result->Strecke->UTM.parsed());
+  BOOST_TEST(result->Strecke->UTM.empty());
+
+  const std::string xmlMitUtm = "<Zusi><Strecke><UTM UTM_WE=\"5\" UTM_NS=\"-3\"/></Strecke></Zusi>";
+  const auto mitUtm = zusixml::parse_root<Zusi>(xmlMitUtm.data(), xmlMitUtm.data() + xmlMitUtm.size());
+  BOOST_TEST(static_cast<bool>(mitUtm->Strecke->UTM));
+  BOOST_TEST(!mitUtm->Strecke->UTM.parsed());
+  BOOST_TEST(mitUtm->Strecke->UTM->UTM_WE == 5);
+  BOOST_TEST(mitUtm->Strecke->UTM->UTM_NS == -3);
+
+  // Also outside of a document.
+  const decltype(Strecke::UTM) leer;
+  BOOST_TEST(leer.empty());
+  BOOST_TEST(leer->UTM_NS == 0);
+}
+
+BOOST_AUTO_TEST_CASE(LazyKindelementeParseFile) {
+  // parseFile keeps the file contents alive until the lazy children are parsed.
+  const TempVerzeichnis temp;
+  const fs::path pfad = temp / "test.xml";
+  {
+    std::ofstream datei(pfad.string(), std::ios::binary);
+    datei << "<Zusi><Strecke><Fahrstrasse FahrstrName=\"Datei &amp; Test\"><FahrstrStart Ref=\"7\"/></Fahrstrasse></Strecke></Zusi>";
+  }
+  const auto result = zusixml::parseFile(pfad.string());
+  BOOST_TEST_REQUIRE(static_cast<bool>(result));
+  BOOST_TEST_REQUIRE(result->Strecke->children_Fahrstrasse.size() == 1);
+  BOOST_TEST(!result->Strecke->children_Fahrstrasse[0].parsed());
+  BOOST_TEST(result->Strecke->children_Fahrstrasse[0]->FahrstrName == "Datei & Test");
+  BOOST_TEST(result->Strecke->children_Fahrstrasse[0]->FahrstrStart->Ref == 7);
+}
+
+#if defined(ZUSIXML_ARENA)
+BOOST_AUTO_TEST_CASE(Arena) {
+  // Built in the parser_test_arena executable only (parsergen --arena).
+  const std::string xml = "<Zusi><Strecke>"
+    "<Fahrstrasse FahrstrName=\"A\"><FahrstrStart Ref=\"3\"/></Fahrstrasse>"
+    "<StrElement Nr=\"0\"/><StrElement Nr=\"2\"/>"
+    "</Strecke></Zusi>";
+  auto result = zusixml::parse_root<Zusi>(xml.data(), xml.data() + xml.size());
+  BOOST_TEST_REQUIRE(static_cast<bool>(result));
+
+  // All nodes lie in the arena of the document.
+  const size_t kapazitaet = result.memory().capacity();
+  BOOST_TEST(kapazitaet > 0);
+  BOOST_TEST(result->Strecke->children_StrElement.size() == 3);
+  BOOST_TEST(!result->Strecke->children_StrElement[1]);
+  BOOST_TEST(result->Strecke->children_StrElement[2]->Nr == 2);
+
+  // A lazy child is parsed into the arena of its document, even if another arena is current.
+  zusixml::arena andere;
+  {
+    zusixml::arena::scope scope(andere);
+    BOOST_TEST(result->Strecke->children_Fahrstrasse[0]->FahrstrStart->Ref == 3);
+  }
+  BOOST_TEST(andere.capacity() == 0);
+
+  auto verschoben = std::move(result);
+  BOOST_TEST(!result);
+  BOOST_TEST(verschoben.memory().capacity() >= kapazitaet);
+  BOOST_TEST(verschoben->Strecke->children_Fahrstrasse[0]->FahrstrName == "A");
+}
+
+#endif
+
+#if defined(ZUSIXML_STRING_VIEW)
+BOOST_AUTO_TEST_CASE(StringView) {
+  // Built in the parser_test_string_view executable only (parsergen --string-view).
+  const std::string xml = "<Zusi><Info DateiTyp=\"author\">"
+    "<AutorEintrag AutorName=\"Test\" AutorEmail=\"a&amp;b\"/>"
+    "</Info><Strecke><Fahrstrasse FahrstrName=\"&lt;A&gt;\"/></Strecke></Zusi>";
+  const auto result = zusixml::parse_root<Zusi>(xml.data(), xml.data() + xml.size());
+  BOOST_TEST_REQUIRE(result->Info->children_AutorEintrag.size() == 1);
+  const auto& autor = *result->Info->children_AutorEintrag[0];
+
+  // Values without character references refer to the input ...
+  BOOST_TEST(autor.AutorName == "Test");
+  BOOST_TEST((autor.AutorName.data() >= xml.data() && autor.AutorName.data() < xml.data() + xml.size()));
+  // ... others are expanded into the arena of the document.
+  BOOST_TEST(autor.AutorEmail == "a&b");
+  BOOST_TEST((autor.AutorEmail.data() < xml.data() || autor.AutorEmail.data() >= xml.data() + xml.size()));
+  BOOST_TEST(result->Info->DateiTyp == "author");
+
+  // Lazy children expand into the same arena.
+  const size_t kapazitaet = result.memory().capacity();
+  BOOST_TEST(result->Strecke->children_Fahrstrasse[0]->FahrstrName == "<A>");
+  BOOST_TEST(result.memory().capacity() >= kapazitaet);
+}
+
+BOOST_AUTO_TEST_CASE(StringViewParseFile) {
+  // parseFile keeps the file contents alive as long as the document.
+  const TempVerzeichnis temp;
+  const fs::path pfad = temp / "test.xml";
+  {
+    std::ofstream datei(pfad.string(), std::ios::binary);
+    datei << "<Zusi><Info DateiTyp=\"author\"><AutorEintrag AutorName=\"Datei &amp; Test\"/></Info></Zusi>";
+  }
+  const auto result = zusixml::parseFile(pfad.string());
+  fs::remove(pfad);
+  BOOST_TEST_REQUIRE(static_cast<bool>(result));
+  BOOST_TEST(result->Info->DateiTyp == "author");
+  BOOST_TEST(result->Info->children_AutorEintrag[0]->AutorName == "Datei & Test");
+}
+#endif
+
+#if defined(ZUSI_PARSER_TEST_LAYOUT_PROFILE)
+BOOST_AUTO_TEST_CASE(LayoutProfil) {
+  // Built in the parser_test_string_view executable only (parsergen --layout-profile test/layout_profile.txt).
+  static_assert(std::is_same_v<decltype(Zusi::Info), std::optional<Info>>);
+  static_assert(std::is_same_v<decltype(Zusi::Strecke), std::optional<Strecke>>);
+  static_assert(std::is_same_v<decltype(StrElement::children_NachNorm), std::vector<NachfolgerSelbesModul>>);
+
+  const auto result = zusixml::parse_root<Zusi>(
+    "<Zusi><Strecke><StrElement Nr=\"1\"><NachNorm Nr=\"2\"/></StrElement><StrElement Nr=\"2\"><NachNorm Nr=\"3\"/><NachNorm Nr=\"4\"/></StrElement></Strecke></Zusi>");
+  BOOST_TEST(!result->Info);
+  BOOST_TEST_REQUIRE(static_cast<bool>(result->Strecke));
+  BOOST_TEST_REQUIRE(result->Strecke->children_StrElement.size() == 3);
+  BOOST_TEST_REQUIRE(result->Strecke->children_StrElement[1]->children_NachNorm.size() == 1);
+  BOOST_TEST(result->Strecke->children_StrElement[1]->children_NachNorm[0].Nr == 2);
+  BOOST_TEST_REQUIRE(result->Strecke->children_StrElement[2]->children_NachNorm.size() == 2);
+  BOOST_TEST(result->Strecke->children_StrElement[2]->children_NachNorm[1].Nr == 4);
+}
+#endif
+
+#if defined(ZUSIXML_SPARSE_ATTRIBUTES)
+BOOST_AUTO_TEST_CASE(SelteneAttribute) {
+  // Built in the parser_test_string_view executable only (parsergen --sparse-attributes 0.05 with test/layout_profile.txt).
+  const auto result = zusixml::parse_root<Zusi>(
+    "<Zusi><Strecke><StrElement Nr=\"1\" kr=\"0.5\"/><StrElement Nr=\"2\" Oberbau=\"B55\" Streckennummer=\"6100\"/></Strecke></Zusi>");
+  const auto& elemente = result->Strecke->children_StrElement;
+  BOOST_TEST_REQUIRE(elemente.size() == 3);
+  BOOST_TEST(elemente[1]->kr == 0.5f);  // present in most elements of the profile
+  BOOST_TEST(!elemente[1]->sparse_attributes);
+  BOOST_TEST(!elemente[1]->has_Oberbau());
+  BOOST_TEST(elemente[1]->Oberbau().empty());
+  BOOST_TEST(elemente[1]->Streckennummer() == 0);
+  BOOST_TEST(elemente[2]->has_Oberbau());
+  BOOST_TEST(elemente[2]->Oberbau() == "B55");
+  BOOST_TEST(elemente[2]->has_Streckennummer());
+  BOOST_TEST(elemente[2]->Streckennummer() == 6100);
+  BOOST_TEST(!elemente[2]->has_Zwangshelligkeit());
+  BOOST_TEST(elemente[2]->Zwangshelligkeit() == 0.0f);
+}
+#endif
+
+#if defined(ZUSIXML_INTERN)
+BOOST_AUTO_TEST_CASE(Internierung) {
+  // Built in the parser_test_string_view executable only (parsergen --intern Dateiverknuepfung::Dateiname).
+  const std::string xml = "<Zusi><Info DateiTyp=\"author\">"
+    "<Datei Dateiname=\"Routes\\A.st3\"/><Datei Dateiname='Routes\\A.st3'/><Datei Dateiname=\"B&amp;C.st3\"/><Datei/>"
+    "</Info></Zusi>";
+  const auto result = zusixml::parse_root<Zusi>(xml.data(), xml.data() + xml.size());
+  const auto& dateien = result->Info->children_Datei;
+  BOOST_TEST_REQUIRE(dateien.size() == 4);
+  BOOST_TEST(dateien[0].Dateiname == "Routes\\A.st3");
+  BOOST_TEST(dateien[1].Dateiname.data() == dateien[0].Dateiname.data());
+  BOOST_TEST(dateien[2].Dateiname == "B&C.st3");
+  BOOST_TEST(dateien[3].Dateiname.empty());
+
+  BOOST_TEST_REQUIRE(result.strings() != nullptr);
+  const auto statistik = result.strings()->stats();
+  BOOST_TEST(statistik.lookups == 3);
+  BOOST_TEST(statistik.unique == 2);
+
+  // With a table installed by the caller, values are shared between documents.
+  zusixml::intern_table tabelle;
+  zusixml::intern_table::scope scope(tabelle);
+  const auto ergebnis1 = zusixml::parse_root<Zusi>(xml.data(), xml.data() + xml.size());
+  const auto ergebnis2 = zusixml::parse_root<Zusi>(xml.data(), xml.data() + xml.size());
+  BOOST_TEST(ergebnis1.strings() == &tabelle);
+  BOOST_TEST(ergebnis1->Info->children_Datei[0].Dateiname.data() == ergebnis2->Info->children_Datei[0].Dateiname.data());
+  BOOST_TEST(tabelle.stats().unique == 2);
+}
+#endif
+
+#if defined(ZUSI_PARSER_TEST_RESERVE)
+BOOST_AUTO_TEST_CASE(KapazitaetReservieren) {
+  // Built in the parser_test executable only (parsergen --reserve Strecke::StrElement --reserve SubSet::Vertex).
+  // Without the pre-pass, the vectors would have grown to a capacity of 8 and 4.
+  const auto result = zusixml::parse_root<Zusi>(R""(<Zusi>
+<Strecke><!-- <StrElement Nr="9"/> --><StrElement Nr="1"/><StrElement Nr="2"><NachNorm Nr="3"/></StrElement>
+<Fahrstrasse/>Text<StrElement Nr="3"></StrElement><StrElement Nr="4"/><StrElement Nr="5"/></Strecke>
+<Landschaft><SubSet><Vertex/><Face i="0;0;0"/><Vertex><p X="1"/></Vertex><Vertex/></SubSet></Landschaft>
+</Zusi>)"");
+  const auto& elemente = result->Strecke->children_StrElement;
+  BOOST_TEST(elemente.size() == 6);
+  BOOST_TEST(elemente.capacity() == 6);
+  BOOST_TEST(static_cast<bool>(elemente[1]));  // directly behind the comment
+  BOOST_TEST(elemente[2]->children_NachNorm[0].Nr == 3);
+  BOOST_TEST(result->Strecke->children_Fahrstrasse.size() == 1);
+  const auto& vertices = result->Landschaft->children_SubSet[0]->children_Vertex;
+  BOOST_TEST(vertices.size() == 3);
+  BOOST_TEST(vertices.capacity() == 3);
+  BOOST_TEST(vertices[1].p.X == 1);
+}
+#endif
+
+#if defined(ZUSIXML_REUSE)
+BOOST_AUTO_TEST_CASE(ErgebnisWiederverwenden) {
+  // Built in the parser_test executable only (parsergen --reuse).
+  zusixml::element_pool<StrElement>::clear();
+  const std::string_view erste = R""(<Zusi><Info ObjektID="5" Beschreibung="Erste Datei"><AutorEintrag AutorName="A"/></Info>
+<Strecke><StrElement Nr="1" Oberbau="Schotter"/><StrElement Nr="2"><NachNorm Nr="3"/></StrElement><Fahrstrasse/></Strecke></Zusi>)"";
+  const std::string_view zweite = R""(<Zusi><Info Beschreibung="Zweite"/><Strecke><StrElement Nr="1"/></Strecke></Zusi>)"";
+
+  Zusi result;
+  zusixml::parse_root_into(result, erste.data(), erste.data() + erste.size());
+  BOOST_TEST_REQUIRE(result.Strecke->children_StrElement.size() == 3);
+  const StrElement* letztes = result.Strecke->children_StrElement[2].get();
+  const size_t kapazitaet = result.Strecke->children_StrElement.capacity();
+
+  zusixml::parse_root_into(result, zweite.data(), zweite.data() + zweite.size());
+  // Nothing of the first document is left.
+  BOOST_TEST(result.Info->ObjektID == 0);
+  BOOST_TEST(result.Info->Beschreibung == "Zweite");
+  BOOST_TEST(result.Info->children_AutorEintrag.empty());
+  BOOST_TEST(result.Strecke->children_Fahrstrasse.empty());
+  BOOST_TEST_REQUIRE(result.Strecke->children_StrElement.size() == 2);
+  const StrElement& neu = *result.Strecke->children_StrElement[1];
+  BOOST_TEST(neu.Oberbau.empty());
+  BOOST_TEST(neu.children_NachNorm.empty());
+  // Capacity and child elements are reused.
+  BOOST_TEST(result.Strecke->children_StrElement.capacity() == kapazitaet);
+  BOOST_TEST(&neu == letztes);  // the element released last is taken first
+  BOOST_TEST(zusixml::element_pool<StrElement>::size() == 1);
+
+  // Without a root element, the result is empty.
+  zusixml::parse_root_into(result, "", "");
+  BOOST_TEST(!result.Info);
+  BOOST_TEST(!result.Strecke);
+  BOOST_TEST(zusixml::element_pool<StrElement>::size() == 2);
+}
+#endif
+
+#if defined(ZUSIXML_SOA)
+BOOST_AUTO_TEST_CASE(StructureOfArrays) {
+  // Built in the parser_test_arena executable only (parsergen --soa SubSet::Vertex --soa SubSet::Face --soa AnimationsDefinition::AniPunkt).
+  const auto result = zusixml::parse_root<Zusi>(R""(<Zusi><Landschaft>
+<SubSet>
+<Vertex U="0.5" V="0.25"><p X="1" Y="2" Z="3"/><n Z="1"/></Vertex>
+<Vertex U2="1"><p X="4" Y="5" Z="6"/></Vertex>
+<Face i="0;1;0"/>
+</SubSet>
+<MeshAnimation AniIndex="1"><AniPunkt AniZeit="0.5"><p X="7"/></AniPunkt><AniPunkt AniZeit="1"/></MeshAnimation>
+</Landschaft></Zusi>)"");
+  BOOST_TEST_REQUIRE(result->Landschaft->children_SubSet.size() == 1);
+  const auto& subset = *result->Landschaft->children_SubSet[0];
+
+  // Columns
+  const auto& positionen = subset.children_Vertex.column<&Vertex::p>();
+  BOOST_TEST_REQUIRE(positionen.size() == 2);
+  BOOST_TEST(positionen[0].X == 1);
+  BOOST_TEST(positionen[1].Z == 6);
+  BOOST_TEST(subset.children_Vertex.column<&Vertex::n>()[0].Z == 1);
+  BOOST_TEST(subset.children_Vertex.column<&Vertex::U>()[0] == 0.5f);
+  BOOST_TEST(subset.children_Vertex.column<&Vertex::U2>()[1] == 1.0f);
+  BOOST_TEST(subset.children_Face.column<&Face::i>()[0][1] == 1);
+
+  // AoS view
+  const Vertex vertex = subset.children_Vertex[1];
+  BOOST_TEST(vertex.p.Y == 5);
+  BOOST_TEST(vertex.U == 0);
+  size_t anzahl = 0;
+  for (const Vertex& v : subset.children_Vertex) {
+    BOOST_TEST(v.p.X == positionen[anzahl++].X);
+  }
+  BOOST_TEST(anzahl == 2);
+  const auto vertices = subset.children_Vertex.to_vector();
+  BOOST_TEST(vertices.size() == 2);
+  BOOST_TEST(vertices[0].V == 0.25f);
+
+  const auto& animation = *result->Landschaft->children_MeshAnimation[0];
+  BOOST_TEST_REQUIRE(animation.children_AniPunkt.size() == 2);
+  BOOST_TEST(animation.children_AniPunkt.column<&AniPunkt::AniZeit>()[1] == 1.0f);
+  BOOST_TEST(animation.children_AniPunkt.column<&AniPunkt::p>()[0].X == 7);
+}
+#endif
+
+#if defined(ZUSIXML_ARENA)
+BOOST_AUTO_TEST_CASE(ArenaAusrichtung) {
+  zusixml::arena::options optionen;
+  optionen.block_size = 64;
+  zusixml::arena arena(optionen);
+  for (size_t ausrichtung : { 1, 2, 8, 16, 64, 1, 4096 }) {
+    void* p = arena.allocate(3, ausrichtung);
+    BOOST_TEST(reinterpret_cast<uintptr_t>(p) % ausrichtung == 0);
+  }
+  // Larger than a block: gets its own block.
+  char* gross = static_cast<char*>(arena.allocate(100000, 8));
+  std::memset(gross, 1, 100000);
+  BOOST_TEST(arena.capacity() >= 100000);
+}
+
+BOOST_AUTO_TEST_CASE(ArenaOhneScope) {
+  // Outside an arena::scope, arena_allocator and arena_new allocate with operator new and free again.
+  zusixml::arena arena;
+  std::vector<int, zusixml::arena_allocator<int>> werte;
+  {
+    zusixml::arena::scope scope(arena);
+    werte.assign(10, 1);
+  }
+  const size_t kapazitaet = arena.capacity();
+  BOOST_TEST(!zusixml::arena::active());
+  werte.resize(100000, 2);  // moves from the arena to the heap
+  BOOST_TEST(arena.capacity() == kapazitaet);
+  BOOST_TEST(werte[9] == 1);
+  BOOST_TEST(werte[99999] == 2);
+  werte.clear();
+  werte.shrink_to_fit();
+
+  std::unique_ptr<StrElement, zusixml::arena_deleter<StrElement>> element(zusixml::arena_new<StrElement>());
+  element->Nr = 3;
+  {
+    zusixml::arena::scope scope(arena);
+    element->children_NachNorm.resize(3);  // beyond the inline capacity, into the arena
+  }
+  BOOST_TEST(element->children_NachNorm.size() == 3);
+}
+#endif
+
+#ifndef _WIN32
+BOOST_AUTO_TEST_CASE(EndeAnSeitengrenze) {
+  // The document ends exactly at a page boundary followed by an inaccessible page; the parser
+  // must not read beyond the end, neither for the complete document nor for any truncated prefix.
+  const std::string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<Zusi>\n<Info DateiTyp=\"author\">\n"
+    "<AutorEintrag AutorID=\"-42\" AutorName=\"Test &amp; Test\" AutorAufwand=\"1.5\" AutorLizenz=\"3\"/>\n"
+    "</Info>\n<author/>\n</Zusi>";
+  const size_t seite = getpagesize();
+  char* mapping = static_cast<char*>(mmap(nullptr, 2 * seite, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  BOOST_TEST_REQUIRE(mapping != MAP_FAILED);
+  BOOST_TEST_REQUIRE(mprotect(mapping + seite, seite, PROT_NONE) == 0);
+  const char* ende = mapping + seite;
+
+  for (size_t laenge = 0; laenge <= xml.size(); laenge++) {
+    char* anfang = mapping + seite - laenge;
+    std::memcpy(anfang, xml.data(), laenge);
+    try {
+      const auto result = zusixml::parse_root<Zusi>(anfang, ende);
+      if (laenge == xml.size()) {
+        BOOST_TEST_REQUIRE(static_cast<bool>(result->Info));
+        BOOST_TEST_REQUIRE(result->Info->children_AutorEintrag.size() == 1);
+        BOOST_TEST(result->Info->children_AutorEintrag[0]->AutorID == -42);
+        BOOST_TEST(result->Info->children_AutorEintrag[0]->AutorName == "Test & Test");
+        BOOST_TEST(result->Info->children_AutorEintrag[0]->AutorAufwand == 1.5f);
+        BOOST_TEST(result->Info->children_AutorEintrag[0]->AutorLizenz == 3);
+      }
+    } catch (const zusixml::parse_error&) {
+      BOOST_TEST(laenge < xml.size());
+    }
+  }
+
+  munmap(mapping, 2 * seite);
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END()
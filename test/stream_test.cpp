@@ -0,0 +1,80 @@
+// Tests for parsing input that arrives in pieces (StreamParser and the compressed formats on top of it).
+// Separate executable, because ZUSIXML_INCREMENTAL changes the generated parser for the whole program.
+#define ZUSIXML_INCREMENTAL
+#include "zusi_parser/zusi_parser.hpp"
+#include "zusi_parser/utils.hpp"
+#include "zusi_parser/compressed.hpp"
+#include "temp_verzeichnis.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+BOOST_AUTO_TEST_SUITE(StreamParserTest)
+
+BOOST_AUTO_TEST_CASE(Stueckweise) {
+  // Every chunk boundary may fall inside a tag, an attribute value, an entity or a number.
+  const std::string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<Zusi>\n<Info DateiTyp=\"author\">\n"
+    "<AutorEintrag AutorID=\"-42\" AutorName=\"Test &amp; &#x54;est\" AutorAufwand=\"1.25e1\" AutorLizenz=\"3\"/>\n"
+    "</Info>\n<Strecke>\n<StrElement Nr=\"2\" kr=\"-1,25E-3\" spTrass=\"1.435\">\n<g X=\"-12.5\" Y=\"3\" Z=\"0.0001\"/>\n"
+    "</StrElement>\n</Strecke>\n</Zusi>";
+
+  for (size_t stueckgroesse : { 1, 2, 3, 7, 64 }) {
+    zusixml::StreamParser parser(size_t(1) << 24);
+    for (size_t pos = 0; pos < xml.size(); pos += stueckgroesse) {
+      parser.feed(xml.data() + pos, std::min(stueckgroesse, xml.size() - pos));
+    }
+    const auto result = parser.finish();
+    BOOST_TEST(parser.size() == xml.size());
+    BOOST_TEST_REQUIRE(static_cast<bool>(result->Info));
+    BOOST_TEST_REQUIRE(result->Info->children_AutorEintrag.size() == 1);
+    BOOST_TEST(result->Info->children_AutorEintrag[0]->AutorID == -42);
+    BOOST_TEST(result->Info->children_AutorEintrag[0]->AutorName == "Test & Test");
+    BOOST_TEST(result->Info->children_AutorEintrag[0]->AutorAufwand == 12.5f);
+    BOOST_TEST(result->Info->children_AutorEintrag[0]->AutorLizenz == 3);
+    BOOST_TEST_REQUIRE(static_cast<bool>(result->Strecke));
+    BOOST_TEST_REQUIRE(result->Strecke->children_StrElement.size() == 3);
+    const auto& element = *result->Strecke->children_StrElement[2];
+    BOOST_TEST(element.kr == -1.25e-3f);
+    BOOST_TEST(element.spTrass == 1.435f);
+    BOOST_TEST(element.g.X == -12.5f);
+    BOOST_TEST(element.g.Y == 3.0f);
+    BOOST_TEST(element.g.Z == 0.0001f);
+  }
+
+  zusixml::StreamParser unvollstaendig;
+  unvollstaendig.feed(xml.data(), xml.size() / 2);
+  BOOST_CHECK_THROW(unvollstaendig.finish(), zusixml::parse_error);
+
+  zusixml::StreamParser klein(16);
+  BOOST_CHECK_THROW(klein.feed(xml.data(), xml.size()), std::length_error);
+}
+
+#if defined(ZUSI_PARSER_USE_ZLIB)
+BOOST_AUTO_TEST_CASE(GzipDateiStueckweise) {
+  // The parser runs while the file is decompressed, and sees the attribute value in several pieces.
+  const std::string xml = "<Zusi><Info DateiTyp=\"author\"><AutorEintrag AutorName=\"" + std::string(600000, 'y') + "\"/></Info></Zusi>";
+  const TempVerzeichnis temp;
+  const fs::path pfad = temp / "test.xml.gz";
+  const auto schreibe = [&pfad](std::string_view inhalt) {
+    const gzFile datei = gzopen(pfad.string().c_str(), "wb");
+    BOOST_TEST_REQUIRE(datei != nullptr);
+    BOOST_TEST(gzwrite(datei, inhalt.data(), static_cast<unsigned>(inhalt.size())) == static_cast<int>(inhalt.size()));
+    gzclose(datei);
+  };
+
+  schreibe(xml);
+  const auto result = zusixml::parseCompressedFile(pfad.string());
+  BOOST_TEST_REQUIRE(static_cast<bool>(result));
+  BOOST_TEST(result->Info->DateiTyp == "author");
+  BOOST_TEST(result->Info->children_AutorEintrag[0]->AutorName.size() == 600000);
+
+  schreibe(std::string_view(xml).substr(0, xml.size() / 2));
+  BOOST_TEST(!zusixml::parseCompressedFile(pfad.string()));
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
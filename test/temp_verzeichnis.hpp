@@ -0,0 +1,59 @@
+#ifndef ZUSI_PARSER_TEST_TEMP_VERZEICHNIS_HPP_
+#define ZUSI_PARSER_TEST_TEMP_VERZEICHNIS_HPP_
+
+#include "zusi_parser/utils.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <exception>
+#include <string>
+
+#ifdef _WIN32
+#  include <process.h>
+#else
+#  include <unistd.h>
+#endif
+
+/// Verzeichnis fuer die Dateien eines Testfalls, eindeutig je Prozess und Testfall, sodass die Testprogramme
+/// gleichzeitig laufen koennen (ctest -j). Wird am Ende des Testfalls mitsamt Inhalt geloescht.
+class TempVerzeichnis {
+ public:
+  TempVerzeichnis()
+      : m_pfad(fs::temp_directory_path() / ("zusi_parser_test_" + std::to_string(prozess()) + "_"
+            + boost::unit_test::framework::current_test_case().p_name.get())) {
+    fs::remove_all(m_pfad);
+    fs::create_directories(m_pfad);
+  }
+
+  ~TempVerzeichnis() {
+    try {
+      fs::remove_all(m_pfad);
+    } catch (const std::exception&) {
+      // z.B. noch geoeffnet unter Windows
+    }
+  }
+
+  TempVerzeichnis(const TempVerzeichnis&) = delete;
+  TempVerzeichnis& operator=(const TempVerzeichnis&) = delete;
+
+  fs::path operator/(const std::string& name) const {
+    return m_pfad / name;
+  }
+
+  const fs::path& pfad() const {
+    return m_pfad;
+  }
+
+ private:
+  static long prozess() {
+#ifdef _WIN32
+    return _getpid();
+#else
+    return static_cast<long>(getpid());
+#endif
+  }
+
+  fs::path m_pfad;
+};
+
+#endif  // ZUSI_PARSER_TEST_TEMP_VERZEICHNIS_HPP_
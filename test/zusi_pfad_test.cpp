@@ -1,7 +1,10 @@
 #include "zusi_parser/utils.hpp"
+#include "temp_verzeichnis.hpp"
 
 #include <boost/test/unit_test.hpp>
 
+#include <fstream>
+#include <string>
 #include <string_view>
 
 using namespace std::string_view_literals;
@@ -70,6 +73,50 @@ BOOST_AUTO_TEST_CASE(ZusiPfad_vonZusiPfad_mitUebergeordnet) {
   BOOST_TEST(zusiPfad10.alsZusiPfad() == "");
 }
 
+BOOST_AUTO_TEST_CASE(ZusiPfadIndex_alsOsPfad) {
+  const TempVerzeichnis temp;
+  const fs::path& wurzel = temp.pfad();
+  const auto lege_an = [](const fs::path& pfad) {
+    fs::create_directories(pfad.parent_path());
+    std::ofstream datei(pfad.string());
+  };
+  lege_an(wurzel / "Eigenes" / "Routes" / "Deutschland" / "Strecke.st3");
+  lege_an(wurzel / "Offiziell" / "Routes" / "Deutschland" / "Strecke.st3");
+  lege_an(wurzel / "Offiziell" / "RollingStock" / "Test" / "Test.ls3");
+  const std::string eigenes = (wurzel / "Eigenes").string() + osSep;
+  const std::string offiziell = (wurzel / "Offiziell").string() + osSep;
+  const std::string sep(1, osSep);
+
+  auto index = std::make_shared<ZusiPfadIndex>(eigenes, offiziell, 3);
+  BOOST_TEST(index->size() == 9);
+
+  // Case-insensitive, with the spelling on disk; the own data directory takes precedence.
+  BOOST_TEST(*index->find("routes\\DEUTSCHLAND\\strecke.ST3") == eigenes + "Routes" + sep + "Deutschland" + sep + "Strecke.st3");
+  BOOST_TEST(*index->find("\\RollingStock\\test\\test.ls3") == offiziell + "RollingStock" + sep + "Test" + sep + "Test.ls3");
+  BOOST_TEST(*index->find("rollingstock\\") == offiziell + "RollingStock" + sep);
+  BOOST_TEST(*index->find("") == eigenes);
+  BOOST_TEST(!index->find("RollingStock\\Test\\Fehlt.ls3").has_value());
+  BOOST_TEST(!index->find("RollingStock\\Test\\Test.ls").has_value());
+
+  // Missing paths resolve to the official data directory, as without an index.
+  BOOST_TEST(index->alsOsPfad("RollingStock\\Test\\Fehlt.ls3") == offiziell + "RollingStock" + sep + "Test" + sep + "Fehlt.ls3");
+  BOOST_TEST(index->alsOsPfad("\\RollingStock\\Test\\Fehlt.ls3") == offiziell + "RollingStock" + sep + "Test" + sep + "Fehlt.ls3");
+
+  // New files are only found after refresh().
+  lege_an(wurzel / "Eigenes" / "RollingStock" / "Test" / "Neu.ls3");
+  BOOST_TEST(!index->find("RollingStock\\Test\\Neu.ls3").has_value());
+  index->refresh();
+  BOOST_TEST(*index->find("RollingStock\\Test\\neu.ls3") == eigenes + "RollingStock" + sep + "Test" + sep + "Neu.ls3");
+  BOOST_TEST(*index->find("RollingStock\\Test\\Test.ls3") == offiziell + "RollingStock" + sep + "Test" + sep + "Test.ls3");
+
+  setZusiPfadIndex(index);
+  BOOST_TEST(ZusiPfad::vonZusiPfad("ROUTES\\Deutschland\\Strecke.st3").alsOsPfad() == eigenes + "Routes" + sep + "Deutschland" + sep + "Strecke.st3");
+  setZusiPfadIndex(nullptr);
+
+  // Without data directories, nothing is found.
+  BOOST_TEST(!ZusiPfadIndex("", (wurzel / "Fehlt").string() + osSep).find("").has_value());
+}
+
 #ifdef _WIN32
 BOOST_AUTO_TEST_CASE(ZusiPfad_vonOsPfad) {
   BOOST_TEST_REQUIRE(getZusiDatenpfad() == "C:\\Users\\vmuser\\ZusiDaten\\");
@@ -0,0 +1,131 @@
+// Packs the files of a Zusi data directory into one pack file (see include/zusi_parser/pack.hpp),
+// which zusixml::PackReader opens with a single open() and mmap().
+
+#include "zusi_parser/pack.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef ZUSI_PARSER_USE_BOOST_FILESYSTEM
+  #include <boost/filesystem.hpp>
+  namespace fs = boost::filesystem;
+#else
+  #include <filesystem>
+  namespace fs = std::filesystem;
+#endif
+
+#include <boost/program_options.hpp>
+#include <sys/stat.h>
+
+namespace po = boost::program_options;
+
+namespace {
+
+std::string ToLower(std::string s) {
+  std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c; });
+  return s;
+}
+
+/** Returns the modification time of @p path in seconds since 1970, or 0 if it cannot be determined. */
+int64_t ModificationTime(const fs::path& path) {
+#ifdef _WIN32
+  struct _stat64 sb;
+  return _wstat64(path.wstring().c_str(), &sb) == 0 ? sb.st_mtime : 0;
+#else
+  struct stat sb;
+  return stat(path.string().c_str(), &sb) == 0 ? sb.st_mtime : 0;
+#endif
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string data_dir;
+  std::string out;
+  std::vector<std::string> extensions;
+
+  po::options_description desc;
+  desc.add_options()
+    ("help", "show help message")
+    ("data-dir", po::value<std::string>(&data_dir), "Zusi data directory to pack. The files are stored under their path relative to it, with backslashes as separators.")
+    ("out", po::value<std::string>(&out), "Pack file to write")
+    ("extension", po::value<std::vector<std::string>>(&extensions), "Only pack files with the given extension (e.g. .st3), compared case-insensitively. Can be specified multiple times. If no extension is specified, all files are packed.")
+    ;
+
+  po::positional_options_description p;
+  p.add("data-dir", 1);
+
+  po::variables_map vars;
+  po::store(po::command_line_parser(argc, argv).options(desc).positional(p).run(), vars);
+  po::notify(vars);
+
+  if (vars.count("help") || data_dir.empty() || out.empty()) {
+    std::cerr << desc << "\n";
+    return 1;
+  }
+
+  std::set<std::string> extensionsLower;
+  for (const auto& extension : extensions) {
+    extensionsLower.insert(ToLower(extension));
+  }
+
+  std::ofstream outStream(out, std::ios::binary | std::ios::trunc);
+  if (!outStream) {
+    std::cerr << "Error opening " << out << "\n";
+    return 1;
+  }
+
+  // Sorted like the directory of the pack (by Zusi path, case-insensitively), so that the payloads are in its order.
+  std::vector<std::pair<fs::path, std::string>> files;  // path on disk, Zusi path
+  for (const auto& entry : fs::recursive_directory_iterator(data_dir)) {
+    if (!fs::is_regular_file(entry.status())) {
+      continue;
+    }
+    // The pack file itself, if it is written into the data directory.
+    if (fs::equivalent(entry.path(), out)) {
+      continue;
+    }
+    if (!extensionsLower.empty() && !extensionsLower.count(ToLower(entry.path().extension().string()))) {
+      continue;
+    }
+    std::string zusiPath = fs::relative(entry.path(), data_dir).string();
+    std::replace(zusiPath.begin(), zusiPath.end(), '/', '\\');
+    files.emplace_back(entry.path(), std::move(zusiPath));
+  }
+  std::sort(files.begin(), files.end(), [](const auto& lhs, const auto& rhs) {
+    return zusixml::pack::compare_paths(lhs.second, rhs.second) < 0;
+  });
+
+  try {
+    zusixml::pack::writer writer(outStream);
+    std::string contents;
+    uint64_t totalSize = 0;
+    for (const auto& [file, zusiPath] : files) {
+      std::ifstream in(file.string(), std::ios::binary);
+      if (!in) {
+        std::cerr << "Error opening " << file << "\n";
+        return 1;
+      }
+      contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+      if (in.bad()) {
+        std::cerr << "Error reading " << file << "\n";
+        return 1;
+      }
+      writer.add(zusiPath, contents, ModificationTime(file));
+      totalSize += contents.size();
+    }
+    writer.finish();
+    std::cerr << "Packed " << files.size() << " files (" << totalSize << " bytes) into " << out << "\n";
+  } catch (const std::exception& e) {
+    std::cerr << "Error writing " << out << ": " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}